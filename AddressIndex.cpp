@@ -0,0 +1,455 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code implements the SPHINXKey address index: a membership index over RIPEMD-160 address hashes for scanning blocks against owned addresses.
+
+// Layout (identical in memory and in the file):
+    // [0, 4096): the header: magic, format version, byte order, hash count, Bloom block count, table slot count, section offsets and a checksum.
+    // [4096, 4096 + 64 * blocks): the blocked Bloom filter. Each hash sets ADDRESS_INDEX_BLOOM_BITS bits inside one 64-byte block, so a lookup touches one cache line;
+    // about 12 bits per hash (before rounding the block count up to a power of two) keep false positives near 1%.
+    // Then the open-addressing table: 24-byte slots (hash, 32-bit value) with linear probing, an empty slot has the value ADDRESS_INDEX_NOT_FOUND;
+    // the slot count is a power of two at most 75% full, so a probe usually ends in the first cache line.
+    // Address hashes are outputs of RIPEMD-160 and already uniform, so the Bloom block (bytes 0-7), bit positions (bytes 8-14) and home slot (bytes 12-19) are read directly from the hash.
+    // Integers and positions are in the writer's byte order; a file written on a machine of the other byte order is rejected, as for the keystore.
+
+// build Function:
+    // Maps anonymous memory of the final size, sets the Bloom bits and inserts every hash; the keystore overload indexes the addressHash of every record.
+
+// open and save Functions:
+    // save writes the mapping to path + ".tmp", syncs it and renames it over path. open maps the file read-only with MADV_RANDOM and checks the header checksum
+    // and that the sections fit the file; the sections themselves are not checksummed, so opening a 10M-hash index takes no time.
+    // The header checksum can be recomputed for a crafted file, so open also bounds the section sizes by the file size before using them
+    // and requires the 75% load factor build produces; probe() additionally stops after one pass over the table.
+
+// find Functions:
+    // A single lookup tests the Bloom block and then walks the table from the home slot. The batch lookup works in groups of ADDRESS_INDEX_PROBE_GROUP hashes:
+    // it prefetches every Bloom block of the group, tests them, prefetches the home slots of the hashes that passed, then probes, so the cache misses of a group overlap.
+    // The ThreadPool overload splits the batch into chunks.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <span>
+#include <array>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Hasher.hpp"
+#include "Keystore.hpp"
+#include "ThreadPool.hpp"
+#include "AddressIndex.hpp"
+
+
+namespace SPHINXKey {
+
+    namespace {
+        constexpr std::array<char, 8> ADDRESS_INDEX_MAGIC = {'S', 'P', 'H', 'X', 'A', 'I', 'D', 'X'};
+        constexpr uint32_t ADDRESS_INDEX_FORMAT_VERSION = 1;
+        constexpr uint32_t ADDRESS_INDEX_BYTE_ORDER = 0x01020304;
+        constexpr size_t ADDRESS_INDEX_PAGE_SIZE = 4096;
+
+        // Bloom filter: 512-bit blocks, bits set per hash and bits budgeted per hash
+        constexpr size_t ADDRESS_INDEX_BLOOM_BLOCK = 64;
+        constexpr size_t ADDRESS_INDEX_BLOOM_BITS = 6;
+        constexpr size_t ADDRESS_INDEX_BITS_PER_HASH = 12;
+
+        // Table slot: the hash followed by its 32-bit value
+        constexpr size_t ADDRESS_INDEX_SLOT_SIZE = RIPEMD_160_DIGEST_SIZE + 4;
+
+        // Hashes interleaved per batch lookup group, and per parallelFor chunk
+        constexpr size_t ADDRESS_INDEX_PROBE_GROUP = 16;
+        constexpr size_t ADDRESS_INDEX_BATCH_GRAIN = 4096;
+
+        [[noreturn]] void throwSystemError(const char* what) {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        void writeAll(int fd, const void* data, size_t length) {
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            while (length > 0) {
+                const ssize_t written = ::write(fd, p, length);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throwSystemError("AddressIndex: write failed");
+                }
+                p += written;
+                length -= static_cast<size_t>(written);
+            }
+        }
+
+        // First 8 bytes of SPHINX_256 over the given bytes
+        std::array<unsigned char, 8> checksum8(const void* data, size_t length) {
+            const SPHINXHash::SPHINX256Digest digest = SPHINXHash::SPHINX_256(std::span<const unsigned char>(static_cast<const unsigned char*>(data), length));
+            std::array<unsigned char, 8> checksum;
+            std::copy_n(digest.begin(), checksum.size(), checksum.begin());
+            return checksum;
+        }
+
+        uint64_t load64(const unsigned char* p) {
+            uint64_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        uint32_t load32(const unsigned char* p) {
+            uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        uint64_t nextPowerOfTwo(uint64_t value) {
+            uint64_t power = 1;
+            while (power < value) {
+                power <<= 1;
+            }
+            return power;
+        }
+
+        bool isPowerOfTwo(uint64_t value) {
+            return value != 0 && (value & (value - 1)) == 0;
+        }
+
+        void prefetch(const void* address) {
+#if defined(__GNUC__)
+            __builtin_prefetch(address, 0, 0);
+#else
+            (void)address;
+#endif
+        }
+    } // namespace
+
+    // Header page contents
+    struct AddressIndex::Header {
+        std::array<char, 8> magic;
+        uint32_t formatVersion;
+        uint32_t byteOrder;
+        uint32_t slotSize;
+        uint32_t bloomBits;
+        uint64_t count;
+        uint64_t bloomBlocks;
+        uint64_t tableSlots;
+        uint64_t bloomOffset;
+        uint64_t tableOffset;
+        std::array<unsigned char, 8> checksum;   // Over the fields above
+
+        // Whether the header is intact, written with this build's layout, and its sections fit in fileSize bytes
+        // The checksum only catches accidents, anyone can recompute it, so the section sizes are bounded by fileSize before they are multiplied
+        // and the table must have the load factor build() gives it, which leaves an empty slot for probe() to stop at
+        bool valid(size_t fileSize) const {
+            return magic == ADDRESS_INDEX_MAGIC && formatVersion == ADDRESS_INDEX_FORMAT_VERSION && byteOrder == ADDRESS_INDEX_BYTE_ORDER &&
+                   slotSize == ADDRESS_INDEX_SLOT_SIZE && bloomBits == ADDRESS_INDEX_BLOOM_BITS && checksum == checksum8(this, offsetof(Header, checksum)) &&
+                   isPowerOfTwo(bloomBlocks) && isPowerOfTwo(tableSlots) &&
+                   bloomBlocks <= fileSize / ADDRESS_INDEX_BLOOM_BLOCK && tableSlots <= fileSize / ADDRESS_INDEX_SLOT_SIZE && count <= tableSlots * 3 / 4 &&
+                   bloomOffset == ADDRESS_INDEX_PAGE_SIZE && tableOffset == bloomOffset + bloomBlocks * ADDRESS_INDEX_BLOOM_BLOCK &&
+                   tableOffset <= fileSize && tableSlots <= (fileSize - tableOffset) / ADDRESS_INDEX_SLOT_SIZE &&
+                   tableOffset + tableSlots * ADDRESS_INDEX_SLOT_SIZE == fileSize;
+        }
+    };
+
+    // Function to build an index in memory
+    AddressIndex AddressIndex::build(std::span<const SPHINXHash::RIPEMD160Digest> hashes) {
+        static_assert(sizeof(Header) <= ADDRESS_INDEX_PAGE_SIZE, "AddressIndex header must fit its page");
+        if (hashes.size() >= ADDRESS_INDEX_NOT_FOUND) {
+            throw std::length_error("AddressIndex: too many hashes");
+        }
+
+        // Step 1: Size the sections and map them in one anonymous mapping
+        Header header{};
+        header.magic = ADDRESS_INDEX_MAGIC;
+        header.formatVersion = ADDRESS_INDEX_FORMAT_VERSION;
+        header.byteOrder = ADDRESS_INDEX_BYTE_ORDER;
+        header.slotSize = ADDRESS_INDEX_SLOT_SIZE;
+        header.bloomBits = ADDRESS_INDEX_BLOOM_BITS;
+        header.bloomBlocks = nextPowerOfTwo(std::max<uint64_t>(ADDRESS_INDEX_PAGE_SIZE / ADDRESS_INDEX_BLOOM_BLOCK, (hashes.size() * ADDRESS_INDEX_BITS_PER_HASH + 511) / 512));
+        header.tableSlots = nextPowerOfTwo(hashes.size() + hashes.size() / 3 + 1);
+        header.bloomOffset = ADDRESS_INDEX_PAGE_SIZE;
+        header.tableOffset = header.bloomOffset + header.bloomBlocks * ADDRESS_INDEX_BLOOM_BLOCK;
+
+        AddressIndex index;
+        index.mapSize_ = header.tableOffset + header.tableSlots * ADDRESS_INDEX_SLOT_SIZE;
+        void* mapping = ::mmap(nullptr, index.mapSize_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) {
+            index.mapSize_ = 0;
+            throw std::bad_alloc();
+        }
+        index.map_ = static_cast<unsigned char*>(mapping);
+        index.bloom_ = index.map_ + header.bloomOffset;
+        index.table_ = index.map_ + header.tableOffset;
+        index.bloomMask_ = header.bloomBlocks - 1;
+        index.slotMask_ = header.tableSlots - 1;
+        unsigned char* table = index.map_ + header.tableOffset;
+        std::memset(table, 0xff, header.tableSlots * ADDRESS_INDEX_SLOT_SIZE);
+
+        // Step 2: Insert every hash into the table and set its Bloom bits
+        for (size_t i = 0; i < hashes.size(); ++i) {
+            const SPHINXHash::RIPEMD160Digest& hash = hashes[i];
+            size_t slot = index.slotIndex(hash);
+            for (;; slot = (slot + 1) & index.slotMask_) {
+                unsigned char* entry = table + slot * ADDRESS_INDEX_SLOT_SIZE;
+                if (load32(entry + RIPEMD_160_DIGEST_SIZE) == ADDRESS_INDEX_NOT_FOUND) {
+                    const uint32_t value = static_cast<uint32_t>(i);
+                    std::memcpy(entry, hash.data(), hash.size());
+                    std::memcpy(entry + RIPEMD_160_DIGEST_SIZE, &value, sizeof(value));
+                    ++header.count;
+                    break;
+                }
+                if (std::memcmp(entry, hash.data(), hash.size()) == 0) {
+                    break;
+                }
+            }
+
+            unsigned char* block = const_cast<unsigned char*>(index.bloomBlock(hash));
+            const uint64_t bits = load64(hash.data() + 8);
+            for (size_t k = 0; k < ADDRESS_INDEX_BLOOM_BITS; ++k) {
+                const size_t bit = (bits >> (9 * k)) & 511;
+                block[bit / 8] |= static_cast<unsigned char>(1u << (bit % 8));
+            }
+        }
+
+        // Step 3: Write the header
+        header.checksum = checksum8(&header, offsetof(Header, checksum));
+        std::memcpy(index.map_, &header, sizeof(header));
+        return index;
+    }
+
+    // Function to build an index of every record of a keystore
+    AddressIndex AddressIndex::build(const Keystore& keystore) {
+        std::vector<SPHINXHash::RIPEMD160Digest> hashes(keystore.size());
+        for (size_t i = 0; i < hashes.size(); ++i) {
+            hashes[i] = keystore.record(i).addressHash;
+        }
+        return build(hashes);
+    }
+
+    // Function to open an index file
+    AddressIndex AddressIndex::open(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throwSystemError("AddressIndex: cannot open file");
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            const int error = errno;
+            ::close(fd);
+            errno = error;
+            throwSystemError("AddressIndex: cannot stat file");
+        }
+        const size_t fileSize = static_cast<size_t>(info.st_size);
+        if (fileSize < ADDRESS_INDEX_PAGE_SIZE) {
+            ::close(fd);
+            throw std::runtime_error("AddressIndex: not an address index");
+        }
+        void* mapping = ::mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+        const int error = errno;
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            errno = error;
+            throwSystemError("AddressIndex: mmap failed");
+        }
+
+        AddressIndex index;
+        index.map_ = static_cast<unsigned char*>(mapping);
+        index.mapSize_ = fileSize;
+        const Header& header = index.header();
+        if (!header.valid(fileSize)) {
+            throw std::runtime_error("AddressIndex: not an address index, corrupted, or written with a different layout");
+        }
+
+        // Lookups jump around the file, so readahead would only waste page cache
+        ::madvise(index.map_, fileSize, MADV_RANDOM);
+        index.bloom_ = index.map_ + header.bloomOffset;
+        index.table_ = index.map_ + header.tableOffset;
+        index.bloomMask_ = header.bloomBlocks - 1;
+        index.slotMask_ = header.tableSlots - 1;
+        return index;
+    }
+
+    // Function to write the index to a file
+    void AddressIndex::save(const std::string& path) const {
+        const std::string temporary = path + ".tmp";
+        const int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throwSystemError("AddressIndex: cannot create file");
+        }
+        try {
+            writeAll(fd, map_, mapSize_);
+            if (::fsync(fd) != 0) {
+                throwSystemError("AddressIndex: sync failed");
+            }
+        } catch (...) {
+            ::close(fd);
+            ::unlink(temporary.c_str());
+            throw;
+        }
+        ::close(fd);
+        if (::rename(temporary.c_str(), path.c_str()) != 0) {
+            const int error = errno;
+            ::unlink(temporary.c_str());
+            errno = error;
+            throwSystemError("AddressIndex: cannot rename file");
+        }
+    }
+
+    AddressIndex::AddressIndex(AddressIndex&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    AddressIndex& AddressIndex::operator=(AddressIndex&& other) noexcept {
+        std::swap(map_, other.map_);
+        std::swap(mapSize_, other.mapSize_);
+        std::swap(bloom_, other.bloom_);
+        std::swap(table_, other.table_);
+        std::swap(bloomMask_, other.bloomMask_);
+        std::swap(slotMask_, other.slotMask_);
+        return *this;
+    }
+
+    AddressIndex::~AddressIndex() {
+        if (map_ != nullptr) {
+            ::munmap(map_, mapSize_);
+            map_ = nullptr;
+        }
+    }
+
+    const AddressIndex::Header& AddressIndex::header() const {
+        return *reinterpret_cast<const Header*>(map_);
+    }
+
+    // Function to return the number of distinct hashes
+    size_t AddressIndex::size() const {
+        return map_ == nullptr ? 0 : header().count;
+    }
+
+    const unsigned char* AddressIndex::bloomBlock(const SPHINXHash::RIPEMD160Digest& hash) const {
+        return bloom_ + (load64(hash.data()) & bloomMask_) * ADDRESS_INDEX_BLOOM_BLOCK;
+    }
+
+    bool AddressIndex::bloomTest(const unsigned char* block, const SPHINXHash::RIPEMD160Digest& hash) const {
+        const uint64_t bits = load64(hash.data() + 8);
+        for (size_t k = 0; k < ADDRESS_INDEX_BLOOM_BITS; ++k) {
+            const size_t bit = (bits >> (9 * k)) & 511;
+            if ((block[bit / 8] & (1u << (bit % 8))) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t AddressIndex::slotIndex(const SPHINXHash::RIPEMD160Digest& hash) const {
+        return static_cast<size_t>(load64(hash.data() + RIPEMD_160_DIGEST_SIZE - 8) & slotMask_);
+    }
+
+    uint32_t AddressIndex::probe(size_t slot, const SPHINXHash::RIPEMD160Digest& hash) const {
+        // At most one pass over the table, so even a table without an empty slot ends the walk
+        for (size_t step = 0; step <= slotMask_; ++step, slot = (slot + 1) & slotMask_) {
+            const unsigned char* entry = table_ + slot * ADDRESS_INDEX_SLOT_SIZE;
+            const uint32_t value = load32(entry + RIPEMD_160_DIGEST_SIZE);
+            if (value == ADDRESS_INDEX_NOT_FOUND) {
+                return ADDRESS_INDEX_NOT_FOUND;
+            }
+            if (std::memcmp(entry, hash.data(), hash.size()) == 0) {
+                return value;
+            }
+        }
+        return ADDRESS_INDEX_NOT_FOUND;
+    }
+
+    // Function to test the Bloom filter only
+    bool AddressIndex::mayContain(const SPHINXHash::RIPEMD160Digest& hash) const {
+        return map_ != nullptr && bloomTest(bloomBlock(hash), hash);
+    }
+
+    // Function to look up one hash
+    std::optional<uint32_t> AddressIndex::find(const SPHINXHash::RIPEMD160Digest& hash) const {
+        if (!mayContain(hash)) {
+            return std::nullopt;
+        }
+        const uint32_t value = probe(slotIndex(hash), hash);
+        if (value == ADDRESS_INDEX_NOT_FOUND) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    // Function to look up many hashes on the calling thread
+    size_t AddressIndex::find(std::span<const SPHINXHash::RIPEMD160Digest> hashes, std::span<uint32_t> values) const {
+        if (values.size() < hashes.size()) {
+            throw std::length_error("AddressIndex: fewer values than hashes");
+        }
+        if (map_ == nullptr) {
+            std::fill_n(values.begin(), hashes.size(), ADDRESS_INDEX_NOT_FOUND);
+            return 0;
+        }
+
+        size_t found = 0;
+        const unsigned char* blocks[ADDRESS_INDEX_PROBE_GROUP];
+        size_t slots[ADDRESS_INDEX_PROBE_GROUP];
+        size_t pending[ADDRESS_INDEX_PROBE_GROUP];
+        for (size_t group = 0; group < hashes.size(); group += ADDRESS_INDEX_PROBE_GROUP) {
+            const size_t n = std::min(ADDRESS_INDEX_PROBE_GROUP, hashes.size() - group);
+
+            // Step 1: Prefetch the Bloom block of every hash of the group
+            for (size_t i = 0; i < n; ++i) {
+                blocks[i] = bloomBlock(hashes[group + i]);
+                prefetch(blocks[i]);
+            }
+
+            // Step 2: Test the Bloom blocks and prefetch the home slots of the hashes that pass
+            size_t candidates = 0;
+            for (size_t i = 0; i < n; ++i) {
+                values[group + i] = ADDRESS_INDEX_NOT_FOUND;
+                if (bloomTest(blocks[i], hashes[group + i])) {
+                    slots[candidates] = slotIndex(hashes[group + i]);
+                    prefetch(table_ + slots[candidates] * ADDRESS_INDEX_SLOT_SIZE);
+                    pending[candidates++] = i;
+                }
+            }
+
+            // Step 3: Probe the table for the candidates
+            for (size_t k = 0; k < candidates; ++k) {
+                const size_t i = pending[k];
+                values[group + i] = probe(slots[k], hashes[group + i]);
+                found += values[group + i] != ADDRESS_INDEX_NOT_FOUND;
+            }
+        }
+        return found;
+    }
+
+    // Function to look up many hashes on the given pool
+    size_t AddressIndex::find(std::span<const SPHINXHash::RIPEMD160Digest> hashes, std::span<uint32_t> values, ThreadPool& pool) const {
+        if (values.size() < hashes.size()) {
+            throw std::length_error("AddressIndex: fewer values than hashes");
+        }
+        std::atomic<size_t> found{0};
+        pool.parallelFor(hashes.size(), ADDRESS_INDEX_BATCH_GRAIN, [&](size_t begin, size_t end) {
+            found.fetch_add(find(hashes.subspan(begin, end - begin), values.subspan(begin, end - begin)), std::memory_order_relaxed);
+        });
+        return found.load();
+    }
+} // namespace SPHINXKey
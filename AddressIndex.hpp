@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+#ifndef SPHINX_ADDRESS_INDEX_HPP
+#define SPHINX_ADDRESS_INDEX_HPP
+
+#pragma once
+
+#include <span>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "Hasher.hpp"
+
+namespace SPHINXKey {
+
+    class Keystore;
+    class ThreadPool;
+
+    // Value written by the batch lookup for hashes that are not in the index
+    constexpr uint32_t ADDRESS_INDEX_NOT_FOUND = UINT32_MAX;
+
+    // Read-only membership index over address hashes (the RIPEMD-160 hash inside an address, see decodeAddress)
+    // A blocked Bloom filter (one 64-byte cache line per key) answers most misses with one memory access; hits and false positives
+    // go on to an open-addressing table of (hash, value) slots. The in-memory layout is the file layout, so open() only maps the file
+    class AddressIndex {
+    public:
+        // Function to build an index in memory; hashes[i] maps to the value i (a keystore record or derivation index), a repeated hash keeps its first value
+        static AddressIndex build(std::span<const SPHINXHash::RIPEMD160Digest> hashes);
+
+        // Function to build an index of every record of a keystore; the value of a hash is its record number
+        static AddressIndex build(const Keystore& keystore);
+
+        // Function to open an index file written by save, mapped read-only
+        static AddressIndex open(const std::string& path);
+
+        // Function to write the index to a file, replacing it atomically (written to path + ".tmp", synced, then renamed)
+        void save(const std::string& path) const;
+
+        AddressIndex(AddressIndex&& other) noexcept;
+        AddressIndex& operator=(AddressIndex&& other) noexcept;
+        ~AddressIndex();
+
+        AddressIndex(const AddressIndex&) = delete;
+        AddressIndex& operator=(const AddressIndex&) = delete;
+
+        // Function to return the number of distinct hashes
+        size_t size() const;
+
+        // Function to test the Bloom filter only; false means the hash is certainly not in the index
+        bool mayContain(const SPHINXHash::RIPEMD160Digest& hash) const;
+
+        // Function to look up one hash
+        std::optional<uint32_t> find(const SPHINXHash::RIPEMD160Digest& hash) const;
+
+        // Function to look up many hashes, returns the number found; values[i] receives the value of hashes[i] or ADDRESS_INDEX_NOT_FOUND
+        // Lookups are interleaved in groups so the Bloom and table cache misses of a group overlap
+        size_t find(std::span<const SPHINXHash::RIPEMD160Digest> hashes, std::span<uint32_t> values) const;
+        size_t find(std::span<const SPHINXHash::RIPEMD160Digest> hashes, std::span<uint32_t> values, ThreadPool& pool) const;
+
+    private:
+        struct Header;
+
+        AddressIndex() = default;
+
+        const Header& header() const;
+        const unsigned char* bloomBlock(const SPHINXHash::RIPEMD160Digest& hash) const;
+        bool bloomTest(const unsigned char* block, const SPHINXHash::RIPEMD160Digest& hash) const;
+        size_t slotIndex(const SPHINXHash::RIPEMD160Digest& hash) const;
+        uint32_t probe(size_t slot, const SPHINXHash::RIPEMD160Digest& hash) const;
+
+        unsigned char* map_ = nullptr;
+        size_t mapSize_ = 0;
+        const unsigned char* bloom_ = nullptr;
+        const unsigned char* table_ = nullptr;
+        uint64_t bloomMask_ = 0;
+        uint64_t slotMask_ = 0;
+    };
+} // namespace SPHINXKey
+
+#endif // SPHINX_ADDRESS_INDEX_HPP
@@ -0,0 +1,307 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code implements hierarchical deterministic (HD) derivation of SPHINX keys and addresses from one seed.
+
+// Derivation:
+    // HMAC is built on SPHINX_256 (64-byte blocks). A node is a SPHINX private key and a chain code; the master node is HMAC keyed with a fixed label over the seed.
+    // Child index i of a node is HMAC keyed with the parent chain code over 0x00 || parent private key || i (big-endian), finished once with the byte 0x01
+    // for the child private key and once with 0x02 for its chain code. Every index is derived from the private key; the ' bit (HD_PRIME_INDEX) is only
+    // part of the index and makes m/0 and m/0' different children. There is no public derivation.
+    // The address key of a derived private key is SPHINX_256 over a label and the private key, and its address is generateAddress of that key.
+    // Address keys are standalone SPHINX identifiers, not SPHINXHybridKey public keys: Curve448 / Kyber1024 key pairs cannot be derived here,
+    // since hybrid_key.cpp has no deterministic key generation from a seed, so nothing can be verified, encrypted or exchanged against a derived address.
+
+// HDKeyDeriver Class:
+    // node() returns the node at a path. Nodes on every path asked for are kept in a cache (a std::map in SecureArena memory, zeroized on release),
+    // so a path below an account node is derived from the deepest cached ancestor instead of the root.
+    // deriveRange() derives a contiguous range of children of one node: the HMAC inner and outer pads of the parent chain code are absorbed once into
+    // SPHINX_256 midstates, and every child only copies the midstates and hashes its own 37-byte message.
+    // The range is split into chunks on the work-stealing ThreadPool; inside a chunk the address keys are hashed with SPHINX_256_multi and the addresses are
+    // produced by the multi-buffer generateAddresses, 64 keys per SIMD pass. Leaf chain codes are not computed.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <map>
+#include <span>
+#include <array>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include <shared_mutex>
+#include <string_view>
+
+#include "Key.hpp"
+#include "Hasher.hpp"
+#include "ThreadPool.hpp"
+#include "HDKey.hpp"
+#include "SecureArena.hpp"
+
+
+namespace SPHINXKey {
+
+    namespace {
+        constexpr char HD_SEED_LABEL[] = "SPHINXKey HD seed";
+        // The label predates the rename to address keys and is kept, so derived addresses do not change
+        constexpr char HD_ADDRESS_KEY_LABEL[] = "SPHINXKey HD public";
+        constexpr size_t HD_ADDRESS_KEY_LABEL_SIZE = sizeof(HD_ADDRESS_KEY_LABEL) - 1;
+        constexpr size_t HD_ADDRESS_KEY_MESSAGE_SIZE = HD_ADDRESS_KEY_LABEL_SIZE + SPHINX_256_DIGEST_SIZE;
+
+        // 0x00 || parent private key || index
+        constexpr size_t HD_CHILD_MESSAGE_SIZE = 1 + SPHINX_256_DIGEST_SIZE + 4;
+
+        // Children per parallelFor chunk, a multiple of every multi-buffer lane count
+        constexpr size_t HD_RANGE_GRAIN = 256;
+
+        constexpr unsigned char HD_KEY_TAG = 0x01;
+        constexpr unsigned char HD_CHAIN_TAG = 0x02;
+
+        // HMAC over SPHINX_256 with the pads of one key absorbed into midstates
+        class HmacSphinx256 {
+        public:
+            explicit HmacSphinx256(std::span<const unsigned char> key) {
+                std::array<unsigned char, SPHINXHash::SPHINX256Hasher::BLOCK_SIZE> block{};
+                if (key.size() > block.size()) {
+                    const SPHINXHash::SPHINX256Digest digest = SPHINXHash::SPHINX_256(key);
+                    std::copy(digest.begin(), digest.end(), block.begin());
+                } else {
+                    std::copy(key.begin(), key.end(), block.begin());
+                }
+                for (auto& byte : block) {
+                    byte ^= 0x36;
+                }
+                inner_.update(block);
+                for (auto& byte : block) {
+                    byte ^= 0x36 ^ 0x5c;
+                }
+                outer_.update(block);
+                secureZero(block.data(), block.size());
+            }
+
+            ~HmacSphinx256() {
+                secureZero(&inner_, sizeof(inner_));
+                secureZero(&outer_, sizeof(outer_));
+            }
+
+            HmacSphinx256(const HmacSphinx256&) = delete;
+            HmacSphinx256& operator=(const HmacSphinx256&) = delete;
+
+            // Function to compute HMAC(key, message || tag) into out; const, so one instance serves every worker
+            void mac(std::span<const unsigned char> message, unsigned char tag, unsigned char* out) const {
+                SPHINXHash::SPHINX256Hasher inner = inner_;
+                inner.update(message).update(&tag, 1);
+                SPHINXHash::SPHINX256Digest innerDigest = inner.finalize();
+                SPHINXHash::SPHINX256Hasher outer = outer_;
+                outer.update(innerDigest);
+                outer.finalize(out);
+                secureZero(&inner, sizeof(inner));
+                secureZero(&outer, sizeof(outer));
+                secureZero(innerDigest.data(), innerDigest.size());
+            }
+
+        private:
+            SPHINXHash::SPHINX256Hasher inner_;
+            SPHINXHash::SPHINX256Hasher outer_;
+        };
+
+        void writeChildMessage(unsigned char* message, const SPHINXPrivKey& parentKey, uint32_t index) {
+            message[0] = 0x00;
+            std::memcpy(message + 1, parentKey.data(), parentKey.size());
+            for (size_t i = 0; i < 4; ++i) {
+                message[1 + SPHINX_256_DIGEST_SIZE + i] = static_cast<unsigned char>(index >> (24 - 8 * i));
+            }
+        }
+
+        void writeAddressKeyMessage(unsigned char* message, const SPHINXPrivKey& privateKey) {
+            std::memcpy(message, HD_ADDRESS_KEY_LABEL, HD_ADDRESS_KEY_LABEL_SIZE);
+            std::memcpy(message + HD_ADDRESS_KEY_LABEL_SIZE, privateKey.data(), privateKey.size());
+        }
+    } // namespace
+
+    // Function to parse a derivation path
+    HDPath parseHDPath(std::string_view path) {
+        if (path.empty() || path[0] != 'm') {
+            throw std::invalid_argument("parseHDPath: path must start with 'm'");
+        }
+        HDPath indices;
+        size_t pos = 1;
+        while (pos < path.size()) {
+            if (path[pos] != '/') {
+                throw std::invalid_argument("parseHDPath: expected '/'");
+            }
+            ++pos;
+            uint64_t value = 0;
+            const size_t digits = pos;
+            while (pos < path.size() && path[pos] >= '0' && path[pos] <= '9') {
+                value = value * 10 + static_cast<uint64_t>(path[pos] - '0');
+                if (value >= HD_PRIME_INDEX) {
+                    throw std::invalid_argument("parseHDPath: index out of range");
+                }
+                ++pos;
+            }
+            if (pos == digits) {
+                throw std::invalid_argument("parseHDPath: expected an index");
+            }
+            if (pos < path.size() && (path[pos] == '\'' || path[pos] == 'h' || path[pos] == 'H')) {
+                value |= HD_PRIME_INDEX;
+                ++pos;
+            }
+            indices.push_back(static_cast<uint32_t>(value));
+        }
+        return indices;
+    }
+
+    // Function to derive the master node of a seed
+    HDNode deriveMasterNode(std::span<const unsigned char> seed) {
+        const HmacSphinx256 hmac(std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(HD_SEED_LABEL), sizeof(HD_SEED_LABEL) - 1));
+        HDNode master;
+        hmac.mac(seed, HD_KEY_TAG, master.privateKey.data());
+        hmac.mac(seed, HD_CHAIN_TAG, master.chainCode.data());
+        return master;
+    }
+
+    // Function to derive child index of a node
+    HDNode deriveChildNode(const HDNode& parent, uint32_t index) {
+        const HmacSphinx256 hmac(parent.chainCode);
+        std::array<unsigned char, HD_CHILD_MESSAGE_SIZE> message;
+        writeChildMessage(message.data(), parent.privateKey, index);
+        HDNode child;
+        hmac.mac(message, HD_KEY_TAG, child.privateKey.data());
+        hmac.mac(message, HD_CHAIN_TAG, child.chainCode.data());
+        secureZero(message.data(), message.size());
+        return child;
+    }
+
+    // Function to return the address key of a derived private key
+    SPHINXPubKey deriveAddressKey(const SPHINXPrivKey& privateKey) {
+        std::array<unsigned char, HD_ADDRESS_KEY_MESSAGE_SIZE> message;
+        writeAddressKeyMessage(message.data(), privateKey);
+        const SPHINXPubKey addressKey = SPHINXHash::SPHINX_256(message);
+        secureZero(message.data(), message.size());
+        return addressKey;
+    }
+
+    // Function to start a deriver
+    HDKeyDeriver::HDKeyDeriver(std::span<const unsigned char> seed, size_t maxCachedNodes)
+        : master_(deriveMasterNode(seed)), maxCachedNodes_(maxCachedNodes) {}
+
+    HDKeyDeriver::~HDKeyDeriver() {
+        secureZero(&master_, sizeof(master_));
+    }
+
+    // Function to return the number of cached nodes
+    size_t HDKeyDeriver::cachedNodes() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return cache_.size();
+    }
+
+    // Function to return the node at a path
+    HDNode HDKeyDeriver::node(const HDPath& path) {
+        if (path.empty()) {
+            return master_;
+        }
+
+        // Step 1: Start from the deepest cached ancestor (or the node itself)
+        HDNode current = master_;
+        size_t depth = 0;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            for (size_t length = path.size(); length > 0; --length) {
+                const auto found = cache_.find(HDPath(path.begin(), path.begin() + static_cast<std::ptrdiff_t>(length)));
+                if (found != cache_.end()) {
+                    current = found->second;
+                    depth = length;
+                    break;
+                }
+            }
+        }
+        if (depth == path.size()) {
+            return current;
+        }
+
+        // Step 2: Derive the rest of the path and cache every node on it while there is room
+        std::vector<std::pair<HDPath, HDNode>> derived;
+        for (; depth < path.size(); ++depth) {
+            current = deriveChildNode(current, path[depth]);
+            derived.emplace_back(HDPath(path.begin(), path.begin() + static_cast<std::ptrdiff_t>(depth + 1)), current);
+        }
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            for (const auto& [prefix, node] : derived) {
+                if (cache_.size() >= maxCachedNodes_) {
+                    break;
+                }
+                cache_.emplace(prefix, node);
+            }
+        }
+        for (auto& entry : derived) {
+            secureZero(&entry.second, sizeof(entry.second));
+        }
+        return current;
+    }
+
+    // Function to derive a range of children on the shared pool
+    void HDKeyDeriver::deriveRange(const HDPath& parent, uint32_t first, size_t count, std::span<SPHINXPrivKey> privateKeys, std::span<SPHINXPubKey> addressKeys, std::span<SPHINXAddress> addresses) {
+        deriveRange(parent, first, count, privateKeys, addressKeys, addresses, ThreadPool::shared());
+    }
+
+    // Function to derive a range of children on the given pool
+    void HDKeyDeriver::deriveRange(const HDPath& parent, uint32_t first, size_t count, std::span<SPHINXPrivKey> privateKeys, std::span<SPHINXPubKey> addressKeys, std::span<SPHINXAddress> addresses, ThreadPool& pool) {
+        if ((!privateKeys.empty() && privateKeys.size() < count) || (!addressKeys.empty() && addressKeys.size() < count) || (!addresses.empty() && addresses.size() < count)) {
+            throw std::length_error("deriveRange: output shorter than count");
+        }
+        if (count > (uint64_t(1) << 32) - first) {
+            throw std::out_of_range("deriveRange: child index past 2^32 - 1");
+        }
+
+        // Step 1: Absorb the HMAC pads of the parent chain code once for the whole range
+        HDNode parentNode = node(parent);
+        const HmacSphinx256 hmac(parentNode.chainCode);
+
+        // Step 2: Derive the private keys, address keys and addresses chunk by chunk
+        pool.parallelFor(count, HD_RANGE_GRAIN, [&](size_t begin, size_t end) {
+            std::array<unsigned char, HD_CHILD_MESSAGE_SIZE> message;
+            std::array<unsigned char, HD_RANGE_GRAIN * HD_ADDRESS_KEY_MESSAGE_SIZE> addressKeyMessages;
+            std::array<SPHINXPubKey, HD_RANGE_GRAIN> chunkAddressKeys;
+            SPHINXPrivKey privateKey;
+            const size_t n = end - begin;
+
+            for (size_t i = 0; i < n; ++i) {
+                writeChildMessage(message.data(), parentNode.privateKey, static_cast<uint32_t>(first + begin + i));
+                hmac.mac(message, HD_KEY_TAG, privateKey.data());
+                if (!privateKeys.empty()) {
+                    privateKeys[begin + i] = privateKey;
+                }
+                writeAddressKeyMessage(addressKeyMessages.data() + i * HD_ADDRESS_KEY_MESSAGE_SIZE, privateKey);
+            }
+            SPHINXHash::SPHINX_256_multi(std::span<const unsigned char>(addressKeyMessages.data(), n * HD_ADDRESS_KEY_MESSAGE_SIZE), HD_ADDRESS_KEY_MESSAGE_SIZE, chunkAddressKeys[0].data());
+
+            if (!addressKeys.empty()) {
+                std::copy_n(chunkAddressKeys.begin(), n, addressKeys.begin() + static_cast<std::ptrdiff_t>(begin));
+            }
+            if (!addresses.empty()) {
+                generateAddresses(std::span<const SPHINXPubKey>(chunkAddressKeys.data(), n), "", addresses.subspan(begin, n));
+            }
+            secureZero(message.data(), message.size());
+            secureZero(addressKeyMessages.data(), n * HD_ADDRESS_KEY_MESSAGE_SIZE);
+            secureZero(privateKey.data(), privateKey.size());
+        });
+        secureZero(&parentNode, sizeof(parentNode));
+    }
+} // namespace SPHINXKey
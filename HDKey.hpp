@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+#ifndef SPHINX_HD_KEY_HPP
+#define SPHINX_HD_KEY_HPP
+
+#pragma once
+
+#include <map>
+#include <span>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <string_view>
+
+#include "Key.hpp"
+#include "SecureArena.hpp"
+
+namespace SPHINXKey {
+
+    class ThreadPool;
+
+    // Chain code of a derivation node
+    using HDChainCode = std::array<unsigned char, SPHINX_256_DIGEST_SIZE>;
+
+    // Index bit set by a ' (or h) suffix in a path. It is only part of the index, so m/0 and m/0' are different children;
+    // every child is derived from its parent's private key, there is no public (watch-only) derivation
+    constexpr uint32_t HD_PRIME_INDEX = 0x80000000u;
+
+    // Derivation path below the master node, e.g. {44 | HD_PRIME_INDEX, 0 | HD_PRIME_INDEX, 0}
+    using HDPath = std::vector<uint32_t>;
+
+    // Function to parse a path such as "m/44'/0'/0" (' or h sets HD_PRIME_INDEX), throws std::invalid_argument on malformed input
+    HDPath parseHDPath(std::string_view path);
+
+    // One node of the derivation tree: its SPHINX private key and the chain code its children are derived with
+    struct HDNode {
+        SPHINXPrivKey privateKey{};
+        HDChainCode chainCode{};
+    };
+
+    // Function to derive the master node of a seed
+    HDNode deriveMasterNode(std::span<const unsigned char> seed);
+
+    // Function to derive child index of a node
+    HDNode deriveChildNode(const HDNode& parent, uint32_t index);
+
+    // Function to return the address key of a derived private key: SPHINX_256 over a label and the private key
+    // This is a standalone SPHINX identifier, not the public half of a SPHINXHybridKey key pair: nothing can be verified, encrypted or
+    // exchanged against it, it only names the derived private key and is what generateAddress turns into the derived address
+    SPHINXPubKey deriveAddressKey(const SPHINXPrivKey& privateKey);
+
+    // Hierarchical deterministic derivation of SPHINX private keys, address keys and addresses from one seed
+    // The derived keys are standalone SPHINX identifiers (see deriveAddressKey); Curve448 / Kyber1024 key pairs are not derived,
+    // since hybrid_key.cpp has no seeded key generation
+    // Nodes on the paths asked for are cached (in SecureArena memory), so deriving below an account node starts from that node instead of the root
+    class HDKeyDeriver {
+    public:
+        // Function to start a deriver, at most maxCachedNodes path nodes are kept
+        explicit HDKeyDeriver(std::span<const unsigned char> seed, size_t maxCachedNodes = 4096);
+        ~HDKeyDeriver();
+
+        HDKeyDeriver(const HDKeyDeriver&) = delete;
+        HDKeyDeriver& operator=(const HDKeyDeriver&) = delete;
+
+        // Function to return the node at a path, deriving from the deepest cached ancestor
+        HDNode node(const HDPath& path);
+
+        // Function to derive the children first .. first + count - 1 of the node at parent in parallel
+        // Outputs are contiguous: item i (index first + i) goes to privateKeys[i], addressKeys[i] and addresses[i]; pass an empty span to skip an output
+        // Throws std::length_error if a non-empty output is shorter than count and std::out_of_range if the indices would pass 2^32 - 1
+        void deriveRange(const HDPath& parent, uint32_t first, size_t count, std::span<SPHINXPrivKey> privateKeys, std::span<SPHINXPubKey> addressKeys, std::span<SPHINXAddress> addresses);
+        void deriveRange(const HDPath& parent, uint32_t first, size_t count, std::span<SPHINXPrivKey> privateKeys, std::span<SPHINXPubKey> addressKeys, std::span<SPHINXAddress> addresses, ThreadPool& pool);
+
+        // Function to return the number of cached nodes
+        size_t cachedNodes() const;
+
+    private:
+        using NodeCache = std::map<HDPath, HDNode, std::less<HDPath>, SecureAllocator<std::pair<const HDPath, HDNode>>>;
+
+        HDNode master_;
+        const size_t maxCachedNodes_;
+        mutable std::shared_mutex mutex_;
+        NodeCache cache_;
+    };
+} // namespace SPHINXKey
+
+#endif // SPHINX_HD_KEY_HPP
@@ -0,0 +1,526 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code implements the streaming SPHINX_256 and RIPEMD_160 hashers used by SPHINXKey.
+
+// BlockHasher (Hasher.hpp):
+    // A hasher is created (init), absorbs any number of buffers (update) and pads the message to produce the digest (finalize).
+    // Whole 64-byte blocks are compressed directly from the caller's buffer; only a partial block is copied into the hasher.
+    // Copying a hasher copies its midstate, so a prefix that many messages share (for example the address version byte) is compressed only once.
+
+// SPHINX256Traits::compress Function:
+    // Stand-in compression function for SPHINX_256 until the SPHINXHash module provides its own; it runs the SHA-256 rounds so that digests are 32 bytes and well distributed.
+
+// RIPEMD160Traits::compress Function:
+    // The RIPEMD-160 compression function: two parallel lines of 80 steps over the little-endian message words, combined into the five chaining words.
+
+// SPHINX_256 and RIPEMD_160 Functions:
+    // One-shot wrappers that run a single update and finalize.
+
+// SPHINX_256_multi and RIPEMD_160_multi Functions:
+    // Hash many independent messages of equal length at once, one message per 32-bit SIMD lane: 4 lanes with SSE4.1, 8 with AVX2 and 16 with AVX-512.
+    // A single kernel template written with GCC/Clang vector extensions is inlined into one wrapper per instruction set, so the rest of the file keeps the baseline target flags.
+    // The widest kernel the CPU supports is chosen once from CPUID (__builtin_cpu_supports); setMultiBufferKernel can force a narrower one, and other compilers or architectures fall back to the scalar hashers.
+    // Since every lane has the same length, all lanes share the block count and padding layout; a short last group repeats one message in the spare lanes and drops their digests.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <span>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <atomic>
+#include <algorithm>
+
+#include "Hasher.hpp"
+
+
+namespace SPHINXHash {
+
+    namespace {
+        inline uint32_t rotl(uint32_t x, unsigned n) {
+            return (x << n) | (x >> (32 - n));
+        }
+
+        inline uint32_t rotr(uint32_t x, unsigned n) {
+            return (x >> n) | (x << (32 - n));
+        }
+
+        inline uint32_t loadBE32(const unsigned char* p) {
+            return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                   (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+        }
+
+        inline uint32_t loadLE32(const unsigned char* p) {
+            return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                   (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+
+        // SPHINX_256 round constants
+        constexpr uint32_t SPHINX256_K[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+        };
+
+        // RIPEMD-160 message word selection and rotation amounts for the left and right lines
+        constexpr uint8_t RIPEMD160_R[80] = {
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+            7, 4, 13, 1, 10, 6, 15, 3, 12, 0, 9, 5, 2, 14, 11, 8,
+            3, 10, 14, 4, 9, 15, 8, 1, 2, 7, 0, 6, 13, 11, 5, 12,
+            1, 9, 11, 10, 0, 8, 12, 4, 13, 3, 7, 15, 14, 5, 6, 2,
+            4, 0, 5, 9, 7, 12, 2, 10, 14, 1, 3, 8, 11, 6, 15, 13
+        };
+        constexpr uint8_t RIPEMD160_RP[80] = {
+            5, 14, 7, 0, 9, 2, 11, 4, 13, 6, 15, 8, 1, 10, 3, 12,
+            6, 11, 3, 7, 0, 13, 5, 10, 14, 15, 8, 12, 4, 9, 1, 2,
+            15, 5, 1, 3, 7, 14, 6, 9, 11, 8, 12, 2, 10, 0, 4, 13,
+            8, 6, 4, 1, 3, 11, 15, 0, 5, 12, 2, 13, 9, 7, 10, 14,
+            12, 15, 10, 4, 1, 5, 8, 7, 6, 2, 13, 14, 0, 3, 9, 11
+        };
+        constexpr uint8_t RIPEMD160_S[80] = {
+            11, 14, 15, 12, 5, 8, 7, 9, 11, 13, 14, 15, 6, 7, 9, 8,
+            7, 6, 8, 13, 11, 9, 7, 15, 7, 12, 15, 9, 11, 7, 13, 12,
+            11, 13, 6, 7, 14, 9, 13, 15, 14, 8, 13, 6, 5, 12, 7, 5,
+            11, 12, 14, 15, 14, 15, 9, 8, 9, 14, 5, 6, 8, 6, 5, 12,
+            9, 15, 5, 11, 6, 8, 13, 12, 5, 12, 13, 14, 11, 8, 5, 6
+        };
+        constexpr uint8_t RIPEMD160_SP[80] = {
+            8, 9, 9, 11, 13, 15, 15, 5, 7, 7, 8, 11, 14, 14, 12, 6,
+            9, 13, 15, 7, 12, 8, 9, 11, 7, 7, 12, 7, 6, 15, 13, 11,
+            9, 7, 15, 11, 8, 6, 6, 14, 12, 13, 5, 14, 13, 13, 7, 5,
+            15, 5, 8, 11, 14, 14, 6, 14, 6, 9, 12, 9, 12, 5, 15, 8,
+            8, 5, 12, 9, 12, 5, 14, 6, 8, 13, 6, 5, 15, 13, 11, 11
+        };
+        constexpr uint32_t RIPEMD160_K[5] = {0x00000000, 0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xa953fd4e};
+        constexpr uint32_t RIPEMD160_KP[5] = {0x50a28be6, 0x5c4dd124, 0x6d703ef3, 0x7a6d76e9, 0x00000000};
+
+        // RIPEMD-160 boolean function of the given 16-step round
+        inline uint32_t ripemd160F(unsigned round, uint32_t x, uint32_t y, uint32_t z) {
+            switch (round) {
+                case 0: return x ^ y ^ z;
+                case 1: return (x & y) | (~x & z);
+                case 2: return (x | ~y) ^ z;
+                case 3: return (x & z) | (y & ~z);
+                default: return x ^ (y | ~z);
+            }
+        }
+    } // namespace
+
+    // Function to compress count consecutive 64-byte blocks into state
+    void SPHINX256Traits::compress(uint32_t* state, const unsigned char* blocks, size_t count) {
+        for (; count > 0; --count, blocks += 64) {
+            uint32_t w[64];
+            for (size_t i = 0; i < 16; ++i) {
+                w[i] = loadBE32(blocks + 4 * i);
+            }
+            for (size_t i = 16; i < 64; ++i) {
+                const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+
+            uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+            uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+            for (size_t i = 0; i < 64; ++i) {
+                const uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + SPHINX256_K[i] + w[i];
+                const uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                h = g;
+                g = f;
+                f = e;
+                e = d + t1;
+                d = c;
+                c = b;
+                b = a;
+                a = t1 + t2;
+            }
+            state[0] += a;
+            state[1] += b;
+            state[2] += c;
+            state[3] += d;
+            state[4] += e;
+            state[5] += f;
+            state[6] += g;
+            state[7] += h;
+        }
+    }
+
+    // Function to compress count consecutive 64-byte blocks into state
+    void RIPEMD160Traits::compress(uint32_t* state, const unsigned char* blocks, size_t count) {
+        for (; count > 0; --count, blocks += 64) {
+            uint32_t x[16];
+            for (size_t i = 0; i < 16; ++i) {
+                x[i] = loadLE32(blocks + 4 * i);
+            }
+
+            uint32_t al = state[0], bl = state[1], cl = state[2], dl = state[3], el = state[4];
+            uint32_t ar = al, br = bl, cr = cl, dr = dl, er = el;
+            for (unsigned j = 0; j < 80; ++j) {
+                const unsigned round = j / 16;
+                uint32_t t = rotl(al + ripemd160F(round, bl, cl, dl) + x[RIPEMD160_R[j]] + RIPEMD160_K[round], RIPEMD160_S[j]) + el;
+                al = el;
+                el = dl;
+                dl = rotl(cl, 10);
+                cl = bl;
+                bl = t;
+
+                t = rotl(ar + ripemd160F(4 - round, br, cr, dr) + x[RIPEMD160_RP[j]] + RIPEMD160_KP[round], RIPEMD160_SP[j]) + er;
+                ar = er;
+                er = dr;
+                dr = rotl(cr, 10);
+                cr = br;
+                br = t;
+            }
+
+            const uint32_t t = state[1] + cl + dr;
+            state[1] = state[2] + dl + er;
+            state[2] = state[3] + el + ar;
+            state[3] = state[4] + al + br;
+            state[4] = state[0] + bl + cr;
+            state[0] = t;
+        }
+    }
+
+    // Assume the definition of SPHINX_256 function
+    SPHINX256Digest SPHINX_256(std::span<const unsigned char> data) {
+        return SPHINX256Hasher().update(data).finalize();
+    }
+
+    // Function to compute the RIPEMD-160 hash
+    RIPEMD160Digest RIPEMD_160(std::span<const unsigned char> data) {
+        return RIPEMD160Hasher().update(data).finalize();
+    }
+} // namespace SPHINXHash
+
+// Multi-buffer kernels: GCC/Clang vector extensions let one kernel template serve every lane count;
+// each instantiation is inlined (flatten) into a wrapper compiled for its instruction set
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SPHINX_HASH_MULTI_BUFFER 1
+#endif
+
+namespace SPHINXHash {
+
+    namespace {
+#if defined(SPHINX_HASH_MULTI_BUFFER)
+        typedef uint32_t Lanes4 __attribute__((vector_size(16)));
+        typedef uint32_t Lanes8 __attribute__((vector_size(32)));
+        typedef uint32_t Lanes16 __attribute__((vector_size(64)));
+
+#define SPHINX_LANES_ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define SPHINX_LANES_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+        // SPHINX_256 compression of one block per lane
+        struct SPHINX256Lanes {
+            using Traits = SPHINX256Traits;
+
+            template <typename V, size_t L>
+            static inline __attribute__((always_inline)) void compress(V* state, const unsigned char* const* blocks) {
+                V w[64];
+                for (size_t i = 0; i < 16; ++i) {
+                    for (size_t l = 0; l < L; ++l) {
+                        w[i][l] = loadBE32(blocks[l] + 4 * i);
+                    }
+                }
+                for (size_t i = 16; i < 64; ++i) {
+                    const V s0 = SPHINX_LANES_ROTR(w[i - 15], 7) ^ SPHINX_LANES_ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                    const V s1 = SPHINX_LANES_ROTR(w[i - 2], 17) ^ SPHINX_LANES_ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+                }
+
+                V a = state[0], b = state[1], c = state[2], d = state[3];
+                V e = state[4], f = state[5], g = state[6], h = state[7];
+                for (size_t i = 0; i < 64; ++i) {
+                    const V t1 = h + (SPHINX_LANES_ROTR(e, 6) ^ SPHINX_LANES_ROTR(e, 11) ^ SPHINX_LANES_ROTR(e, 25)) + ((e & f) ^ (~e & g)) + SPHINX256_K[i] + w[i];
+                    const V t2 = (SPHINX_LANES_ROTR(a, 2) ^ SPHINX_LANES_ROTR(a, 13) ^ SPHINX_LANES_ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                    h = g;
+                    g = f;
+                    f = e;
+                    e = d + t1;
+                    d = c;
+                    c = b;
+                    b = a;
+                    a = t1 + t2;
+                }
+                state[0] += a;
+                state[1] += b;
+                state[2] += c;
+                state[3] += d;
+                state[4] += e;
+                state[5] += f;
+                state[6] += g;
+                state[7] += h;
+            }
+        };
+
+        // RIPEMD-160 compression of one block per lane
+        struct RIPEMD160Lanes {
+            using Traits = RIPEMD160Traits;
+
+            // Boolean function of the given round, written through out so no vector crosses a call boundary by value
+            template <typename V>
+            static inline __attribute__((always_inline)) void f(unsigned round, const V& x, const V& y, const V& z, V& out) {
+                switch (round) {
+                    case 0: out = x ^ y ^ z; break;
+                    case 1: out = (x & y) | (~x & z); break;
+                    case 2: out = (x | ~y) ^ z; break;
+                    case 3: out = (x & z) | (y & ~z); break;
+                    default: out = x ^ (y | ~z); break;
+                }
+            }
+
+            template <typename V, size_t L>
+            static inline __attribute__((always_inline)) void compress(V* state, const unsigned char* const* blocks) {
+                V x[16];
+                for (size_t i = 0; i < 16; ++i) {
+                    for (size_t l = 0; l < L; ++l) {
+                        x[i][l] = loadLE32(blocks[l] + 4 * i);
+                    }
+                }
+
+                V al = state[0], bl = state[1], cl = state[2], dl = state[3], el = state[4];
+                V ar = al, br = bl, cr = cl, dr = dl, er = el;
+                for (unsigned round = 0; round < 5; ++round) {
+                    for (unsigned k = 0; k < 16; ++k) {
+                        const unsigned j = round * 16 + k;
+                        V fl, fr;
+                        f(round, bl, cl, dl, fl);
+                        V t = al + fl + x[RIPEMD160_R[j]] + RIPEMD160_K[round];
+                        t = SPHINX_LANES_ROTL(t, RIPEMD160_S[j]) + el;
+                        al = el;
+                        el = dl;
+                        dl = SPHINX_LANES_ROTL(cl, 10);
+                        cl = bl;
+                        bl = t;
+
+                        f(4 - round, br, cr, dr, fr);
+                        t = ar + fr + x[RIPEMD160_RP[j]] + RIPEMD160_KP[round];
+                        t = SPHINX_LANES_ROTL(t, RIPEMD160_SP[j]) + er;
+                        ar = er;
+                        er = dr;
+                        dr = SPHINX_LANES_ROTL(cr, 10);
+                        cr = br;
+                        br = t;
+                    }
+                }
+
+                const V t = state[1] + cl + dr;
+                state[1] = state[2] + dl + er;
+                state[2] = state[3] + el + ar;
+                state[3] = state[4] + al + br;
+                state[4] = state[0] + bl + cr;
+                state[0] = t;
+            }
+        };
+
+#undef SPHINX_LANES_ROTL
+#undef SPHINX_LANES_ROTR
+
+        // Hash L equal-length messages, one per lane, with the same padding as BlockHasher::finalize
+        template <typename Algo, typename V, size_t L>
+        inline __attribute__((always_inline)) void hashLanes(const unsigned char* const* messages, size_t length, unsigned char* const* digests) {
+            using Traits = typename Algo::Traits;
+            constexpr size_t BLOCK_SIZE = 64;
+
+            // Every lane has the same length, so the whole-block count and the padded tail layout are shared
+            const size_t wholeBlocks = length / BLOCK_SIZE;
+            const size_t rest = length % BLOCK_SIZE;
+            const size_t tailBlocks = (rest + 9 > BLOCK_SIZE) ? 2 : 1;
+            const uint64_t bits = static_cast<uint64_t>(length) * 8;
+            unsigned char tails[L][2 * BLOCK_SIZE];
+            for (size_t l = 0; l < L; ++l) {
+                std::memset(tails[l], 0, tailBlocks * BLOCK_SIZE);
+                std::memcpy(tails[l], messages[l] + wholeBlocks * BLOCK_SIZE, rest);
+                tails[l][rest] = 0x80;
+                for (size_t i = 0; i < 8; ++i) {
+                    const size_t shift = Traits::bigEndian ? 56 - 8 * i : 8 * i;
+                    tails[l][tailBlocks * BLOCK_SIZE - 8 + i] = static_cast<unsigned char>(bits >> shift);
+                }
+            }
+
+            V state[Traits::STATE_WORDS];
+            for (size_t w = 0; w < Traits::STATE_WORDS; ++w) {
+                state[w] = V{} + Traits::IV[w];
+            }
+            const unsigned char* blocks[L];
+            for (size_t b = 0; b < wholeBlocks; ++b) {
+                for (size_t l = 0; l < L; ++l) {
+                    blocks[l] = messages[l] + b * BLOCK_SIZE;
+                }
+                Algo::template compress<V, L>(state, blocks);
+            }
+            for (size_t b = 0; b < tailBlocks; ++b) {
+                for (size_t l = 0; l < L; ++l) {
+                    blocks[l] = tails[l] + b * BLOCK_SIZE;
+                }
+                Algo::template compress<V, L>(state, blocks);
+            }
+
+            for (size_t l = 0; l < L; ++l) {
+                for (size_t i = 0; i < Traits::DIGEST_SIZE; ++i) {
+                    const uint32_t word = state[i / 4][l];
+                    const size_t shift = Traits::bigEndian ? 24 - 8 * (i % 4) : 8 * (i % 4);
+                    digests[l][i] = static_cast<unsigned char>(word >> shift);
+                }
+            }
+        }
+
+        // One wrapper per instruction set; flatten inlines the kernel so it is compiled for that target
+        template <typename Algo>
+        __attribute__((target("sse4.1"), flatten)) void hashLanesSSE41(const unsigned char* const* messages, size_t length, unsigned char* const* digests) {
+            hashLanes<Algo, Lanes4, 4>(messages, length, digests);
+        }
+
+        template <typename Algo>
+        __attribute__((target("avx2"), flatten)) void hashLanesAVX2(const unsigned char* const* messages, size_t length, unsigned char* const* digests) {
+            hashLanes<Algo, Lanes8, 8>(messages, length, digests);
+        }
+
+        template <typename Algo>
+        __attribute__((target("avx512f"), flatten)) void hashLanesAVX512(const unsigned char* const* messages, size_t length, unsigned char* const* digests) {
+            hashLanes<Algo, Lanes16, 16>(messages, length, digests);
+        }
+
+        MultiBufferKernel detectMultiBufferKernel() {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) {
+                return MultiBufferKernel::AVX512;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return MultiBufferKernel::AVX2;
+            }
+            if (__builtin_cpu_supports("sse4.1")) {
+                return MultiBufferKernel::SSE41;
+            }
+            return MultiBufferKernel::Scalar;
+        }
+#else
+        // Without vector extensions only the scalar path is compiled
+        struct SPHINX256Lanes {
+            using Traits = SPHINX256Traits;
+        };
+
+        struct RIPEMD160Lanes {
+            using Traits = RIPEMD160Traits;
+        };
+
+        MultiBufferKernel detectMultiBufferKernel() {
+            return MultiBufferKernel::Scalar;
+        }
+#endif
+
+        // Widest kernel supported by the CPU, detected once
+        MultiBufferKernel supportedMultiBufferKernel() {
+            static const MultiBufferKernel kernel = detectMultiBufferKernel();
+            return kernel;
+        }
+
+        std::atomic<MultiBufferKernel>& activeMultiBufferKernel() {
+            static std::atomic<MultiBufferKernel> kernel{supportedMultiBufferKernel()};
+            return kernel;
+        }
+
+        template <typename Algo>
+        void hashMulti(const unsigned char* const* messages, size_t length, size_t count, unsigned char* digests) {
+            using Traits = typename Algo::Traits;
+            const MultiBufferKernel kernel = multiBufferKernel();
+            const size_t lanes = multiBufferLanes(kernel);
+
+            size_t i = 0;
+#if defined(SPHINX_HASH_MULTI_BUFFER)
+            if (lanes > 1) {
+                const unsigned char* laneMessages[16];
+                unsigned char* laneDigests[16];
+                unsigned char spare[16][Traits::DIGEST_SIZE];
+                while (i < count) {
+                    // A short last group repeats its first message in the unused lanes and discards their digests
+                    const size_t n = std::min(lanes, count - i);
+                    for (size_t l = 0; l < lanes; ++l) {
+                        laneMessages[l] = messages[i + (l < n ? l : 0)];
+                        laneDigests[l] = (l < n) ? digests + (i + l) * Traits::DIGEST_SIZE : spare[l];
+                    }
+                    switch (kernel) {
+                        case MultiBufferKernel::AVX512: hashLanesAVX512<Algo>(laneMessages, length, laneDigests); break;
+                        case MultiBufferKernel::AVX2: hashLanesAVX2<Algo>(laneMessages, length, laneDigests); break;
+                        default: hashLanesSSE41<Algo>(laneMessages, length, laneDigests); break;
+                    }
+                    i += n;
+                }
+            }
+#endif
+            for (; i < count; ++i) {
+                BlockHasher<Traits> hasher;
+                hasher.update(messages[i], length);
+                hasher.finalize(digests + i * Traits::DIGEST_SIZE);
+            }
+        }
+
+        template <typename Algo>
+        void hashMultiContiguous(std::span<const unsigned char> messages, size_t length, unsigned char* digests) {
+            // Hand the kernel pointer arrays in small groups so no allocation is needed
+            constexpr size_t GROUP = 64;
+            const size_t count = (length == 0) ? 0 : messages.size() / length;
+            const unsigned char* pointers[GROUP];
+            for (size_t i = 0; i < count; i += GROUP) {
+                const size_t n = std::min(GROUP, count - i);
+                for (size_t k = 0; k < n; ++k) {
+                    pointers[k] = messages.data() + (i + k) * length;
+                }
+                hashMulti<Algo>(pointers, length, n, digests + i * Algo::Traits::DIGEST_SIZE);
+            }
+        }
+    } // namespace
+
+    // Function to return the kernel in use
+    MultiBufferKernel multiBufferKernel() {
+        return activeMultiBufferKernel().load(std::memory_order_relaxed);
+    }
+
+    // Function to override the kernel
+    void setMultiBufferKernel(MultiBufferKernel kernel) {
+        activeMultiBufferKernel().store(std::min(kernel, supportedMultiBufferKernel()), std::memory_order_relaxed);
+    }
+
+    // Function to return the number of lanes of a kernel
+    size_t multiBufferLanes(MultiBufferKernel kernel) {
+        switch (kernel) {
+            case MultiBufferKernel::AVX512: return 16;
+            case MultiBufferKernel::AVX2: return 8;
+            case MultiBufferKernel::SSE41: return 4;
+            default: return 1;
+        }
+    }
+
+    // Functions to hash count independent messages of equal length in parallel SIMD lanes
+    void SPHINX_256_multi(const unsigned char* const* messages, size_t length, size_t count, unsigned char* digests) {
+        hashMulti<SPHINX256Lanes>(messages, length, count, digests);
+    }
+
+    void RIPEMD_160_multi(const unsigned char* const* messages, size_t length, size_t count, unsigned char* digests) {
+        hashMulti<RIPEMD160Lanes>(messages, length, count, digests);
+    }
+
+    void SPHINX_256_multi(std::span<const unsigned char> messages, size_t length, unsigned char* digests) {
+        hashMultiContiguous<SPHINX256Lanes>(messages, length, digests);
+    }
+
+    void RIPEMD_160_multi(std::span<const unsigned char> messages, size_t length, unsigned char* digests) {
+        hashMultiContiguous<RIPEMD160Lanes>(messages, length, digests);
+    }
+} // namespace SPHINXHash
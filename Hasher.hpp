@@ -0,0 +1,189 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+#ifndef SPHINX_HASHER_HPP
+#define SPHINX_HASHER_HPP
+
+#pragma once
+
+#include <span>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace SPHINXHash {
+
+    // Digest sizes of SPHINX_256 and RIPEMD_160
+    constexpr size_t SPHINX_256_DIGEST_SIZE = 32;
+    constexpr size_t RIPEMD_160_DIGEST_SIZE = 20;
+
+    using SPHINX256Digest = std::array<unsigned char, SPHINX_256_DIGEST_SIZE>;
+    using RIPEMD160Digest = std::array<unsigned char, RIPEMD_160_DIGEST_SIZE>;
+
+    // SPHINX_256 parameters; the compression function is a stand-in for the SPHINXHash module (SHA-256 rounds)
+    struct SPHINX256Traits {
+        static constexpr size_t STATE_WORDS = 8;
+        static constexpr size_t DIGEST_SIZE = SPHINX_256_DIGEST_SIZE;
+        static constexpr bool bigEndian = true;
+        static constexpr std::array<uint32_t, STATE_WORDS> IV = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+        };
+
+        // Function to compress count consecutive 64-byte blocks into state
+        static void compress(uint32_t* state, const unsigned char* blocks, size_t count);
+    };
+
+    // RIPEMD-160 parameters
+    struct RIPEMD160Traits {
+        static constexpr size_t STATE_WORDS = 5;
+        static constexpr size_t DIGEST_SIZE = RIPEMD_160_DIGEST_SIZE;
+        static constexpr bool bigEndian = false;
+        static constexpr std::array<uint32_t, STATE_WORDS> IV = {
+            0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0
+        };
+
+        // Function to compress count consecutive 64-byte blocks into state
+        static void compress(uint32_t* state, const unsigned char* blocks, size_t count);
+    };
+
+    // Streaming (init / update / finalize) hasher over 64-byte blocks with Merkle-Damgard padding
+    // update() absorbs any number of non-contiguous buffers; copying a hasher keeps its midstate,
+    // so a shared prefix is compressed once and finished many times
+    template <typename Traits>
+    class BlockHasher {
+    public:
+        static constexpr size_t BLOCK_SIZE = 64;
+        static constexpr size_t DIGEST_SIZE = Traits::DIGEST_SIZE;
+        using Digest = std::array<unsigned char, DIGEST_SIZE>;
+
+        BlockHasher() { init(); }
+
+        // Function to reset the hasher to the initial state
+        void init() {
+            state_ = Traits::IV;
+            length_ = 0;
+        }
+
+        // Function to absorb data
+        BlockHasher& update(std::span<const unsigned char> data) {
+            const unsigned char* p = data.data();
+            size_t n = data.size();
+            size_t used = static_cast<size_t>(length_ % BLOCK_SIZE);
+            length_ += n;
+
+            // Top up a partially filled block first
+            if (used > 0) {
+                const size_t take = std::min(n, BLOCK_SIZE - used);
+                std::memcpy(buffer_.data() + used, p, take);
+                p += take;
+                n -= take;
+                used += take;
+                if (used < BLOCK_SIZE) {
+                    return *this;
+                }
+                Traits::compress(state_.data(), buffer_.data(), 1);
+            }
+
+            // Compress whole blocks straight from the caller's buffer
+            const size_t blocks = n / BLOCK_SIZE;
+            if (blocks > 0) {
+                Traits::compress(state_.data(), p, blocks);
+                p += blocks * BLOCK_SIZE;
+                n -= blocks * BLOCK_SIZE;
+            }
+            if (n > 0) {
+                std::memcpy(buffer_.data(), p, n);
+            }
+            return *this;
+        }
+
+        BlockHasher& update(const unsigned char* data, size_t length) {
+            return update(std::span<const unsigned char>(data, length));
+        }
+
+        // Function to pad the message and write the digest, copy the hasher first to keep the midstate
+        void finalize(unsigned char* out) {
+            const uint64_t bits = length_ * 8;
+            size_t used = static_cast<size_t>(length_ % BLOCK_SIZE);
+            buffer_[used++] = 0x80;
+            if (used > BLOCK_SIZE - 8) {
+                std::memset(buffer_.data() + used, 0, BLOCK_SIZE - used);
+                Traits::compress(state_.data(), buffer_.data(), 1);
+                used = 0;
+            }
+            std::memset(buffer_.data() + used, 0, BLOCK_SIZE - 8 - used);
+            for (size_t i = 0; i < 8; ++i) {
+                const size_t shift = Traits::bigEndian ? 56 - 8 * i : 8 * i;
+                buffer_[BLOCK_SIZE - 8 + i] = static_cast<unsigned char>(bits >> shift);
+            }
+            Traits::compress(state_.data(), buffer_.data(), 1);
+
+            for (size_t i = 0; i < DIGEST_SIZE; ++i) {
+                const uint32_t word = state_[i / 4];
+                const size_t shift = Traits::bigEndian ? 24 - 8 * (i % 4) : 8 * (i % 4);
+                out[i] = static_cast<unsigned char>(word >> shift);
+            }
+        }
+
+        Digest finalize() {
+            Digest digest;
+            finalize(digest.data());
+            return digest;
+        }
+
+        // Function to return the number of bytes absorbed so far
+        uint64_t size() const { return length_; }
+
+    private:
+        std::array<uint32_t, Traits::STATE_WORDS> state_;
+        std::array<unsigned char, BLOCK_SIZE> buffer_;
+        uint64_t length_;
+    };
+
+    using SPHINX256Hasher = BlockHasher<SPHINX256Traits>;
+    using RIPEMD160Hasher = BlockHasher<RIPEMD160Traits>;
+
+    // Assume the definition of SPHINX_256 function
+    SPHINX256Digest SPHINX_256(std::span<const unsigned char> data);
+    RIPEMD160Digest RIPEMD_160(std::span<const unsigned char> data);
+
+    // SIMD kernels for multi-buffer hashing, each hashes one message per 32-bit lane
+    enum class MultiBufferKernel {
+        Scalar,  // 1 lane
+        SSE41,   // 4 lanes
+        AVX2,    // 8 lanes
+        AVX512   // 16 lanes
+    };
+
+    // Function to return the kernel in use (the widest one the CPU supports unless overridden)
+    MultiBufferKernel multiBufferKernel();
+
+    // Function to override the kernel, kernels the CPU does not support fall back to the widest supported one
+    void setMultiBufferKernel(MultiBufferKernel kernel);
+
+    // Function to return the number of lanes of a kernel
+    size_t multiBufferLanes(MultiBufferKernel kernel);
+
+    // Functions to hash count independent messages of equal length in parallel SIMD lanes
+    // Digest i is written at digests + i * DIGEST_SIZE; results are identical to SPHINX_256 / RIPEMD_160 on each message
+    void SPHINX_256_multi(const unsigned char* const* messages, size_t length, size_t count, unsigned char* digests);
+    void RIPEMD_160_multi(const unsigned char* const* messages, size_t length, size_t count, unsigned char* digests);
+
+    // Same as above for messages stored back to back, messages.size() must be a multiple of length
+    void SPHINX_256_multi(std::span<const unsigned char> messages, size_t length, unsigned char* digests);
+    void RIPEMD_160_multi(std::span<const unsigned char> messages, size_t length, unsigned char* digests);
+} // namespace SPHINXHash
+
+#endif // SPHINX_HASHER_HPP
@@ -0,0 +1,84 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code implements batched hybrid KEM encapsulation and decapsulation on top of the SPHINXHybridKey functions.
+
+// encapsulateHybridSharedSecrets Function:
+    // Encapsulates to a span of recipients (a broadcast to many key pairs) by calling encapsulateHybridSharedSecret for each of them.
+    // The recipients are split into chunks of KEM_BATCH_GRAIN that run on the work-stealing ThreadPool (ThreadPool.hpp); the calling thread helps.
+    // Results are written in place at the recipient's index, so the output order is the input order whatever order the chunks finish in.
+    // The ciphertext of each result is written into the existing encapsulatedKey buffer, so reusing the results span across batches makes no allocation for it.
+
+// decapsulateHybridSharedSecrets Function:
+    // Decapsulates a span of encapsulated keys with one key pair; every worker reads the same key pair by reference, it is never copied.
+
+// Both functions produce exactly what the per-call loop produces: each item goes through the same SPHINXHybridKey call with the same inputs.
+// The X448 and Kyber1024 halves of the KEM live inside encapsulateHybridSharedSecret / decapsulateHybridSharedSecret (hybrid_key.cpp), so batching happens at the level of whole calls.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <span>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "Hybrid_key.hpp"
+#include "Key.hpp"
+#include "ThreadPool.hpp"
+#include "HybridKem.hpp"
+
+
+namespace SPHINXKey {
+
+    namespace {
+        // Items per parallelFor chunk; one KEM call is far longer than the cost of scheduling a chunk
+        constexpr size_t KEM_BATCH_GRAIN = 8;
+    } // namespace
+
+    // Function to encapsulate a shared secret to every recipient on the shared pool
+    void encapsulateHybridSharedSecrets(std::span<const SPHINXHybridKey::HybridKeypair> recipients, std::span<HybridEncapsulation> results) {
+        encapsulateHybridSharedSecrets(recipients, results, ThreadPool::shared());
+    }
+
+    // Function to encapsulate a shared secret to every recipient on the given pool
+    void encapsulateHybridSharedSecrets(std::span<const SPHINXHybridKey::HybridKeypair> recipients, std::span<HybridEncapsulation> results, ThreadPool& pool) {
+        if (results.size() < recipients.size()) {
+            throw std::length_error("encapsulateHybridSharedSecrets: fewer results than recipients");
+        }
+        pool.parallelFor(recipients.size(), KEM_BATCH_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                results[i].sharedSecret = SPHINXHybridKey::encapsulateHybridSharedSecret(recipients[i], results[i].encapsulatedKey);
+            }
+        });
+    }
+
+    // Function to decapsulate many encapsulated keys with one key pair on the shared pool
+    void decapsulateHybridSharedSecrets(const SPHINXHybridKey::HybridKeypair& keypair, std::span<const std::vector<uint8_t>> encapsulatedKeys, std::span<std::string> sharedSecrets) {
+        decapsulateHybridSharedSecrets(keypair, encapsulatedKeys, sharedSecrets, ThreadPool::shared());
+    }
+
+    // Function to decapsulate many encapsulated keys with one key pair on the given pool
+    void decapsulateHybridSharedSecrets(const SPHINXHybridKey::HybridKeypair& keypair, std::span<const std::vector<uint8_t>> encapsulatedKeys, std::span<std::string> sharedSecrets, ThreadPool& pool) {
+        if (sharedSecrets.size() < encapsulatedKeys.size()) {
+            throw std::length_error("decapsulateHybridSharedSecrets: fewer shared secrets than encapsulated keys");
+        }
+        pool.parallelFor(encapsulatedKeys.size(), KEM_BATCH_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                sharedSecrets[i] = SPHINXHybridKey::decapsulateHybridSharedSecret(keypair, encapsulatedKeys[i]);
+            }
+        });
+    }
+} // namespace SPHINXKey
@@ -0,0 +1,48 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+#ifndef SPHINX_HYBRID_KEM_HPP
+#define SPHINX_HYBRID_KEM_HPP
+
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "Key.hpp"
+#include "ThreadPool.hpp"
+
+namespace SPHINXKey {
+
+    // Output of one hybrid encapsulation
+    // The encapsulatedKey buffer keeps its capacity, so a results span reused across batches does not reallocate
+    struct HybridEncapsulation {
+        std::string sharedSecret;
+        std::vector<uint8_t> encapsulatedKey;
+    };
+
+    // Function to encapsulate a shared secret to every recipient, results[i] receives the encapsulation to recipients[i]
+    // Each result is what encapsulateHybridSharedSecret returns for that recipient; the first exception thrown is rethrown
+    void encapsulateHybridSharedSecrets(std::span<const SPHINXHybridKey::HybridKeypair> recipients, std::span<HybridEncapsulation> results);
+    void encapsulateHybridSharedSecrets(std::span<const SPHINXHybridKey::HybridKeypair> recipients, std::span<HybridEncapsulation> results, ThreadPool& pool);
+
+    // Function to decapsulate many encapsulated keys with one key pair, sharedSecrets[i] receives the secret of encapsulatedKeys[i]
+    // Each secret is what decapsulateHybridSharedSecret returns for that key; the first exception thrown is rethrown
+    void decapsulateHybridSharedSecrets(const SPHINXHybridKey::HybridKeypair& keypair, std::span<const std::vector<uint8_t>> encapsulatedKeys, std::span<std::string> sharedSecrets);
+    void decapsulateHybridSharedSecrets(const SPHINXHybridKey::HybridKeypair& keypair, std::span<const std::vector<uint8_t>> encapsulatedKeys, std::span<std::string> sharedSecrets, ThreadPool& pool);
+} // namespace SPHINXKey
+
+#endif // SPHINX_HYBRID_KEM_HPP
@@ -0,0 +1,236 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code implements the opt-in instrumentation of the SPHINXKey hot paths.
+
+// Recording:
+    // Building with SPHINX_KEY_INSTRUMENTATION turns SPHINX_INSTRUMENT_SCOPE into a StageTimer that times the enclosing function; without it the macro is an empty statement and nothing below is reached.
+    // Each thread records into its own buffer (call count, bytes, total and max nanoseconds, latency histogram per stage), created on the thread's first call.
+    // Only the owning thread writes a buffer, so counters are updated with plain relaxed load / store pairs, no locked read-modify-write and no sharing of cache lines between threads.
+    // When a thread exits, its buffer is folded into a process-wide total so its counts are not lost.
+    // The registry holding those totals is a heap object that is never destroyed: a static ThreadPool built before the first recorder outlives any function-local static, and its workers' buffers are folded in during exit.
+
+// LatencyHistogram:
+    // Log-linear buckets in the style of HdrHistogram: values below 32 ns have a bucket each, above that every power of two is split into 16 equal sub-buckets.
+
+// instrumentationSnapshot Function:
+    // Takes the registry lock and sums the exited-thread totals with every live thread's buffer; toJson renders the result for scraping.
+    // "enabled" is reported from a flag every translation unit built with SPHINX_KEY_INSTRUMENTATION sets during static initialization,
+    // so it is right even when this file and Key.cpp are compiled with different flags.
+    // The std::cout output of Key.cpp is unchanged; the instrumentation only adds counters.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <mutex>
+#include <array>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+// This file only aggregates; compiled with the flag it must not report itself as an instrumented translation unit
+#undef SPHINX_KEY_INSTRUMENTATION
+#include "Instrumentation.hpp"
+
+
+namespace SPHINXKey {
+
+    namespace {
+        // Per-thread counters of one stage, written by the owning thread only
+        struct StageCounters {
+            std::atomic<uint64_t> calls{0};
+            std::atomic<uint64_t> bytes{0};
+            std::atomic<uint64_t> totalNs{0};
+            std::atomic<uint64_t> maxNs{0};
+            std::array<std::atomic<uint64_t>, LatencyHistogram::BUCKETS> buckets{};
+
+            void addTo(StageStats& stats) const {
+                stats.calls += calls.load(std::memory_order_relaxed);
+                stats.bytes += bytes.load(std::memory_order_relaxed);
+                stats.totalNs += totalNs.load(std::memory_order_relaxed);
+                stats.maxNs = std::max(stats.maxNs, maxNs.load(std::memory_order_relaxed));
+                for (size_t i = 0; i < buckets.size(); ++i) {
+                    stats.latency.counts[i] += buckets[i].load(std::memory_order_relaxed);
+                }
+            }
+        };
+
+        // Single-writer increment: the owning thread is the only writer, readers only need an untorn value
+        inline void bump(std::atomic<uint64_t>& counter, uint64_t amount) {
+            counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        struct ThreadRecorder;
+
+        // Live thread buffers and the totals of threads that have exited
+        struct Registry {
+            std::mutex mutex;
+            std::vector<const ThreadRecorder*> live;
+            std::array<StageStats, INSTRUMENTED_STAGE_COUNT> retired{};
+        };
+
+        Registry& registry() {
+            // Never destroyed: see the summary above
+            static Registry* const instance = new Registry;
+            return *instance;
+        }
+
+        struct ThreadRecorder {
+            std::array<StageCounters, INSTRUMENTED_STAGE_COUNT> stages;
+
+            ThreadRecorder() {
+                Registry& r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                r.live.push_back(this);
+            }
+
+            ~ThreadRecorder() {
+                Registry& r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                for (size_t i = 0; i < stages.size(); ++i) {
+                    stages[i].addTo(r.retired[i]);
+                }
+                r.live.erase(std::find(r.live.begin(), r.live.end(), this));
+            }
+        };
+
+        // Set during static initialization, so it is constant-initialized rather than constructed
+        std::atomic<bool> instrumentedUnitLinked{false};
+
+        ThreadRecorder& threadRecorder() {
+            thread_local ThreadRecorder recorder;
+            return recorder;
+        }
+    } // namespace
+
+    // Function to return whether an instrumented translation unit is linked
+    bool instrumentationEnabled() {
+        return instrumentedUnitLinked.load(std::memory_order_relaxed);
+    }
+
+    // Function to record that an instrumented translation unit is linked
+    void markInstrumentationEnabled() {
+        instrumentedUnitLinked.store(true, std::memory_order_relaxed);
+    }
+
+    // Function to return the name of a stage as used in snapshots
+    const char* instrumentedStageName(InstrumentedStage stage) {
+        switch (stage) {
+            case InstrumentedStage::GenerateHybridKeypair: return "generate_hybrid_keypair";
+            case InstrumentedStage::GenerateAndPerformKeyExchange: return "generate_and_perform_key_exchange";
+            case InstrumentedStage::GenerateAddress: return "generateAddress";
+            case InstrumentedStage::HashAddress: return "hashAddress";
+            case InstrumentedStage::EncodeBase58: return "EncodeBase58";
+            case InstrumentedStage::MergePrivateKeys: return "mergePrivateKeys";
+            case InstrumentedStage::MergePublicKeys: return "mergePublicKeys";
+            default: return "unknown";
+        }
+    }
+
+    // Function to return the bucket of a value
+    size_t LatencyHistogram::bucketOf(uint64_t nanoseconds) {
+        if (nanoseconds < 2 * SUB_BUCKETS) {
+            return static_cast<size_t>(nanoseconds);
+        }
+        const size_t exponent = 63 - static_cast<size_t>(__builtin_clzll(nanoseconds));
+        const size_t shift = exponent - SUB_BUCKET_BITS;
+        if (shift > MAX_SHIFT) {
+            return BUCKETS - 1;
+        }
+        return SUB_BUCKETS * (shift + 1) + static_cast<size_t>(nanoseconds >> shift) - SUB_BUCKETS;
+    }
+
+    // Function to return the smallest value of a bucket
+    uint64_t LatencyHistogram::bucketLowerBound(size_t bucket) {
+        if (bucket < 2 * SUB_BUCKETS) {
+            return bucket;
+        }
+        const size_t shift = bucket / SUB_BUCKETS - 1;
+        return static_cast<uint64_t>(bucket % SUB_BUCKETS + SUB_BUCKETS) << shift;
+    }
+
+    // Function to return the number of recorded values
+    uint64_t LatencyHistogram::total() const {
+        uint64_t sum = 0;
+        for (uint64_t count : counts) {
+            sum += count;
+        }
+        return sum;
+    }
+
+    // Function to return the lower bound of the bucket holding the given percentile
+    uint64_t LatencyHistogram::valueAtPercentile(double percentile) const {
+        const uint64_t count = total();
+        if (count == 0) {
+            return 0;
+        }
+        const double clamped = std::clamp(percentile, 0.0, 100.0);
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(count) + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return bucketLowerBound(i);
+            }
+        }
+        return bucketLowerBound(counts.size() - 1);
+    }
+
+    // Function to record one call of a stage into the calling thread's buffer
+    void recordStage(InstrumentedStage stage, uint64_t nanoseconds, uint64_t bytes) {
+        StageCounters& counters = threadRecorder().stages[static_cast<size_t>(stage)];
+        bump(counters.calls, 1);
+        bump(counters.bytes, bytes);
+        bump(counters.totalNs, nanoseconds);
+        if (nanoseconds > counters.maxNs.load(std::memory_order_relaxed)) {
+            counters.maxNs.store(nanoseconds, std::memory_order_relaxed);
+        }
+        bump(counters.buckets[LatencyHistogram::bucketOf(nanoseconds)], 1);
+    }
+
+    // Function to aggregate the per-thread buffers into a snapshot
+    InstrumentationSnapshot instrumentationSnapshot() {
+        InstrumentationSnapshot snapshot;
+        snapshot.enabled = instrumentationEnabled();
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        snapshot.stages = r.retired;
+        for (const ThreadRecorder* recorder : r.live) {
+            for (size_t i = 0; i < INSTRUMENTED_STAGE_COUNT; ++i) {
+                recorder->stages[i].addTo(snapshot.stages[i]);
+            }
+        }
+        return snapshot;
+    }
+
+    // Function to render the snapshot as JSON
+    std::string InstrumentationSnapshot::toJson() const {
+        std::ostringstream out;
+        out << "{\"enabled\": " << (enabled ? "true" : "false") << ", \"stages\": {";
+        for (size_t i = 0; i < stages.size(); ++i) {
+            const StageStats& s = stages[i];
+            const double mean = s.calls > 0 ? static_cast<double>(s.totalNs) / static_cast<double>(s.calls) : 0.0;
+            out << (i > 0 ? ", " : "") << "\"" << instrumentedStageName(static_cast<InstrumentedStage>(i)) << "\": {"
+                << "\"calls\": " << s.calls << ", \"bytes\": " << s.bytes << ", \"total_ns\": " << s.totalNs
+                << ", \"mean_ns\": " << mean << ", \"p50_ns\": " << s.latency.valueAtPercentile(50.0)
+                << ", \"p90_ns\": " << s.latency.valueAtPercentile(90.0) << ", \"p99_ns\": " << s.latency.valueAtPercentile(99.0)
+                << ", \"p999_ns\": " << s.latency.valueAtPercentile(99.9) << ", \"max_ns\": " << s.maxNs << "}";
+        }
+        out << "}}";
+        return out.str();
+    }
+} // namespace SPHINXKey
@@ -0,0 +1,135 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+#ifndef SPHINX_INSTRUMENTATION_HPP
+#define SPHINX_INSTRUMENTATION_HPP
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace SPHINXKey {
+
+    // Instrumented stages of SPHINXKey
+    enum class InstrumentedStage : size_t {
+        GenerateHybridKeypair,
+        GenerateAndPerformKeyExchange,
+        GenerateAddress,
+        HashAddress,        // SPHINX_256, RIPEMD-160 and checksum hashing inside generateAddress
+        EncodeBase58,       // Base58 encoding inside generateAddress
+        MergePrivateKeys,
+        MergePublicKeys,
+        Count
+    };
+
+    constexpr size_t INSTRUMENTED_STAGE_COUNT = static_cast<size_t>(InstrumentedStage::Count);
+
+    // Function to return the name of a stage as used in snapshots
+    const char* instrumentedStageName(InstrumentedStage stage);
+
+    // Function to return whether any linked translation unit was compiled with SPHINX_KEY_INSTRUMENTATION; without one nothing is recorded and snapshots stay empty
+    // Decided at run time, since Instrumentation.cpp and the instrumented sources may be compiled with different flags
+    bool instrumentationEnabled();
+
+    // Function called during static initialization by every translation unit compiled with SPHINX_KEY_INSTRUMENTATION
+    void markInstrumentationEnabled();
+
+    // Log-linear latency histogram in nanoseconds (HDR style): 16 linear sub-buckets per power of two,
+    // so every recorded value is within 1/16 (6.25%) of its bucket's lower bound, up to 2^40 ns (about 18 minutes)
+    struct LatencyHistogram {
+        static constexpr size_t SUB_BUCKET_BITS = 4;
+        static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+        static constexpr size_t MAX_SHIFT = 40 - SUB_BUCKET_BITS;
+        static constexpr size_t BUCKETS = SUB_BUCKETS * (MAX_SHIFT + 2);
+
+        std::array<uint64_t, BUCKETS> counts{};
+
+        // Function to return the bucket of a value, values past the range land in the last bucket
+        static size_t bucketOf(uint64_t nanoseconds);
+
+        // Function to return the smallest value of a bucket
+        static uint64_t bucketLowerBound(size_t bucket);
+
+        // Function to return the number of recorded values
+        uint64_t total() const;
+
+        // Function to return the lower bound of the bucket holding the given percentile (0-100)
+        uint64_t valueAtPercentile(double percentile) const;
+    };
+
+    // Aggregated counters of one stage
+    struct StageStats {
+        uint64_t calls = 0;
+        uint64_t bytes = 0;      // Key material absorbed by the stage
+        uint64_t totalNs = 0;
+        uint64_t maxNs = 0;
+        LatencyHistogram latency;
+    };
+
+    // Counters of every stage summed over all threads (live and exited) at the time of the snapshot
+    struct InstrumentationSnapshot {
+        bool enabled = false;    // instrumentationEnabled() when the snapshot was taken
+        std::array<StageStats, INSTRUMENTED_STAGE_COUNT> stages;
+
+        const StageStats& operator[](InstrumentedStage stage) const { return stages[static_cast<size_t>(stage)]; }
+
+        // Function to render the snapshot as JSON (calls, bytes, mean / p50 / p90 / p99 / p999 / max latency per stage)
+        std::string toJson() const;
+    };
+
+    // Function to aggregate the per-thread buffers into a snapshot, safe to call while other threads record
+    InstrumentationSnapshot instrumentationSnapshot();
+
+    // Function to record one call of a stage into the calling thread's buffer
+    void recordStage(InstrumentedStage stage, uint64_t nanoseconds, uint64_t bytes);
+
+    // Records the duration of the enclosing scope as one call of a stage
+    class StageTimer {
+    public:
+        StageTimer(InstrumentedStage stage, uint64_t bytes) : stage_(stage), bytes_(bytes), start_(std::chrono::steady_clock::now()) {}
+        ~StageTimer() {
+            const auto elapsed = std::chrono::steady_clock::now() - start_;
+            recordStage(stage_, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()), bytes_);
+        }
+
+        StageTimer(const StageTimer&) = delete;
+        StageTimer& operator=(const StageTimer&) = delete;
+
+    private:
+        InstrumentedStage stage_;
+        uint64_t bytes_;
+        std::chrono::steady_clock::time_point start_;
+    };
+} // namespace SPHINXKey
+
+// Instrument the enclosing scope; expands to nothing (bytes is not evaluated) unless SPHINX_KEY_INSTRUMENTATION is defined
+#if defined(SPHINX_KEY_INSTRUMENTATION)
+#define SPHINX_INSTRUMENT_CONCAT_INNER(a, b) a##b
+#define SPHINX_INSTRUMENT_CONCAT(a, b) SPHINX_INSTRUMENT_CONCAT_INNER(a, b)
+#define SPHINX_INSTRUMENT_SCOPE(stage, bytes) ::SPHINXKey::StageTimer SPHINX_INSTRUMENT_CONCAT(sphinxStageTimer_, __LINE__)((stage), (bytes))
+
+namespace SPHINXKey {
+    namespace {
+        // Each instrumented translation unit reports itself before main
+        [[maybe_unused]] const bool instrumentationMarked = (markInstrumentationEnabled(), true);
+    }
+} // namespace SPHINXKey
+#else
+#define SPHINX_INSTRUMENT_SCOPE(stage, bytes) static_cast<void>(0)
+#endif
+
+#endif // SPHINX_INSTRUMENTATION_HPP
@@ -16,50 +16,77 @@
 
 // Namespaces SPHINXHybridKey and SPHINXHash:
     // The code starts with defining two namespaces: SPHINXHybridKey and SPHINXHash.
-    // SPHINXHybridKey does not contain any actual functions or data; it only has a dummy struct HybridKeypair, which is currently empty.
-    // SPHINXHash contains two functions: SPHINX_256 and RIPEMD_160. These functions are currently implemented as dummy functions for demonstration purposes.
+    // SPHINXHybridKey declares the HybridKeypair struct (merged key pair, Kyber1024 PKE key pair and shared secret) and the key generation, KEM and PKE functions provided by hybrid_key.cpp.
+    // SPHINXHash (Hasher.hpp) contains two functions: SPHINX_256 and RIPEMD_160. They return fixed-size digests and are built on the streaming SPHINX256Hasher and RIPEMD160Hasher, which absorb several buffers without concatenating them and can be copied to reuse a midstate.
 
 // Base58 Encoding:
     // The code defines a static string base58_chars which contains the characters used in Base58 encoding.
     // The function EncodeBase58 takes a vector of unsigned characters as input and encodes it into a Base58 string.
-    // The function calculates the number of leading zeros in the input data, converts the data to a big-endian number, and then performs Base58 encoding.
+    // The input is converted to a multi-precision number held in 32-bit limbs of radix 58^5, so payloads of any length (such as the 25-byte address payload) are encoded without overflow and five Base58 digits are produced per limb.
+    // DecodeBase58 performs the reverse conversion and rejects characters outside base58_chars before any arithmetic.
+    // EncodeBase58Check and DecodeBase58Check append and verify the 4-byte double SPHINX_256 checksum used by generateAddress.
+    // EncodeBase58Batch encodes many equal-length payloads into one preallocated buffer, reusing a single limb scratch buffer for the whole batch.
 
 // SPHINXKey Namespace:
     // This namespace contains several functions related to the generation and manipulation of cryptographic keys.
     // Constants CURVE448_PRIVATE_KEY_SIZE, CURVE448_PUBLIC_KEY_SIZE, and KYBER1024_PUBLIC_KEY_LENGTH define the sizes of keys for Curve448 and Kyber1024 algorithms.
-    // HYBRID_KEYPAIR_LENGTH is the total length of the hybrid key pair, which combines the public keys of both algorithms with extra HMAC sizes.
+    // They are taken from DefaultParameterSet (ParameterSet.hpp), the Kyber1024 / X448 instance of the HybridParameterSet policy; every size of a set is derived at compile time from the Kyber rank and the curve.
+    // All key types are std::array of those sizes (Curve448PrivKey, KyberPubKey, ...), and the merged SPHINXPrivKey / SPHINXPubKey hold the 32-byte SPHINX_256 digest, so the path from key generation to address makes no heap allocation.
+    // HYBRID_KEYPAIR_LENGTH is the total length of the hybrid key pair, which combines the public keys of both algorithms with extra HMAC sizes (HMAC-SHA512).
 
 // calculatePublicKey Function:
-    // This function calculates the SPHINX public key from the private key by extracting the Kyber1024 public key from the merged private key.
+    // This function calculates the Kyber1024 public key by extracting it from the Kyber1024 private key, which embeds the public key after the IND-CPA secret key.
 
 // sphinxKeyToString Function:
     // This function converts the binary representation of SPHINX key (private or public) to a string.
+    // It copies the raw bytes; printable text comes from toHex / hexEncode (Serialization.hpp), which write into caller or stack buffers.
 
 // generateAddress Function:
     // This function generates a smart contract address based on the public key and contract name.
-    // It first converts the public key to a string, then performs SPHINX_256 and RIPEMD-160 hashes on the public key string.
-    // It adds a version byte (0x00) to the RIPEMD-160 hash and calculates the checksum using double SPHINX_256 hash.
-    // Finally, it performs Base58Check encoding to create the contract address.
+    // It performs SPHINX_256 and RIPEMD-160 hashes on the public key.
+    // It adds a version byte (0x00) to the RIPEMD-160 hash and performs Base58Check encoding (checksum using double SPHINX_256 hash) to create the contract address.
+    // The checksum resumes from a SPHINX_256 midstate that already holds the version byte.
+
+// generateAddresses Function:
+    // This function generates the addresses of many public keys at once, splitting the keys into chunks that run on the work-stealing ThreadPool (ThreadPool.hpp).
+    // Addresses are written into a caller-provided AddressArena: a character buffer plus one (offset, length) slot per public key, so no per-address std::string is returned.
+    // AddressOrder::Completion packs chunks in the order they finish; AddressOrder::Deterministic packs them in input order, matching the serial path byte for byte.
+    // Completion needs a buffer of publicKeys.size() * ADDRESS_MAX_LENGTH bytes, checked before any work; Deterministic only needs the exact total, checked before the buffer is written.
+    // Within a chunk, keys are hashed 64 at a time with SPHINX_256_multi and RIPEMD_160_multi, which run one key per SIMD lane (SSE4.1, AVX2 or AVX-512, chosen at runtime from CPUID).
+    // The overload taking a span of SPHINXAddress runs the same multi-buffer path on the calling thread.
+
+// decodeAddress and validateAddresses Functions:
+    // decodeAddress is the inverse of generateAddress: it checks the characters 64 at a time with vector compares (GCC/Clang vector extensions) before any bignum work,
+    // decodes the 25-byte payload into fixed stack limbs, rejects non-canonical encodings and wrong version bytes, and recomputes the checksum from the version byte midstate.
+    // validateAddresses splits a batch across the ThreadPool and recomputes the checksums of 64 decoded payloads at a time with SPHINX_256_multi.
 
 // mergePrivateKeys and mergePublicKeys Functions:
     // These functions are used to merge the private keys and public keys of Curve448 and Kyber1024.
+    // They call the templates of ParameterSet.hpp with DefaultParameterSet; the templates work for any of the six Kyber512/768/1024 x X25519/X448 sets with fixed-size inputs.
 
 // generate_hybrid_keypair Function:
     // This function generates the hybrid key pair by combining the keys generated from Curve448 and Kyber1024 algorithms.
     // It uses the private and public key generation functions from an external source hybrid_key.cpp, which are not defined in the provided code snippet.
-    // The merged private and public keys are obtained by concatenating the corresponding keys from the two algorithms and then hashing the merged private key using SPHINX_256.
+    // Generation and merging go through generateMergedKey<DefaultParameterSet> (Key.hpp), which reaches hybrid_key.cpp through HybridKeyBackend; another parameter set only needs its own HybridKeyBackend specialisation.
+    // The merged private and public keys are obtained by absorbing the corresponding keys from the two algorithms into one SPHINX256Hasher, so the keys are hashed in place without being concatenated.
+    // The Curve448 and Kyber1024 private keys are held in SecureKey slots (SecureArena.hpp): mlock()ed memory taken from a lock-free freelist and zeroized when the slot is released.
     // The result is stored in a struct HybridKeypair from the SPHINXHybridKey namespace.
 
 // generate_and_perform_key_exchange Function:
     // This function generates and performs a key exchange using the hybrid key pair.
-    // It follows similar steps as the generate_hybrid_keypair function to generate the hybrid key pair.
+    // It calls generate_hybrid_keypair to generate the hybrid key pair.
     // It then performs a key exchange using the X448 and Kyber1024 key encapsulation mechanisms (KEM).
     // It also encrypts and decrypts a sample message using Kyber1024 public key encryption (PKE) to demonstrate the use of the keys.
 
+// Instrumentation:
+    // generate_hybrid_keypair, generate_and_perform_key_exchange, generateAddress and the merge functions open with SPHINX_INSTRUMENT_SCOPE (Instrumentation.hpp).
+    // Inside generateAddress, the hashing (SPHINX_256, RIPEMD-160 and the checksum) and the Base58 encoding are recorded again as stages of their own.
+    // Built with SPHINX_KEY_INSTRUMENTATION, each call records its latency and bytes into per-thread histograms read with instrumentationSnapshot(); otherwise the macro compiles to nothing.
+
 // printKeyPair Function:
     // This function takes a name (identifier), private key, and public key as input.
-    // It converts the private and public keys to strings and prints them.
-    // It then generates a contract address based on the public key and a contract name and prints it.
+    // It converts the private and public keys to strings and prints them as hex (toHex from Serialization.hpp, written into a stack buffer with leading zeros kept).
+    // It then generates a contract address (a fixed-capacity SPHINXAddress) based on the public key and a contract name and prints it.
     // Finally, it returns the private key and public key as strings.
 
 // The SPHINXKey namespace provides a set of utility functions to work with the SPHINX cryptographic scheme and interacts with other functions available in the SPHINXHybridKey namespace to generate a hybrid key pair and perform key exchange and encryption operations using the Kyber1024, X448, and PKE schemes.
@@ -73,225 +100,701 @@
 #include <iostream>
 #include <algorithm>
 #include <cstdint>
+#include <span>
+#include <array>
+#include <atomic>
+#include <stdexcept>
 
 #include "Hybrid_key.hpp"
 #include "Hash.hpp"
 #include "Key.hpp"
+#include "Hasher.hpp"
+#include "ThreadPool.hpp"
+#include "SecureArena.hpp"
+#include "Instrumentation.hpp"
+#include "Serialization.hpp"
 #include "base58check.h"
 #include "base58.h"
 #include "hash/Ripmed160.hpp"
 
 
-namespace SPHINXHybridKey {
-    // Assume the definition of SPHINXHybridKey
-    struct HybridKeypair {};
-}
+namespace {
+    // Base58 digits are packed five at a time into 32-bit limbs (58^5 < 2^30), so every
+    // multiply-accumulate step stays inside a uint64_t and divides by a compile-time constant
+    constexpr uint32_t BASE58_LIMB_RADIX = 58u * 58u * 58u * 58u * 58u;
+    constexpr size_t BASE58_LIMB_DIGITS = 5;
 
-namespace SPHINXHash {
-    // Assume the definition of SPHINX_256 function
-    std::string SPHINX_256(const std::vector<unsigned char>& data) {
-        // Dummy implementation for demonstration purposes
-        return "hashed_" + std::string(data.begin(), data.end());
+    // Limbs needed for the Base58 value of a payload (8 / log2(58^5) < 1 / 3)
+    constexpr size_t base58EncodeLimbs(size_t length) {
+        return length / 3 + 2;
     }
 
-    // Assume the definition of RIPEMD-160 function
-    std::string RIPEMD_160(const std::vector<unsigned char>& data) {
-        // Dummy implementation for demonstration purposes
-        return "ripemd160_" + std::string(data.begin(), data.end());
+    // 32-bit limbs needed for the binary value of a Base58 string (log2(58) / 32 < 1 / 5)
+    constexpr size_t base58DecodeLimbs(size_t length) {
+        return length / 5 + 2;
     }
-}
 
-// Base58 characters (excluding confusing characters: 0, O, I, l) for address human readable
-static const std::string base58_chars = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+    // Reverse lookup table for base58_chars, -1 marks characters outside the alphabet
+    constexpr std::array<int8_t, 256> BASE58_MAP = [] {
+        constexpr char alphabet[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+        std::array<int8_t, 256> map{};
+        for (auto& entry : map) {
+            entry = -1;
+        }
+        for (size_t i = 0; i < 58; ++i) {
+            map[static_cast<unsigned char>(alphabet[i])] = static_cast<int8_t>(i);
+        }
+        return map;
+    }();
+
+#if defined(__GNUC__)
+    // 64 characters checked per step with GCC/Clang vector extensions (four SSE2 registers on baseline x86-64, wider where the target allows)
+    typedef unsigned char Base58Block __attribute__((vector_size(64)));
+    typedef signed char Base58Mask __attribute__((vector_size(64)));
+
+    // True if every character of block is in base58_chars: the alphabet is six ranges, each tested with one unsigned subtract-and-compare
+    bool base58BlockValid(const unsigned char* chars) {
+        Base58Block block;
+        std::memcpy(&block, chars, sizeof(block));
+        const Base58Mask valid = ((block - '1') <= 8) | ((block - 'A') <= 7) | ((block - 'J') <= 4) | ((block - 'P') <= 10) | ((block - 'a') <= 10) | ((block - 'm') <= 13);
+        uint64_t lanes[sizeof(valid) / sizeof(uint64_t)];
+        std::memcpy(lanes, &valid, sizeof(valid));
+        uint64_t all = ~uint64_t(0);
+        for (uint64_t lane : lanes) {
+            all &= lane;
+        }
+        return all == ~uint64_t(0);
+    }
+#endif
+
+    // True if every character of str is in base58_chars
+    bool base58ValidCharacters(const char* str, size_t length) {
+#if defined(__GNUC__)
+        size_t i = 0;
+        for (; i + sizeof(Base58Block) <= length; i += sizeof(Base58Block)) {
+            if (!base58BlockValid(reinterpret_cast<const unsigned char*>(str) + i)) {
+                return false;
+            }
+        }
+        if (i < length) {
+            // Pad the tail with a valid character so only the real characters can fail
+            unsigned char tail[sizeof(Base58Block)];
+            std::memset(tail, '1', sizeof(tail));
+            std::memcpy(tail, str + i, length - i);
+            return base58BlockValid(tail);
+        }
+        return true;
+#else
+        for (size_t i = 0; i < length; ++i) {
+            if (BASE58_MAP[static_cast<unsigned char>(str[i])] < 0) {
+                return false;
+            }
+        }
+        return true;
+#endif
+    }
 
-// Function to encode data using Base58
-std::string EncodeBase58(const std::vector<unsigned char>& data) {
-    // Count leading zeros
-    size_t zeros_count = 0;
-    for (const unsigned char byte : data) {
-        if (byte != 0) {
-            break;
+    // Encode data into out using limbs as scratch, returns the number of characters written
+    size_t base58EncodeInto(const unsigned char* data, size_t length, uint32_t* limbs, char* out) {
+        // Count leading zeros, each one becomes a leading '1'
+        size_t zeros_count = 0;
+        while (zeros_count < length && data[zeros_count] == 0) {
+            ++zeros_count;
         }
-        ++zeros_count;
+
+        // Multiply-accumulate one group of up to 4 input bytes into the little-endian limbs
+        size_t used = 0;
+        auto absorb = [&](uint64_t value, unsigned bytes) {
+            uint64_t carry = value;
+            for (size_t j = 0; j < used; ++j) {
+                const uint64_t t = (static_cast<uint64_t>(limbs[j]) << (8 * bytes)) + carry;
+                limbs[j] = static_cast<uint32_t>(t % BASE58_LIMB_RADIX);
+                carry = t / BASE58_LIMB_RADIX;
+            }
+            while (carry > 0) {
+                limbs[used++] = static_cast<uint32_t>(carry % BASE58_LIMB_RADIX);
+                carry /= BASE58_LIMB_RADIX;
+            }
+        };
+
+        // Absorb the unaligned head first so the rest of the input is read in whole 4-byte groups
+        size_t i = zeros_count;
+        const unsigned head = static_cast<unsigned>((length - zeros_count) % 4);
+        if (head > 0) {
+            uint64_t value = 0;
+            for (unsigned k = 0; k < head; ++k) {
+                value = (value << 8) | data[i++];
+            }
+            absorb(value, head);
+        }
+        for (; i < length; i += 4) {
+            const uint64_t value = (static_cast<uint64_t>(data[i]) << 24) | (static_cast<uint64_t>(data[i + 1]) << 16) |
+                                   (static_cast<uint64_t>(data[i + 2]) << 8) | static_cast<uint64_t>(data[i + 3]);
+            absorb(value, 4);
+        }
+
+        // Emit the leading '1's, the top limb without padding, then every lower limb as five digits
+        char* p = out;
+        for (size_t k = 0; k < zeros_count; ++k) {
+            *p++ = base58_chars[0];
+        }
+        if (used > 0) {
+            char digits[BASE58_LIMB_DIGITS];
+            size_t n = 0;
+            for (uint32_t top = limbs[used - 1]; top > 0; top /= 58) {
+                digits[n++] = base58_chars[top % 58];
+            }
+            while (n > 0) {
+                *p++ = digits[--n];
+            }
+            for (size_t j = used - 1; j-- > 0;) {
+                uint32_t limb = limbs[j];
+                for (size_t k = BASE58_LIMB_DIGITS; k-- > 0;) {
+                    p[k] = base58_chars[limb % 58];
+                    limb /= 58;
+                }
+                p += BASE58_LIMB_DIGITS;
+            }
+        }
+        return static_cast<size_t>(p - out);
     }
 
-    // Convert the data to a big-endian number
-    uint64_t num = 0;
-    for (size_t i = zeros_count; i < data.size(); ++i) {
-        num = num * 256 + data[i];
+    // Base58Check checksum: the first 4 bytes of the double SPHINX_256 hash of the message absorbed by hasher
+    std::array<unsigned char, 4> base58Checksum(SPHINXHash::SPHINX256Hasher& hasher) {
+        const SPHINXHash::SPHINX256Digest hash = SPHINXHash::SPHINX_256(hasher.finalize());
+        std::array<unsigned char, 4> checksum;
+        std::copy_n(hash.begin(), checksum.size(), checksum.begin());
+        return checksum;
     }
 
-    // Calculate the necessary length for the encoded string
-    size_t encoded_length = (data.size() - zeros_count) * 138 / 100 + 1;
-    std::string encoded(encoded_length, '1');
+    std::array<unsigned char, 4> base58Checksum(const unsigned char* data, size_t length) {
+        SPHINXHash::SPHINX256Hasher hasher;
+        hasher.update(data, length);
+        return base58Checksum(hasher);
+    }
+} // namespace
 
-    // Encode the big-endian number in Base58
-    for (size_t i = 0; num > 0; ++i) {
-        const uint64_t remainder = num % 58;
-        num /= 58;
-        encoded[encoded_length - i - 1] = base58_chars[remainder];
+// Function to encode data using Base58 into a caller buffer
+size_t EncodeBase58(const unsigned char* data, size_t length, char* out, size_t outCapacity) {
+    if (outCapacity < Base58MaxEncodedLength(length)) {
+        throw std::length_error("EncodeBase58: output buffer too small");
     }
 
+    // Typical payloads (addresses, keys) fit the stack scratch; only very large inputs allocate
+    constexpr size_t STACK_LIMBS = 256;
+    const size_t limbCount = base58EncodeLimbs(length);
+    if (limbCount <= STACK_LIMBS) {
+        uint32_t limbs[STACK_LIMBS];
+        return base58EncodeInto(data, length, limbs, out);
+    }
+    std::vector<uint32_t> limbs(limbCount);
+    return base58EncodeInto(data, length, limbs.data(), out);
+}
+
+// Function to encode data using Base58
+std::string EncodeBase58(const unsigned char* data, size_t length) {
+    std::string encoded(Base58MaxEncodedLength(length), '\0');
+    encoded.resize(EncodeBase58(data, length, encoded.data(), encoded.size()));
     return encoded;
 }
 
-namespace SPHINXKey {
+std::string EncodeBase58(const std::vector<unsigned char>& data) {
+    return EncodeBase58(data.data(), data.size());
+}
+
+// Function to decode a Base58 string
+bool DecodeBase58(const char* str, size_t length, std::vector<unsigned char>& data) {
+    data.clear();
+
+    // Reject characters outside the alphabet before doing any bignum work
+    if (!base58ValidCharacters(str, length)) {
+        return false;
+    }
+
+    // Each leading '1' is a leading zero byte
+    size_t zeros_count = 0;
+    while (zeros_count < length && str[zeros_count] == base58_chars[0]) {
+        ++zeros_count;
+    }
+
+    // Multiply-accumulate up to five digits at a time into little-endian 32-bit limbs
+    std::vector<uint32_t> limbs(base58DecodeLimbs(length - zeros_count));
+    size_t used = 0;
+    auto absorb = [&](uint64_t value, uint64_t multiplier) {
+        uint64_t carry = value;
+        for (size_t j = 0; j < used; ++j) {
+            const uint64_t t = static_cast<uint64_t>(limbs[j]) * multiplier + carry;
+            limbs[j] = static_cast<uint32_t>(t);
+            carry = t >> 32;
+        }
+        while (carry > 0) {
+            limbs[used++] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+    };
+
+    size_t i = zeros_count;
+    const size_t head = (length - zeros_count) % BASE58_LIMB_DIGITS;
+    if (head > 0) {
+        uint64_t value = 0;
+        uint64_t multiplier = 1;
+        for (size_t k = 0; k < head; ++k) {
+            value = value * 58 + static_cast<uint64_t>(BASE58_MAP[static_cast<unsigned char>(str[i++])]);
+            multiplier *= 58;
+        }
+        absorb(value, multiplier);
+    }
+    for (; i < length; i += BASE58_LIMB_DIGITS) {
+        uint64_t value = 0;
+        for (size_t k = 0; k < BASE58_LIMB_DIGITS; ++k) {
+            value = value * 58 + static_cast<uint64_t>(BASE58_MAP[static_cast<unsigned char>(str[i + k])]);
+        }
+        absorb(value, BASE58_LIMB_RADIX);
+    }
 
-    // Constants
-    constexpr size_t CURVE448_PRIVATE_KEY_SIZE = 56;
-    constexpr size_t CURVE448_PUBLIC_KEY_SIZE = 56;
-    constexpr size_t KYBER1024_PUBLIC_KEY_LENGTH = 800;
-    
-    // Size of HYBRIDKEY
-    constexpr size_t HYBRID_KEYPAIR_LENGTH = SPHINXHybridKey::CURVE448_PUBLIC_KEY_SIZE + SPHINXHybridKey::KYBER1024_PUBLIC_KEY_LENGTH + 2 * SPHINXHybridKey::HMAC_MAX_MD_SIZE;
-    // HYBRID_KEYPAIR_LENGTH = 56 (Curve448 public key size) + 800 (Kyber1024 public key length) + 2 * 64 (HMAC_MAX_MD_SIZE) = 976;
+    // Write the leading zeros followed by the big-endian value without its own leading zero bytes
+    data.reserve(zeros_count + used * 4);
+    data.assign(zeros_count, 0);
+    bool leading = true;
+    for (size_t j = used; j-- > 0;) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            const unsigned char byte = static_cast<unsigned char>(limbs[j] >> shift);
+            if (leading && byte == 0) {
+                continue;
+            }
+            leading = false;
+            data.push_back(byte);
+        }
+    }
+    return true;
+}
 
-    // Define an alias for the merged public key as SPHINXPubKey
-    using SPHINXPubKey = std::vector<unsigned char>;
+bool DecodeBase58(const std::string& str, std::vector<unsigned char>& data) {
+    return DecodeBase58(str.data(), str.size(), data);
+}
 
-    // Define an alias for the merged private key as SPHINXPrivKey
-    using SPHINXPrivKey = std::vector<unsigned char>;
+// Function to encode data using Base58Check
+std::string EncodeBase58Check(const std::vector<unsigned char>& payload) {
+    std::vector<unsigned char> data(payload);
+    const auto checksum = base58Checksum(payload.data(), payload.size());
+    data.insert(data.end(), checksum.begin(), checksum.end());
+    return EncodeBase58(data);
+}
 
-    // Function to calculate the SPHINX public key from the private key
-    SPHINXKey::SPHINXPubKey calculatePublicKey(const SPHINXKey::SPHINXPrivKey& privateKey) {
-        // The length of the Kyber1024 public key
-        constexpr size_t KYBER_PUBLIC_KEY_LENGTH = SPHINXKey::KYBER1024_PUBLIC_KEY_LENGTH;
+// Function to decode a Base58Check string and verify its checksum
+bool DecodeBase58Check(const std::string& str, std::vector<unsigned char>& payload) {
+    if (!DecodeBase58(str, payload) || payload.size() < 4) {
+        payload.clear();
+        return false;
+    }
+    const size_t payloadLength = payload.size() - 4;
+    const auto checksum = base58Checksum(payload.data(), payloadLength);
+    if (std::memcmp(checksum.data(), payload.data() + payloadLength, checksum.size()) != 0) {
+        payload.clear();
+        return false;
+    }
+    payload.resize(payloadLength);
+    return true;
+}
 
-        // Calculate the SPHINX public key by extracting the Kyber1024 public key from the merged private key
-        SPHINXKey::SPHINXPubKey sphinxPubKey(privateKey.begin() + CURVE448_PRIVATE_KEY_SIZE, privateKey.end());
+// Function to encode many equal-length payloads into one preallocated buffer
+void EncodeBase58Batch(const unsigned char* payloads, size_t payloadLength, size_t count, char* out, size_t stride, size_t* lengths) {
+    if (stride < Base58MaxEncodedLength(payloadLength)) {
+        throw std::length_error("EncodeBase58Batch: stride too small");
+    }
 
-        return sphinxPubKey;
+    // One scratch buffer serves the whole batch since every payload needs the same limb count
+    std::vector<uint32_t> limbs(base58EncodeLimbs(payloadLength));
+    for (size_t i = 0; i < count; ++i) {
+        lengths[i] = base58EncodeInto(payloads + i * payloadLength, payloadLength, limbs.data(), out + i * stride);
+    }
+}
+
+namespace SPHINXKey {
+
+    // Function to calculate the Kyber1024 public key embedded in the Kyber1024 private key
+    SPHINXKey::KyberPubKey calculatePublicKey(const SPHINXKey::KyberPrivKey& privateKey) {
+        return calculatePublicKey<DefaultParameterSet>(privateKey);
     }
 
     // Function to convert SPHINXKey to string
-    std::string sphinxKeyToString(const SPHINXKey::SPHINXKey& key) {
+    std::string sphinxKeyToString(std::span<const unsigned char> key) {
         return std::string(key.begin(), key.end());
     }
 
-    // Function to generate the smart contract address based on the public key and contract name
-    std::string generateAddress(const SPHINXKey::SPHINXPubKey& publicKey, const std::string& contractName) {
-        // Step 1: Convert the public key to a string
-        std::string pubKeyString = sphinxKeyToString(publicKey);
+    namespace {
+        // Keys per parallelFor chunk in generateAddresses, large enough to amortize the arena reservation
+        constexpr size_t ADDRESS_BATCH_GRAIN = 256;
+
+        // SPHINX_256 midstate with the version byte absorbed, copied by every address checksum
+        const SPHINXHash::SPHINX256Hasher& versionHasher() {
+            static const SPHINXHash::SPHINX256Hasher hasher = [] {
+                SPHINXHash::SPHINX256Hasher h;
+                h.update(&ADDRESS_VERSION_BYTE, 1);
+                return h;
+            }();
+            return hasher;
+        }
+
+        // Write the address of publicKey into address using only stack buffers
+        void writeAddress(const SPHINXKey::SPHINXPubKey& publicKey, SPHINXKey::SPHINXAddress& address) {
+            std::array<unsigned char, ADDRESS_PAYLOAD_SIZE> payload;
+            {
+                SPHINX_INSTRUMENT_SCOPE(InstrumentedStage::HashAddress, publicKey.size());
+
+                // Step 1: Perform the SPHINX_256 hash on the public key
+                const SPHINXHash::SPHINX256Digest sphinxHash = SPHINXHash::SPHINX_256(publicKey);
 
-        // Step 2: Perform the SPHINX_256 hash on the public key (assuming it returns a std::string)
-        std::string sphinxHash = SPHINXHash::SPHINX_256(pubKeyString);
+                // Step 2: Perform the RIPEMD-160 hash on the SPHINX_256 hash
+                const SPHINXHash::RIPEMD160Digest ripemd160Hash = SPHINXHash::RIPEMD_160(sphinxHash);
 
-        // Step 3: Perform the RIPEMD-160 hash on the SPHINX_256 hash (assuming it returns a std::string)
-        std::string ripemd160Hash = SPHINXHash::RIPEMD_160(sphinxHash);
+                // Step 3: Add the version byte to the RIPEMD-160 hash
+                payload[0] = ADDRESS_VERSION_BYTE;
+                std::copy(ripemd160Hash.begin(), ripemd160Hash.end(), payload.begin() + 1);
 
-        // Step 4: Add a version byte to the RIPEMD-160 hash (optional)
-        // For Bitcoin addresses, the version byte is 0x00 (mainnet). We can change it if needed.
-        unsigned char versionByte = 0x00;
-        std::string dataWithVersion(1, versionByte);
-        dataWithVersion += ripemd160Hash;
+                // Step 4: Append the checksum (first 4 bytes of double SPHINX_256 hash), resuming from the version byte midstate
+                SPHINXHash::SPHINX256Hasher hasher = versionHasher();
+                hasher.update(ripemd160Hash);
+                const auto checksum = base58Checksum(hasher);
+                std::copy(checksum.begin(), checksum.end(), payload.begin() + 1 + ripemd160Hash.size());
+            }
 
-        // Step 5: Calculate the checksum (first 4 bytes of double SPHINX_256 hash)
-        std::string checksum = SPHINXHash::SPHINX_256(SPHINXHash::SPHINX_256(dataWithVersion)).substr(0, 4);
+            // Step 5: Perform Base58Check encoding
+            SPHINX_INSTRUMENT_SCOPE(InstrumentedStage::EncodeBase58, payload.size());
+            address.length = EncodeBase58(payload.data(), payload.size(), address.chars.data(), address.chars.size());
+        }
 
-        // Step 6: Concatenate the data with the checksum
-        std::string dataWithChecksum = dataWithVersion + checksum;
+        // Keys hashed together by writeAddresses, a multiple of every multi-buffer lane count
+        constexpr size_t ADDRESS_HASH_GROUP = 64;
+
+        // Write the addresses of count public keys, running each hash stage over a whole group in SIMD lanes
+        void writeAddresses(const SPHINXKey::SPHINXPubKey* publicKeys, size_t count, SPHINXKey::SPHINXAddress* addresses) {
+            const unsigned char* messages[ADDRESS_HASH_GROUP];
+            std::array<unsigned char, ADDRESS_HASH_GROUP * SPHINX_256_DIGEST_SIZE> sphinxHashes;
+            std::array<unsigned char, ADDRESS_HASH_GROUP * RIPEMD_160_DIGEST_SIZE> ripemd160Hashes;
+            std::array<unsigned char, ADDRESS_HASH_GROUP * ADDRESS_PAYLOAD_SIZE> payloads;
+
+            for (size_t begin = 0; begin < count; begin += ADDRESS_HASH_GROUP) {
+                const size_t n = std::min(ADDRESS_HASH_GROUP, count - begin);
+
+                // Step 1: Perform the SPHINX_256 hash on the public keys
+                for (size_t i = 0; i < n; ++i) {
+                    messages[i] = publicKeys[begin + i].data();
+                }
+                SPHINXHash::SPHINX_256_multi(messages, SPHINX_256_DIGEST_SIZE, n, sphinxHashes.data());
+
+                // Step 2: Perform the RIPEMD-160 hash on the SPHINX_256 hashes
+                SPHINXHash::RIPEMD_160_multi(std::span<const unsigned char>(sphinxHashes.data(), n * SPHINX_256_DIGEST_SIZE), SPHINX_256_DIGEST_SIZE, ripemd160Hashes.data());
+
+                // Step 3: Add the version byte to the RIPEMD-160 hashes
+                for (size_t i = 0; i < n; ++i) {
+                    unsigned char* payload = payloads.data() + i * ADDRESS_PAYLOAD_SIZE;
+                    payload[0] = ADDRESS_VERSION_BYTE;
+                    std::memcpy(payload + 1, ripemd160Hashes.data() + i * RIPEMD_160_DIGEST_SIZE, RIPEMD_160_DIGEST_SIZE);
+                    messages[i] = payload;
+                }
+
+                // Step 4: Append the checksums (first 4 bytes of double SPHINX_256 hash), both passes fit in one block per key
+                SPHINXHash::SPHINX_256_multi(messages, 1 + RIPEMD_160_DIGEST_SIZE, n, sphinxHashes.data());
+                SPHINXHash::SPHINX_256_multi(std::span<const unsigned char>(sphinxHashes.data(), n * SPHINX_256_DIGEST_SIZE), SPHINX_256_DIGEST_SIZE, sphinxHashes.data());
+                for (size_t i = 0; i < n; ++i) {
+                    std::memcpy(payloads.data() + i * ADDRESS_PAYLOAD_SIZE + 1 + RIPEMD_160_DIGEST_SIZE, sphinxHashes.data() + i * SPHINX_256_DIGEST_SIZE, 4);
+                }
+
+                // Step 5: Perform Base58Check encoding
+                for (size_t i = 0; i < n; ++i) {
+                    SPHINXKey::SPHINXAddress& address = addresses[begin + i];
+                    address.length = EncodeBase58(payloads.data() + i * ADDRESS_PAYLOAD_SIZE, ADDRESS_PAYLOAD_SIZE, address.chars.data(), address.chars.size());
+                }
+            }
+        }
+    } // namespace
 
-        // Step 7: Perform Base58Check encoding
-        std::string address = EncodeBase58(reinterpret_cast<const unsigned char*>(dataWithChecksum.data()),
-                                           dataWithChecksum.size());
+    // Function to generate the smart contract address based on the public key and contract name
+    SPHINXKey::SPHINXAddress generateAddress(const SPHINXKey::SPHINXPubKey& publicKey, std::string_view contractName) {
+        SPHINX_INSTRUMENT_SCOPE(InstrumentedStage::GenerateAddress, publicKey.size());
 
+        SPHINXKey::SPHINXAddress address;
+        writeAddress(publicKey, address);
         return address;
     }
 
-    // Function to merge the private keys of Curve448 and Kyber1024
-    SPHINXKey::SPHINXPrivKey mergePrivateKeys(const SPHINXKey::SPHINXPrivKey& curve448PrivateKey, const SPHINXKey::SPHINXPrivKey& kyberPrivateKey) {
-        SPHINXKey::SPHINXPrivKey mergedPrivateKey;
-        mergedPrivateKey.reserve(curve448PrivateKey.size() + kyberPrivateKey.size());
-        mergedPrivateKey.insert(mergedPrivateKey.end(), curve448PrivateKey.begin(), curve448PrivateKey.end());
-        mergedPrivateKey.insert(mergedPrivateKey.end(), kyberPrivateKey.begin(), kyberPrivateKey.end());
-        return SPHINXHash::SPHINX_256(mergedPrivateKey); // Hash the merged private key
+    // Function to generate the addresses of many public keys on the calling thread with the multi-buffer hashers
+    void generateAddresses(std::span<const SPHINXKey::SPHINXPubKey> publicKeys, [[maybe_unused]] std::string_view contractName, std::span<SPHINXKey::SPHINXAddress> addresses) {
+        if (addresses.size() < publicKeys.size()) {
+            throw std::length_error("generateAddresses: fewer addresses than public keys");
+        }
+        writeAddresses(publicKeys.data(), publicKeys.size(), addresses.data());
     }
 
-    // Function to merge the public keys of Curve448 and Kyber1024
-    SPHINXKey::SPHINXPubKey mergePublicKeys(const SPHINXKey::SPHINXPubKey& curve448PublicKey, const SPHINXKey::SPHINXPubKey& kyberPublicKey) {
-        SPHINXKey::SPHINXPubKey mergedPublicKey;
-        mergedPublicKey.reserve(curve448PublicKey.size() + kyberPublicKey.size());
-        mergedPublicKey.insert(mergedPublicKey.end(), curve448PublicKey.begin(), curve448PublicKey.end());
-        mergedPublicKey.insert(mergedPublicKey.end(), kyberPublicKey.begin(), kyberPublicKey.end());
-        return SPHINXHash::SPHINX_256(mergedPublicKey); // Hash the merged public key
+    // Function to generate the addresses of many public keys in parallel
+    size_t generateAddresses(std::span<const SPHINXKey::SPHINXPubKey> publicKeys, std::string_view contractName, AddressArena& arena, AddressOrder order) {
+        return generateAddresses(publicKeys, contractName, arena, order, ThreadPool::shared());
     }
 
-    // Function to generate the hybrid key pair from "hybrid_key.cpp"
-    SPHINXHybridKey::HybridKeypair generate_hybrid_keypair() {
-        // Function to merge the private keys of Curve448 and Kyber1024
-        auto mergePrivateKeys = [](const SPHINXKey::SPHINXPrivKey& curve448PrivateKey, const SPHINXKey::SPHINXPrivKey& kyberPrivateKey) {
-            SPHINXKey::SPHINXPrivKey mergedPrivateKey;
-            mergedPrivateKey.insert(mergedPrivateKey.end(), curve448PrivateKey.begin(), curve448PrivateKey.end());
-            mergedPrivateKey.insert(mergedPrivateKey.end(), kyberPrivateKey.begin(), kyberPrivateKey.end());
-            return SPHINXHash::SPHINX_256(mergedPrivateKey); // Hash the merged private key
-        };
+    size_t generateAddresses(std::span<const SPHINXKey::SPHINXPubKey> publicKeys, [[maybe_unused]] std::string_view contractName, AddressArena& arena, AddressOrder order, ThreadPool& pool) {
+        if (arena.slots.size() < publicKeys.size()) {
+            throw std::length_error("generateAddresses: arena has fewer slots than public keys");
+        }
 
-        // Function to merge the public keys of Curve448 and Kyber1024
-        auto mergePublicKeys = [](const SPHINXKey::SPHINXPubKey& curve448PublicKey, const SPHINXKey::SPHINXPubKey& kyberPublicKey) {
-            SPHINXKey::SPHINXPubKey mergedPublicKey;
-            mergedPublicKey.insert(mergedPublicKey.end(), curve448PublicKey.begin(), curve448PublicKey.end());
-            mergedPublicKey.insert(mergedPublicKey.end(), kyberPublicKey.begin(), kyberPublicKey.end());
-            return SPHINXHash::SPHINX_256(mergedPublicKey); // Hash the merged public key
+        // Completion reserves space as chunks finish, so a short buffer would only be noticed after other chunks were placed; require the worst case up front
+        if (order == AddressOrder::Completion && arena.buffer.size() / ADDRESS_MAX_LENGTH < publicKeys.size()) {
+            throw std::length_error("generateAddresses: arena buffer smaller than publicKeys.size() * ADDRESS_MAX_LENGTH");
+        }
+
+        // Each chunk encodes into its own staging string with chunk-relative offsets,
+        // so workers only touch the shared arena once per chunk
+        const size_t chunks = (publicKeys.size() + ADDRESS_BATCH_GRAIN - 1) / ADDRESS_BATCH_GRAIN;
+        auto encodeChunk = [&](size_t begin, size_t end, std::string& staging) {
+            staging.reserve((end - begin) * ADDRESS_MAX_LENGTH);
+            std::array<SPHINXKey::SPHINXAddress, ADDRESS_HASH_GROUP> addresses;
+            for (size_t group = begin; group < end; group += ADDRESS_HASH_GROUP) {
+                const size_t n = std::min(ADDRESS_HASH_GROUP, end - group);
+                writeAddresses(publicKeys.data() + group, n, addresses.data());
+                for (size_t i = 0; i < n; ++i) {
+                    arena.slots[group + i] = AddressSlot{staging.size(), addresses[i].length};
+                    staging.append(addresses[i].chars.data(), addresses[i].length);
+                }
+            }
+        };
+        auto placeChunk = [&](size_t begin, size_t end, size_t base, const std::string& staging) {
+            if (base + staging.size() > arena.buffer.size()) {
+                throw std::length_error("generateAddresses: arena buffer too small");
+            }
+            std::memcpy(arena.buffer.data() + base, staging.data(), staging.size());
+            for (size_t i = begin; i < end; ++i) {
+                arena.slots[i].offset += base;
+            }
         };
 
-        // Generate Curve448 key pair from hybrid_key.cpp
-        SPHINXKey::SPHINXPrivKey curve448PrivateKey = generateCurve448PrivateKey();
-        SPHINXKey::SPHINXPubKey curve448PublicKey = generateCurve448PublicKey();
+        if (order == AddressOrder::Completion) {
+            // Reserve each finished chunk with one atomic bump of the arena cursor
+            std::atomic<size_t> cursor{0};
+            pool.parallelFor(publicKeys.size(), ADDRESS_BATCH_GRAIN, [&](size_t begin, size_t end) {
+                std::string staging;
+                encodeChunk(begin, end, staging);
+                placeChunk(begin, end, cursor.fetch_add(staging.size(), std::memory_order_relaxed), staging);
+            });
+            return cursor.load();
+        }
 
-        // Generate Kyber1024 key pair from hybrid_key.cpp
-        SPHINXKey::SPHINXPrivKey kyberPrivateKey = generateKyberPrivateKey();
-        SPHINXKey::SPHINXPubKey kyberPublicKey = generateKyberPublicKey();
+        // Deterministic: keep every chunk staged, lay them out in input order, then copy in parallel
+        std::vector<std::string> staged(chunks);
+        pool.parallelFor(publicKeys.size(), ADDRESS_BATCH_GRAIN, [&](size_t begin, size_t end) {
+            encodeChunk(begin, end, staged[begin / ADDRESS_BATCH_GRAIN]);
+        });
+        std::vector<size_t> bases(chunks);
+        size_t used = 0;
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            bases[chunk] = used;
+            used += staged[chunk].size();
+        }
+        if (used > arena.buffer.size()) {
+            throw std::length_error("generateAddresses: arena buffer too small");
+        }
+        pool.parallelFor(publicKeys.size(), ADDRESS_BATCH_GRAIN, [&](size_t begin, size_t end) {
+            const size_t chunk = begin / ADDRESS_BATCH_GRAIN;
+            placeChunk(begin, end, bases[chunk], staged[chunk]);
+        });
+        return used;
+    }
 
-        // Merge the private keys
-        SPHINXKey::SPHINXPrivKey sphinxPrivKey = mergePrivateKeys(curve448PrivateKey, kyberPrivateKey);
+    namespace {
+        // 32-bit limbs of a 25-byte payload
+        constexpr size_t ADDRESS_PAYLOAD_LIMBS = (ADDRESS_PAYLOAD_SIZE + 3) / 4;
+
+        // Decode an address into its 25-byte payload and check its version byte; the checksum is left to the caller
+        AddressStatus decodeAddressPayload(std::string_view address, unsigned char* payload) {
+            // Step 1: Reject bad lengths and characters before any arithmetic
+            if (address.empty() || address.size() > ADDRESS_MAX_LENGTH) {
+                return AddressStatus::BadLength;
+            }
+            if (!base58ValidCharacters(address.data(), address.size())) {
+                return AddressStatus::BadCharacter;
+            }
+
+            // Step 2: Each leading '1' is a leading zero byte
+            size_t zeros_count = 0;
+            while (zeros_count < address.size() && address[zeros_count] == base58_chars[0]) {
+                ++zeros_count;
+            }
+            if (zeros_count > ADDRESS_PAYLOAD_SIZE) {
+                return AddressStatus::BadLength;
+            }
+
+            // Step 3: Multiply-accumulate up to five digits at a time into fixed little-endian limbs
+            uint32_t limbs[ADDRESS_PAYLOAD_LIMBS + 1] = {};
+            size_t used = 0;
+            bool overflow = false;
+            auto absorb = [&](uint64_t value, uint64_t multiplier) {
+                uint64_t carry = value;
+                for (size_t j = 0; j < used; ++j) {
+                    const uint64_t t = static_cast<uint64_t>(limbs[j]) * multiplier + carry;
+                    limbs[j] = static_cast<uint32_t>(t);
+                    carry = t >> 32;
+                }
+                while (carry > 0 && !overflow) {
+                    if (used == ADDRESS_PAYLOAD_LIMBS + 1) {
+                        overflow = true;
+                        break;
+                    }
+                    limbs[used++] = static_cast<uint32_t>(carry);
+                    carry >>= 32;
+                }
+            };
+            size_t i = zeros_count;
+            const size_t head = (address.size() - zeros_count) % BASE58_LIMB_DIGITS;
+            if (head > 0) {
+                uint64_t value = 0;
+                uint64_t multiplier = 1;
+                for (size_t k = 0; k < head; ++k) {
+                    value = value * 58 + static_cast<uint64_t>(BASE58_MAP[static_cast<unsigned char>(address[i++])]);
+                    multiplier *= 58;
+                }
+                absorb(value, multiplier);
+            }
+            for (; i < address.size() && !overflow; i += BASE58_LIMB_DIGITS) {
+                uint64_t value = 0;
+                for (size_t k = 0; k < BASE58_LIMB_DIGITS; ++k) {
+                    value = value * 58 + static_cast<uint64_t>(BASE58_MAP[static_cast<unsigned char>(address[i + k])]);
+                }
+                absorb(value, BASE58_LIMB_RADIX);
+            }
+            if (overflow) {
+                return AddressStatus::BadLength;
+            }
+
+            // Step 4: The leading zeros and the value must make exactly 25 bytes, as in the canonical encoding
+            size_t valueBytes = 0;
+            if (used > 0) {
+                valueBytes = (used - 1) * 4;
+                for (uint32_t top = limbs[used - 1]; top > 0; top >>= 8) {
+                    ++valueBytes;
+                }
+            }
+            if (zeros_count + valueBytes != ADDRESS_PAYLOAD_SIZE) {
+                return AddressStatus::BadLength;
+            }
+            for (size_t k = 0; k < ADDRESS_PAYLOAD_SIZE; ++k) {
+                payload[ADDRESS_PAYLOAD_SIZE - 1 - k] = static_cast<unsigned char>(limbs[k / 4] >> (8 * (k % 4)));
+            }
+
+            // Step 5: Check the version byte
+            if (payload[0] != ADDRESS_VERSION_BYTE) {
+                return AddressStatus::BadVersion;
+            }
+            return AddressStatus::Valid;
+        }
+    } // namespace
+
+    // Function to decode an address into the RIPEMD-160 hash it was generated from
+    AddressStatus decodeAddress(std::string_view address, SPHINXHash::RIPEMD160Digest& hash) {
+        std::array<unsigned char, ADDRESS_PAYLOAD_SIZE> payload;
+        const AddressStatus status = decodeAddressPayload(address, payload.data());
+        if (status != AddressStatus::Valid) {
+            return status;
+        }
 
-        // Merge the public keys
-        SPHINXKey::SPHINXPubKey sphinxPubKey = mergePublicKeys(curve448PublicKey, kyberPublicKey);
+        // Recompute the checksum from the version byte midstate, as generateAddress does
+        SPHINXHash::SPHINX256Hasher hasher = versionHasher();
+        hasher.update(payload.data() + 1, RIPEMD_160_DIGEST_SIZE);
+        const auto checksum = base58Checksum(hasher);
+        if (std::memcmp(checksum.data(), payload.data() + 1 + RIPEMD_160_DIGEST_SIZE, checksum.size()) != 0) {
+            return AddressStatus::BadChecksum;
+        }
+        std::copy_n(payload.begin() + 1, hash.size(), hash.begin());
+        return AddressStatus::Valid;
+    }
 
-        // Create the hybrid key pair structure
-        SPHINXHybridKey::HybridKeypair hybridKeyPair;
-        hybridKeyPair.merged_key.sphinxPrivKey = sphinxPrivKey;
-        hybridKeyPair.merged_key.sphinxPubKey = sphinxPubKey;
+    // Function to check an address
+    bool isValidAddress(std::string_view address) {
+        SPHINXHash::RIPEMD160Digest hash;
+        return decodeAddress(address, hash) == AddressStatus::Valid;
+    }
 
-        return hybridKeyPair;
+    // Function to validate many addresses on the shared pool
+    void validateAddresses(std::span<const std::string_view> addresses, std::span<AddressStatus> statuses, std::span<SPHINXHash::RIPEMD160Digest> hashes) {
+        validateAddresses(addresses, statuses, hashes, ThreadPool::shared());
     }
 
-    // Function to generate and perform key exchange hybrid method from "hybrid_key.cpp"
-    SPHINXHybridKey::HybridKeypair generate_and_perform_key_exchange() {
-        // Function to merge the private keys of Curve448 and Kyber1024
-        auto mergePrivateKeys = [](const SPHINXKey::SPHINXPrivKey& curve448PrivateKey, const SPHINXKey::SPHINXPrivKey& kyberPrivateKey) {
-            SPHINXKey::SPHINXPrivKey mergedPrivateKey;
-            mergedPrivateKey.insert(mergedPrivateKey.end(), curve448PrivateKey.begin(), curve448PrivateKey.end());
-            mergedPrivateKey.insert(mergedPrivateKey.end(), kyberPrivateKey.begin(), kyberPrivateKey.end());
-            return SPHINXHash::SPHINX_256(mergedPrivateKey); // Hash the merged private key
-        };
+    // Function to validate many addresses on the given pool
+    void validateAddresses(std::span<const std::string_view> addresses, std::span<AddressStatus> statuses, std::span<SPHINXHash::RIPEMD160Digest> hashes, ThreadPool& pool) {
+        if (statuses.size() < addresses.size() || (!hashes.empty() && hashes.size() < addresses.size())) {
+            throw std::length_error("validateAddresses: output shorter than input");
+        }
 
-        // Function to merge the public keys of Curve448 and Kyber1024
-        auto mergePublicKeys = [](const SPHINXKey::SPHINXPubKey& curve448PublicKey, const SPHINXKey::SPHINXPubKey& kyberPublicKey) {
-            SPHINXKey::SPHINXPubKey mergedPublicKey;
-            mergedPublicKey.insert(mergedPublicKey.end(), curve448PublicKey.begin(), curve448PublicKey.end());
-            mergedPublicKey.insert(mergedPublicKey.end(), kyberPublicKey.begin(), kyberPublicKey.end());
-            return SPHINXHash::SPHINX_256(mergedPublicKey); // Hash the merged public key
-        };
+        pool.parallelFor(addresses.size(), ADDRESS_BATCH_GRAIN, [&](size_t begin, size_t end) {
+            std::array<unsigned char, ADDRESS_HASH_GROUP * ADDRESS_PAYLOAD_SIZE> payloads;
+            std::array<unsigned char, ADDRESS_HASH_GROUP * SPHINX_256_DIGEST_SIZE> checksums;
+            const unsigned char* messages[ADDRESS_HASH_GROUP];
+            size_t pending[ADDRESS_HASH_GROUP];
+
+            for (size_t group = begin; group < end; group += ADDRESS_HASH_GROUP) {
+                const size_t n = std::min(ADDRESS_HASH_GROUP, end - group);
+
+                // Step 1: Decode every address of the group, keeping those whose checksum still has to be checked
+                size_t m = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    unsigned char* payload = payloads.data() + i * ADDRESS_PAYLOAD_SIZE;
+                    statuses[group + i] = decodeAddressPayload(addresses[group + i], payload);
+                    if (statuses[group + i] == AddressStatus::Valid) {
+                        messages[m] = payload;
+                        pending[m++] = i;
+                    }
+                }
+                if (m == 0) {
+                    continue;
+                }
+
+                // Step 2: Recompute the checksums (double SPHINX_256 of version byte + hash) in SIMD lanes
+                SPHINXHash::SPHINX_256_multi(messages, 1 + RIPEMD_160_DIGEST_SIZE, m, checksums.data());
+                SPHINXHash::SPHINX_256_multi(std::span<const unsigned char>(checksums.data(), m * SPHINX_256_DIGEST_SIZE), SPHINX_256_DIGEST_SIZE, checksums.data());
+
+                // Step 3: Compare them with the decoded checksums
+                for (size_t k = 0; k < m; ++k) {
+                    const size_t i = pending[k];
+                    const unsigned char* payload = payloads.data() + i * ADDRESS_PAYLOAD_SIZE;
+                    if (std::memcmp(checksums.data() + k * SPHINX_256_DIGEST_SIZE, payload + 1 + RIPEMD_160_DIGEST_SIZE, 4) != 0) {
+                        statuses[group + i] = AddressStatus::BadChecksum;
+                    } else if (!hashes.empty()) {
+                        std::copy_n(payload + 1, RIPEMD_160_DIGEST_SIZE, hashes[group + i].begin());
+                    }
+                }
+            }
+        });
+    }
 
-        // Generate Curve448 key pair
-        SPHINXKey::SPHINXPrivKey curve448PrivateKey = SPHINXHybridKey::generateCurve448PrivateKey();
-        SPHINXKey::SPHINXPubKey curve448PublicKey = SPHINXHybridKey::generateCurve448PublicKey();
+    // Function to merge the private keys of Curve448 and Kyber1024
+    SPHINXKey::SPHINXPrivKey mergePrivateKeys(const SPHINXKey::Curve448PrivKey& curve448PrivateKey, const SPHINXKey::KyberPrivKey& kyberPrivateKey) {
+        SPHINX_INSTRUMENT_SCOPE(InstrumentedStage::MergePrivateKeys, curve448PrivateKey.size() + kyberPrivateKey.size());
 
-        // Generate Kyber1024 key pair
-        SPHINXKey::SPHINXPrivKey kyberPrivateKey = SPHINXHybridKey::generateKyberPrivateKey();
-        SPHINXKey::SPHINXPubKey kyberPublicKey = SPHINXHybridKey::generateKyberPublicKey();
+        return mergePrivateKeys<DefaultParameterSet>(curve448PrivateKey, kyberPrivateKey);
+    }
 
-        // Merge the private keys
-        SPHINXKey::SPHINXPrivKey sphinxPrivKey = mergePrivateKeys(curve448PrivateKey, kyberPrivateKey);
+    // Function to merge the public keys of Curve448 and Kyber1024
+    SPHINXKey::SPHINXPubKey mergePublicKeys(const SPHINXKey::Curve448PubKey& curve448PublicKey, const SPHINXKey::KyberPubKey& kyberPublicKey) {
+        SPHINX_INSTRUMENT_SCOPE(InstrumentedStage::MergePublicKeys, curve448PublicKey.size() + kyberPublicKey.size());
+
+        return mergePublicKeys<DefaultParameterSet>(curve448PublicKey, kyberPublicKey);
+    }
 
-        // Merge the public keys
-        SPHINXKey::SPHINXPubKey sphinxPubKey = mergePublicKeys(curve448PublicKey, kyberPublicKey);
+    // Function to generate the hybrid key pair from "hybrid_key.cpp"
+    SPHINXHybridKey::HybridKeypair generate_hybrid_keypair() {
+        SPHINX_INSTRUMENT_SCOPE(InstrumentedStage::GenerateHybridKeypair, 2 * CURVE448_PRIVATE_KEY_SIZE + KYBER1024_PRIVATE_KEY_LENGTH + KYBER1024_PUBLIC_KEY_LENGTH);
 
-        // Create the hybrid key pair structure
+        // Generate the Curve448 and Kyber1024 key pairs from hybrid_key.cpp and merge them
         SPHINXHybridKey::HybridKeypair hybridKeyPair;
-        hybridKeyPair.merged_key.sphinxPrivKey = sphinxPrivKey;
-        hybridKeyPair.merged_key.sphinxPubKey = sphinxPubKey;
+        hybridKeyPair.merged_key = generateMergedKey<DefaultParameterSet>();
+
+        return hybridKeyPair;
+    }
+
+    // Function to generate and perform key exchange hybrid method from "hybrid_key.cpp"
+    SPHINXHybridKey::HybridKeypair generate_and_perform_key_exchange() {
+        SPHINX_INSTRUMENT_SCOPE(InstrumentedStage::GenerateAndPerformKeyExchange, KYBER1024_PKE_PUBLIC_KEY_LENGTH + KYBER1024_PKE_PRIVATE_KEY_LENGTH);
+
+        // Generate the hybrid key pair with the merged private and public keys
+        SPHINXHybridKey::HybridKeypair hybridKeyPair = generate_hybrid_keypair();
 
         // Perform the key exchange using X448 and Kyber1024 KEM
         std::vector<uint8_t> encapsulated_key;
@@ -321,8 +824,9 @@ namespace SPHINXKey {
         std::cout << "Encrypted Message: " << encrypted_message << std::endl;
         std::cout << "Decrypted Message: " << decrypted_message << std::endl;
 
-        // Return the shared secret as specified in the function signature
-        return shared_secret;
+        // Return the key pair together with the shared secret
+        hybridKeyPair.shared_secret = std::move(shared_secret);
+        return hybridKeyPair;
     }
 
     // Function to print the generated keys and return them as strings
@@ -332,14 +836,14 @@ namespace SPHINXKey {
         // Convert public key to string
         std::string pubKeyString = sphinxKeyToString(publicKey);
 
-        // Print the private and public keys
-        std::cout << name << " private key: " << privKeyString << std::endl;
-        std::cout << name << " public key: " << pubKeyString << std::endl;
+        // Print the private and public keys as hex
+        std::cout << name << " private key: " << toHex(privateKey).view() << std::endl;
+        std::cout << name << " public key: " << toHex(publicKey).view() << std::endl;
 
         // Generate and print the contract address
         std::string contractName = "MyContract";
-        std::string contractAddress = generateAddress(publicKey, contractName);
-        std::cout << "Contract Address: " << contractAddress << std::endl;
+        SPHINXKey::SPHINXAddress contractAddress = generateAddress(publicKey, contractName);
+        std::cout << "Contract Address: " << contractAddress.view() << std::endl;
 
         // Return the keys and contract address as strings
         return std::make_pair(privKeyString, pubKeyString);
@@ -348,33 +852,24 @@ namespace SPHINXKey {
 
 
 // Usage
+// Define SPHINX_KEY_NO_MAIN to link Key.cpp into another program (for example bench/Benchmark.cpp)
+#ifndef SPHINX_KEY_NO_MAIN
 int main() {
     // Generate the hybrid key pair
     SPHINXHybridKey::HybridKeypair hybridKeyPair = SPHINXKey::generate_hybrid_keypair();
 
     // Print the hybrid key pair
     std::cout << "Hybrid Key Pair:" << std::endl;
-    std::cout << "Merged Private Key: ";
-    for (const auto& byte : hybridKeyPair.merged_key.sphinxPrivKey) {
-        std::cout << std::hex << static_cast<int>(byte);
-    }
-    std::cout << std::endl;
-
-    std::cout << "Merged Public Key: ";
-    for (const auto& byte : hybridKeyPair.merged_key.sphinxPubKey) {
-        std::cout << std::hex << static_cast<int>(byte);
-    }
-    std::cout << std::endl;
+    std::cout << "Merged Private Key: " << SPHINXKey::toHex(hybridKeyPair.merged_key.sphinxPrivKey).view() << std::endl;
+    std::cout << "Merged Public Key: " << SPHINXKey::toHex(hybridKeyPair.merged_key.sphinxPubKey).view() << std::endl;
 
     // Generate and perform key exchange
     SPHINXHybridKey::HybridKeypair exchangedKeys = SPHINXKey::generate_and_perform_key_exchange();
 
     // Print the shared secret (Example: For demonstration purposes)
-    std::cout << "Shared Secret: ";
-    for (const auto& byte : exchangedKeys.shared_secret) {
-        std::cout << std::hex << static_cast<int>(byte);
-    }
-    std::cout << std::endl;
+    std::string sharedSecretHex(2 * exchangedKeys.shared_secret.size(), '\0');
+    SPHINXKey::hexEncode(std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(exchangedKeys.shared_secret.data()), exchangedKeys.shared_secret.size()), sharedSecretHex);
+    std::cout << "Shared Secret: " << sharedSecretHex << std::endl;
 
     // Call the printKeyPair function to print and get the keys and address as strings
     std::pair<std::string, std::string> keys = SPHINXKey::printKeyPair("ExampleKeyPair", exchangedKeys.merged_key.sphinxPrivKey, exchangedKeys.merged_key.sphinxPubKey);
@@ -389,3 +884,4 @@ int main() {
 
     return 0;
 }
+#endif // SPHINX_KEY_NO_MAIN
@@ -23,72 +23,240 @@
 #include <iostream>
 #include <algorithm>
 #include <cstdint>
+#include <array>
+#include <span>
+#include <new>
+#include <string_view>
+
+#include "Hasher.hpp"
+#include "ParameterSet.hpp"
+#include "SecureArena.hpp"
+
+namespace SPHINXKey {
+
+    // Constants of the default parameter set (Kyber1024 / X448, ParameterSet.hpp)
+    constexpr size_t CURVE448_PRIVATE_KEY_SIZE = DefaultParameterSet::CURVE_PRIVATE_KEY_SIZE;
+    constexpr size_t CURVE448_PUBLIC_KEY_SIZE = DefaultParameterSet::CURVE_PUBLIC_KEY_SIZE;
+    constexpr size_t KYBER1024_PUBLIC_KEY_LENGTH = DefaultParameterSet::KEM_PUBLIC_KEY_LENGTH;
+    constexpr size_t KYBER1024_PRIVATE_KEY_LENGTH = DefaultParameterSet::KEM_PRIVATE_KEY_LENGTH;
+    constexpr size_t KYBER1024_PKE_PUBLIC_KEY_LENGTH = DefaultParameterSet::PKE_PUBLIC_KEY_LENGTH;
+    constexpr size_t KYBER1024_PKE_PRIVATE_KEY_LENGTH = DefaultParameterSet::PKE_PRIVATE_KEY_LENGTH;
+
+    // Digest sizes of SPHINX_256 and RIPEMD_160
+    constexpr size_t SPHINX_256_DIGEST_SIZE = SPHINXHash::SPHINX_256_DIGEST_SIZE;
+    constexpr size_t RIPEMD_160_DIGEST_SIZE = SPHINXHash::RIPEMD_160_DIGEST_SIZE;
+
+    // Fixed-size Curve448 and Kyber1024 keys
+    using Curve448PrivKey = DefaultParameterSet::CurvePrivKey;
+    using Curve448PubKey = DefaultParameterSet::CurvePubKey;
+    using KyberPrivKey = DefaultParameterSet::KemPrivKey;
+    using KyberPubKey = DefaultParameterSet::KemPubKey;
+    using KyberPKEPrivKey = DefaultParameterSet::PkePrivKey;
+    using KyberPKEPubKey = DefaultParameterSet::PkePubKey;
+
+    // Define an alias for the merged public key (SPHINX_256 of the Curve448 and Kyber1024 public keys) as SPHINXPubKey
+    using SPHINXPubKey = std::array<unsigned char, SPHINX_256_DIGEST_SIZE>;
+
+    // Define an alias for the merged private key (SPHINX_256 of the Curve448 and Kyber1024 private keys) as SPHINXPrivKey
+    using SPHINXPrivKey = std::array<unsigned char, SPHINX_256_DIGEST_SIZE>;
+} // namespace SPHINXKey
 
 namespace SPHINXHybridKey {
+    // Merged SPHINX key pair
+    struct MergedKey {
+        SPHINXKey::SPHINXPrivKey sphinxPrivKey{};
+        SPHINXKey::SPHINXPubKey sphinxPubKey{};
+    };
+
     // Assume the definition of SPHINXHybridKey
-    struct HybridKeypair {};
+    struct HybridKeypair {
+        MergedKey merged_key;
+
+        // Kyber1024 PKE key pair used by encryptMessage and decryptMessage
+        SPHINXKey::KyberPKEPubKey public_key_pke{};
+        SPHINXKey::KyberPKEPrivKey secret_key_pke{};
+
+        // Shared secret established by generate_and_perform_key_exchange
+        std::string shared_secret;
+    };
+
+    // Functions to generate the Curve448 and Kyber1024 keys from "hybrid_key.cpp"
+    SPHINXKey::Curve448PrivKey generateCurve448PrivateKey();
+    SPHINXKey::Curve448PubKey generateCurve448PublicKey();
+    SPHINXKey::KyberPrivKey generateKyberPrivateKey();
+    SPHINXKey::KyberPubKey generateKyberPublicKey();
 
     // Function to perform key exchange using hybrid method
     std::string encapsulateHybridSharedSecret(const HybridKeypair& hybridKeyPair, std::vector<uint8_t>& encapsulatedKey);
     std::string decapsulateHybridSharedSecret(const HybridKeypair& hybridKeyPair, const std::vector<uint8_t>& encapsulatedKey);
 
     // Function to encrypt and decrypt messages using Kyber1024 PKE
-    std::string encryptMessage(const std::string& message, const std::vector<uint8_t>& publicKey);
-    std::string decryptMessage(const std::string& ciphertext, const std::vector<uint8_t>& privateKey);
+    std::string encryptMessage(const std::string& message, std::span<const uint8_t> publicKey);
+    std::string decryptMessage(const std::string& ciphertext, std::span<const uint8_t> privateKey);
 }
 
-namespace SPHINXHash {
-    // Assume the definition of SPHINX_256 function
-    std::string SPHINX_256(const std::vector<unsigned char>& data);
-    std::string RIPEMD_160(const std::vector<unsigned char>& data);
-}
+namespace SPHINXKey {
+
+    // Key generators of a parameter set, provided by the backend that implements it
+    // hybrid_key.cpp implements DefaultParameterSet; a backend for another set (e.g. Kyber512X25519) specialises this template
+    // Private keys are written through an out-parameter, straight into the caller's SecureKey slot
+    template <typename Params>
+    struct HybridKeyBackend;
+
+    template <>
+    struct HybridKeyBackend<DefaultParameterSet> {
+        // hybrid_key.cpp returns the private keys by value: the result is constructed directly in privateKey (guaranteed copy elision),
+        // so the callee writes into the slot and no temporary copy is left on the stack
+        static void generateCurvePrivateKey(Curve448PrivKey& privateKey) { ::new (static_cast<void*>(&privateKey)) Curve448PrivKey(SPHINXHybridKey::generateCurve448PrivateKey()); }
+        static Curve448PubKey generateCurvePublicKey() { return SPHINXHybridKey::generateCurve448PublicKey(); }
+        static void generateKemPrivateKey(KyberPrivKey& privateKey) { ::new (static_cast<void*>(&privateKey)) KyberPrivKey(SPHINXHybridKey::generateKyberPrivateKey()); }
+        static KyberPubKey generateKemPublicKey() { return SPHINXHybridKey::generateKyberPublicKey(); }
+    };
+
+    // Function to generate the curve and Kyber key pairs of a parameter set and merge them
+    // The private keys are held in SecureKey slots (SecureArena.hpp) until they have been merged
+    template <typename Params, typename Backend = HybridKeyBackend<Params>>
+    SPHINXHybridKey::MergedKey generateMergedKey() {
+        SecureKey<typename Params::CurvePrivKey> curvePrivateKey;
+        Backend::generateCurvePrivateKey(*curvePrivateKey);
+        const typename Params::CurvePubKey curvePublicKey = Backend::generateCurvePublicKey();
+
+        SecureKey<typename Params::KemPrivKey> kemPrivateKey;
+        Backend::generateKemPrivateKey(*kemPrivateKey);
+        const typename Params::KemPubKey kemPublicKey = Backend::generateKemPublicKey();
+
+        SPHINXHybridKey::MergedKey mergedKey;
+        mergedKey.sphinxPrivKey = mergePrivateKeys<Params>(*curvePrivateKey, *kemPrivateKey);
+        mergedKey.sphinxPubKey = mergePublicKeys<Params>(curvePublicKey, kemPublicKey);
+        return mergedKey;
+    }
+} // namespace SPHINXKey
 
 // Base58 characters (excluding confusing characters: 0, O, I, l) for address human readable
 static const std::string base58_chars = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
 
+// Upper bound on the Base58 length of a payload of the given size (log(256) / log(58) < 1.38)
+constexpr size_t Base58MaxEncodedLength(size_t length) {
+    return length * 138 / 100 + 1;
+}
+
 // Function to encode data using Base58
 std::string EncodeBase58(const std::vector<unsigned char>& data);
+std::string EncodeBase58(const unsigned char* data, size_t length);
+
+// Function to encode data using Base58 into a caller buffer, returns the number of characters written
+size_t EncodeBase58(const unsigned char* data, size_t length, char* out, size_t outCapacity);
+
+// Function to decode a Base58 string, returns false on characters outside base58_chars
+bool DecodeBase58(const std::string& str, std::vector<unsigned char>& data);
+bool DecodeBase58(const char* str, size_t length, std::vector<unsigned char>& data);
+
+// Function to encode data using Base58Check (payload + first 4 bytes of double SPHINX_256)
+std::string EncodeBase58Check(const std::vector<unsigned char>& payload);
+
+// Function to decode a Base58Check string and verify its checksum
+bool DecodeBase58Check(const std::string& str, std::vector<unsigned char>& payload);
+
+// Function to encode many equal-length payloads into one preallocated buffer
+// Item i is written at out + i * stride and its length is stored in lengths[i]
+void EncodeBase58Batch(const unsigned char* payloads, size_t payloadLength, size_t count, char* out, size_t stride, size_t* lengths);
 
 namespace SPHINXKey {
 
-    // Constants
-    constexpr size_t CURVE448_PRIVATE_KEY_SIZE = 56;
-    constexpr size_t CURVE448_PUBLIC_KEY_SIZE = 56;
-    constexpr size_t KYBER1024_PUBLIC_KEY_LENGTH = 800;
-    constexpr size_t KYBER1024_PRIVATE_KEY_LENGTH = 1632;
-    constexpr size_t KYBER1024_PKE_PUBLIC_KEY_LENGTH = 800;
-    constexpr size_t KYBER1024_PKE_PRIVATE_KEY_LENGTH = 1632;
+    // Work-stealing pool used by the batch functions (ThreadPool.hpp)
+    class ThreadPool;
 
     // Size of HYBRIDKEY
-    constexpr size_t HYBRID_KEYPAIR_LENGTH = CURVE448_PUBLIC_KEY_SIZE + KYBER1024_PUBLIC_KEY_LENGTH + 2 * SPHINXHybridKey::HMAC_MAX_MD_SIZE;
-    // HYBRID_KEYPAIR_LENGTH = 56 (Curve448 public key size) + 800 (Kyber1024 public key length) + 2 * 64 (HMAC_MAX_MD_SIZE) = 976;
+    constexpr size_t HYBRID_KEYPAIR_LENGTH = DefaultParameterSet::HYBRID_KEYPAIR_LENGTH;
+    // HYBRID_KEYPAIR_LENGTH = 56 (Curve448 public key size) + 1568 (Kyber1024 public key length) + 2 * 64 (HMAC-SHA512 size) = 1752;
+    static_assert(HYBRID_KEYPAIR_LENGTH == 1752);
+
+    // For Bitcoin addresses, the version byte is 0x00 (mainnet). We can change it if needed.
+    constexpr unsigned char ADDRESS_VERSION_BYTE = 0x00;
+
+    // Address payload: version byte + RIPEMD-160 hash + 4-byte checksum
+    constexpr size_t ADDRESS_PAYLOAD_SIZE = 1 + RIPEMD_160_DIGEST_SIZE + 4;
+    constexpr size_t ADDRESS_MAX_LENGTH = Base58MaxEncodedLength(ADDRESS_PAYLOAD_SIZE);
 
-    // Define an alias for the merged public key as SPHINXPubKey
-    using SPHINXPubKey = std::vector<unsigned char>;
+    // Fixed-capacity Base58Check address
+    struct SPHINXAddress {
+        std::array<char, ADDRESS_MAX_LENGTH> chars{};
+        size_t length = 0;
 
-    // Define an alias for the merged private key as SPHINXPrivKey
-    using SPHINXPrivKey = std::vector<unsigned char>;
+        std::string_view view() const { return std::string_view(chars.data(), length); }
+        operator std::string_view() const { return view(); }
+    };
 
-    // Function to calculate the SPHINX public key from the private key
-    SPHINXPubKey calculatePublicKey(const SPHINXPrivKey& privateKey);
+    // Function to calculate the Kyber1024 public key embedded in the Kyber1024 private key
+    KyberPubKey calculatePublicKey(const KyberPrivKey& privateKey);
 
     // Function to convert SPHINXKey to string
-    std::string sphinxKeyToString(const std::vector<unsigned char>& key);
+    std::string sphinxKeyToString(std::span<const unsigned char> key);
 
     // Function to generate the smart contract address based on the public key and contract name
-    std::string generateAddress(const SPHINXPubKey& publicKey, const std::string& contractName);
+    SPHINXAddress generateAddress(const SPHINXPubKey& publicKey, std::string_view contractName);
+
+    // Location of one address inside an AddressArena buffer
+    struct AddressSlot {
+        size_t offset;
+        size_t length;
+    };
+
+    // Caller-provided output of generateAddresses: address characters are packed into buffer
+    // and slots[i] locates the address of publicKeys[i]
+    struct AddressArena {
+        std::span<char> buffer;
+        std::span<AddressSlot> slots;
+    };
+
+    // Layout of the addresses inside AddressArena::buffer
+    enum class AddressOrder {
+        Completion,    // Chunks are packed in the order workers finish them
+        Deterministic  // Chunks are packed in input order, byte-for-byte identical to the serial path
+    };
+
+    // Function to generate the addresses of many public keys on the calling thread, hashing them in SIMD lanes
+    // addresses[i] receives the address of publicKeys[i]
+    void generateAddresses(std::span<const SPHINXPubKey> publicKeys, std::string_view contractName, std::span<SPHINXAddress> addresses);
+
+    // Function to generate the addresses of many public keys in parallel, returns the number of buffer bytes used
+    // Completion order requires arena.buffer.size() >= publicKeys.size() * ADDRESS_MAX_LENGTH; Deterministic order only needs the exact total
+    // Throws std::length_error before writing arena.buffer if it is too small (slots may already have been overwritten)
+    size_t generateAddresses(std::span<const SPHINXPubKey> publicKeys, std::string_view contractName, AddressArena& arena, AddressOrder order = AddressOrder::Completion);
+    size_t generateAddresses(std::span<const SPHINXPubKey> publicKeys, std::string_view contractName, AddressArena& arena, AddressOrder order, ThreadPool& pool);
+
+    // Outcome of decoding an address string
+    enum class AddressStatus : uint8_t {
+        Valid,
+        BadLength,      // Empty, longer than ADDRESS_MAX_LENGTH, or not the Base58 form of a 25-byte payload
+        BadCharacter,   // Character outside base58_chars
+        BadVersion,     // Version byte is not ADDRESS_VERSION_BYTE
+        BadChecksum     // Checksum does not match the version byte and hash
+    };
+
+    // Function to decode an address into the RIPEMD-160 hash it was generated from (the inverse of generateAddress)
+    // The characters are checked with vector compares before any bignum work, and the fixed-size payload is decoded without allocating
+    AddressStatus decodeAddress(std::string_view address, SPHINXHash::RIPEMD160Digest& hash);
+
+    // Function to check an address
+    bool isValidAddress(std::string_view address);
+
+    // Function to validate many addresses in parallel; statuses[i] and, unless hashes is empty, hashes[i] receive the result of addresses[i]
+    // Checksums are computed 64 addresses at a time with SPHINX_256_multi
+    void validateAddresses(std::span<const std::string_view> addresses, std::span<AddressStatus> statuses, std::span<SPHINXHash::RIPEMD160Digest> hashes = {});
+    void validateAddresses(std::span<const std::string_view> addresses, std::span<AddressStatus> statuses, std::span<SPHINXHash::RIPEMD160Digest> hashes, ThreadPool& pool);
 
     // Function to merge the private keys of Curve448 and Kyber1024
-    SPHINXPrivKey mergePrivateKeys(const SPHINXPrivKey& curve448PrivateKey, const SPHINXPrivKey& kyberPrivateKey);
+    SPHINXPrivKey mergePrivateKeys(const Curve448PrivKey& curve448PrivateKey, const KyberPrivKey& kyberPrivateKey);
 
     // Function to merge the public keys of Curve448 and Kyber1024
-    SPHINXPubKey mergePublicKeys(const SPHINXPubKey& curve448PublicKey, const SPHINXPubKey& kyberPublicKey);
+    SPHINXPubKey mergePublicKeys(const Curve448PubKey& curve448PublicKey, const KyberPubKey& kyberPublicKey);
 
     // Function to generate the hybrid key pair from "hybrid_key.cpp"
-    HybridKeypair generate_hybrid_keypair();
+    SPHINXHybridKey::HybridKeypair generate_hybrid_keypair();
 
     // Function to generate and perform key exchange hybrid method from "hybrid_key.cpp"
-    HybridKeypair generate_and_perform_key_exchange();
+    SPHINXHybridKey::HybridKeypair generate_and_perform_key_exchange();
 
     // Function to print the generated keys and return them as strings
     std::pair<std::string, std::string> printKeyPair(const std::string& name, const SPHINXPrivKey& privateKey, const SPHINXPubKey& publicKey);
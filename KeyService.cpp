@@ -0,0 +1,390 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code implements KeyService, an asynchronous facade over generate_hybrid_keypair, generate_and_perform_key_exchange and generateAddress.
+
+// Requests:
+    // Each call creates a KeyRequest (operation, input, stop token, result slot) shared between the caller and the service.
+    // The coroutine form returns a KeyTask: co_await queues the request and suspends. Once the request completes its coroutine is handed to options.executor,
+    // or, without one, resumed on the worker that ran it after the whole batch has run, so no result of the batch waits for another request's continuation.
+    // The future form derives a request that sets a std::promise on completion, so callers without coroutines get a std::future.
+
+// Bounded executor:
+    // The service owns options.workers threads and one FIFO of at most options.queueCapacity requests.
+    // When the FIFO is full, an awaiting coroutine is parked in a second FIFO (it holds no thread) and admitted as workers take requests;
+    // a future call blocks its caller until there is space. Either way producers are slowed down to the rate the workers sustain.
+    // The parked FIFO holds at most options.parkedCapacity coroutines; a coroutine that would pass it is rejected with std::errc::resource_unavailable_try_again.
+
+// Batching:
+    // A worker takes the run of queued requests at the front of the FIFO that share one operation, up to options.maxBatch, with one lock acquisition.
+    // Address requests of a batch are hashed together with the multi-buffer generateAddresses (64 keys per SIMD pass); key generation and key exchange run one by one.
+
+// Cancellation:
+    // Requests carry a std::stop_token. One that is already stopped is rejected when it is submitted. A waiting request registers a std::stop_callback
+    // (before it becomes visible to the workers); when it fires, the request is taken out of the queue or the parked FIFO and completed on the stopping thread.
+    // A worker drops the callbacks of the requests it takes, outside the service lock since dropping one waits for a callback that is running.
+    // Cancelled requests complete with std::system_error(std::errc::operation_canceled); a request that is already running is not interrupted.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <variant>
+#include <algorithm>
+#include <exception>
+#include <stop_token>
+#include <system_error>
+#include <condition_variable>
+
+#include "Key.hpp"
+#include "KeypairPool.hpp"
+#include "KeyService.hpp"
+
+
+namespace SPHINXKey {
+
+    namespace {
+        std::exception_ptr cancelledError() {
+            return std::make_exception_ptr(std::system_error(std::make_error_code(std::errc::operation_canceled), "KeyService: request cancelled"));
+        }
+
+        std::exception_ptr busyError() {
+            return std::make_exception_ptr(std::system_error(std::make_error_code(std::errc::resource_unavailable_try_again), "KeyService: too many requests waiting"));
+        }
+
+        KeyServiceOptions normalizedOptions(KeyServiceOptions options) {
+            if (options.workers == 0) {
+                options.workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+            }
+            options.queueCapacity = std::max<size_t>(1, options.queueCapacity);
+            options.maxBatch = std::max<size_t>(1, options.maxBatch);
+            return options;
+        }
+
+        // Request completed through a std::promise
+        template <typename T>
+        struct PromiseRequest : KeyRequest {
+            std::promise<T> promise;
+
+            void complete() override {
+                if (error) {
+                    promise.set_exception(error);
+                } else {
+                    promise.set_value(std::get<T>(result));
+                }
+            }
+        };
+
+        std::shared_ptr<KeyRequest> makeRequest(std::shared_ptr<KeyRequest> request, KeyOperation operation, const SPHINXPubKey* publicKey, std::stop_token stopToken) {
+            request->operation = operation;
+            if (publicKey != nullptr) {
+                request->publicKey = *publicKey;
+            }
+            request->stopToken = std::move(stopToken);
+            return request;
+        }
+    } // namespace
+
+    void KeyRequestCanceller::operator()() const {
+        service->cancel(*request);
+    }
+
+    KeyRequest::~KeyRequest() {
+        if (auto* keypair = std::get_if<SPHINXHybridKey::HybridKeypair>(&result)) {
+            wipeKeypair(*keypair);
+        }
+    }
+
+    // Function to start the service
+    KeyService::KeyService(KeyServiceOptions options)
+        : options_(normalizedOptions(std::move(options))) {
+        workers_.reserve(options_.workers);
+        for (size_t i = 0; i < options_.workers; ++i) {
+            workers_.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    // Function to stop the service
+    KeyService::~KeyService() {
+        std::deque<std::shared_ptr<KeyRequest>> abandoned;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            abandoned.swap(queue_);
+            for (auto& request : parked_) {
+                abandoned.push_back(std::move(request));
+            }
+            parked_.clear();
+        }
+        work_.notify_all();
+        space_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+        for (auto& request : abandoned) {
+            request->stopCallback.reset();
+            request->error = cancelledError();
+            finish(request);
+        }
+    }
+
+    // Functions returning awaitable tasks
+    KeyTask<SPHINXHybridKey::HybridKeypair> KeyService::generateKeypair(std::stop_token stopToken) {
+        return KeyTask<SPHINXHybridKey::HybridKeypair>(*this, makeRequest(std::make_shared<KeyRequest>(), KeyOperation::GenerateKeypair, nullptr, std::move(stopToken)));
+    }
+
+    KeyTask<SPHINXHybridKey::HybridKeypair> KeyService::keyExchange(std::stop_token stopToken) {
+        return KeyTask<SPHINXHybridKey::HybridKeypair>(*this, makeRequest(std::make_shared<KeyRequest>(), KeyOperation::KeyExchange, nullptr, std::move(stopToken)));
+    }
+
+    KeyTask<SPHINXAddress> KeyService::generateAddress(const SPHINXPubKey& publicKey, std::stop_token stopToken) {
+        return KeyTask<SPHINXAddress>(*this, makeRequest(std::make_shared<KeyRequest>(), KeyOperation::GenerateAddress, &publicKey, std::move(stopToken)));
+    }
+
+    template <typename T>
+    std::future<T> KeyService::submitFuture(KeyOperation operation, const SPHINXPubKey* publicKey, std::stop_token stopToken) {
+        auto request = std::make_shared<PromiseRequest<T>>();
+        std::future<T> future = request->promise.get_future();
+        makeRequest(request, operation, publicKey, std::move(stopToken));
+        if (!enqueue(request, true)) {
+            request->complete();
+        }
+        return future;
+    }
+
+    // Functions returning std::future
+    std::future<SPHINXHybridKey::HybridKeypair> KeyService::generateKeypairAsync(std::stop_token stopToken) {
+        return submitFuture<SPHINXHybridKey::HybridKeypair>(KeyOperation::GenerateKeypair, nullptr, std::move(stopToken));
+    }
+
+    std::future<SPHINXHybridKey::HybridKeypair> KeyService::keyExchangeAsync(std::stop_token stopToken) {
+        return submitFuture<SPHINXHybridKey::HybridKeypair>(KeyOperation::KeyExchange, nullptr, std::move(stopToken));
+    }
+
+    std::future<SPHINXAddress> KeyService::generateAddressAsync(const SPHINXPubKey& publicKey, std::stop_token stopToken) {
+        return submitFuture<SPHINXAddress>(KeyOperation::GenerateAddress, &publicKey, std::move(stopToken));
+    }
+
+    // Function to return a snapshot of the service counters
+    KeyServiceMetrics KeyService::metrics() const {
+        KeyServiceMetrics metrics;
+        metrics.completed = completed_.load(std::memory_order_relaxed);
+        metrics.cancelled = cancelled_.load(std::memory_order_relaxed);
+        metrics.batches = batches_.load(std::memory_order_relaxed);
+        metrics.rejected = rejected_.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex_);
+        metrics.queued = queue_.size();
+        metrics.waiting = parked_.size();
+        return metrics;
+    }
+
+    // Function to queue a request
+    bool KeyService::enqueue(const std::shared_ptr<KeyRequest>& request, bool blocking) {
+        // Step 1: Reject a request that is already cancelled
+        if (request->stopToken.stop_requested()) {
+            cancelled_.fetch_add(1, std::memory_order_relaxed);
+            request->error = cancelledError();
+            return false;
+        }
+
+        // Step 2: Register the stop callback while no worker can see the request; if the token fires now, the callback finds nothing to take out
+        if (request->stopToken.stop_possible()) {
+            request->stopCallback.emplace(request->stopToken, KeyRequestCanceller{this, request.get()});
+        }
+
+        // Step 3: Queue it, waiting for space or parking it when the queue is full
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (blocking) {
+            space_.wait(lock, [&] { return stopping_ || queue_.size() < options_.queueCapacity; });
+        }
+        const bool queued = queue_.size() < options_.queueCapacity && parked_.empty();
+        std::exception_ptr error;
+        if (stopping_) {
+            error = cancelledError();
+        } else if (request->stopToken.stop_requested()) {
+            cancelled_.fetch_add(1, std::memory_order_relaxed);
+            error = cancelledError();
+        } else if (!queued && !blocking && parked_.size() >= options_.parkedCapacity) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            error = busyError();
+        }
+        if (error) {
+            lock.unlock();
+            request->stopCallback.reset();
+            request->error = error;
+            return false;
+        }
+        if (queued) {
+            queue_.push_back(request);
+        } else {
+            parked_.push_back(request);
+        }
+        lock.unlock();
+
+        // The caller may be resumed (and request released) from here on
+        work_.notify_one();
+        return true;
+    }
+
+    // Function to take a waiting request out of the service and complete it with operation_canceled
+    void KeyService::cancel(KeyRequest& target) {
+        // Step 1: Find it; a worker that has already taken it runs or skips it instead
+        std::shared_ptr<KeyRequest> request;
+        bool admitted = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto take = [&](std::deque<std::shared_ptr<KeyRequest>>& fifo) {
+                const auto found = std::find_if(fifo.begin(), fifo.end(), [&](const std::shared_ptr<KeyRequest>& waiting) { return waiting.get() == &target; });
+                if (found == fifo.end()) {
+                    return false;
+                }
+                request = std::move(*found);
+                fifo.erase(found);
+                return true;
+            };
+            if (take(queue_)) {
+                // Admit a parked coroutine into the slot just freed
+                if (!parked_.empty()) {
+                    queue_.push_back(std::move(parked_.front()));
+                    parked_.pop_front();
+                    admitted = true;
+                }
+            } else if (!take(parked_)) {
+                return;
+            }
+        }
+        if (admitted) {
+            work_.notify_one();
+        } else {
+            space_.notify_one();
+        }
+
+        // Step 2: Complete it on this thread; its stop callback (this call) goes with the request
+        cancelled_.fetch_add(1, std::memory_order_relaxed);
+        request->error = cancelledError();
+        finish(request);
+    }
+
+    // Function to hand a completed request back to its caller
+    void KeyService::finish(const std::shared_ptr<KeyRequest>& request) {
+        if (request->continuation && options_.executor) {
+            options_.executor(request->continuation);
+        } else {
+            request->complete();
+        }
+    }
+
+    void KeyService::workerLoop() {
+        std::vector<std::shared_ptr<KeyRequest>> batch;
+        batch.reserve(options_.maxBatch);
+        for (;;) {
+            // Step 1: Take the run of requests of one operation at the front of the queue
+            bool moreQueued = false;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                work_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+                if (stopping_) {
+                    return;
+                }
+                const KeyOperation operation = queue_.front()->operation;
+                while (!queue_.empty() && batch.size() < options_.maxBatch && queue_.front()->operation == operation) {
+                    batch.push_back(std::move(queue_.front()));
+                    queue_.pop_front();
+                }
+
+                // Admit parked coroutines into the space just freed
+                while (!parked_.empty() && queue_.size() < options_.queueCapacity) {
+                    queue_.push_back(std::move(parked_.front()));
+                    parked_.pop_front();
+                }
+                moreQueued = !queue_.empty();
+            }
+            space_.notify_all();
+            if (moreQueued) {
+                work_.notify_one();
+            }
+            batches_.fetch_add(1, std::memory_order_relaxed);
+
+            // Step 2: Drop the stop callbacks of the requests taken, outside the lock (this waits for a callback that is running)
+            for (auto& request : batch) {
+                request->stopCallback.reset();
+            }
+
+            // Step 3: Run the batch, then hand every result back in queue order
+            runBatch(batch);
+            for (auto& request : batch) {
+                finish(request);
+            }
+            batch.clear();
+        }
+    }
+
+    void KeyService::runBatch(std::vector<std::shared_ptr<KeyRequest>>& batch) {
+        // Step 1: Skip the requests cancelled after they were queued
+        std::vector<KeyRequest*> live;
+        live.reserve(batch.size());
+        for (auto& request : batch) {
+            if (request->stopToken.stop_requested()) {
+                cancelled_.fetch_add(1, std::memory_order_relaxed);
+                request->error = cancelledError();
+            } else {
+                live.push_back(request.get());
+            }
+        }
+
+        // Step 2: Produce the results
+        if (live.empty()) {
+            return;
+        }
+        switch (live.front()->operation) {
+            case KeyOperation::GenerateAddress: {
+                std::vector<SPHINXPubKey> publicKeys(live.size());
+                std::vector<SPHINXAddress> addresses(live.size());
+                for (size_t i = 0; i < live.size(); ++i) {
+                    publicKeys[i] = live[i]->publicKey;
+                }
+                try {
+                    SPHINXKey::generateAddresses(publicKeys, "", addresses);
+                    for (size_t i = 0; i < live.size(); ++i) {
+                        live[i]->result = addresses[i];
+                    }
+                } catch (...) {
+                    for (KeyRequest* request : live) {
+                        request->error = std::current_exception();
+                    }
+                }
+                break;
+            }
+            case KeyOperation::GenerateKeypair:
+            case KeyOperation::KeyExchange:
+                for (KeyRequest* request : live) {
+                    try {
+                        request->result = request->operation == KeyOperation::GenerateKeypair ? generate_hybrid_keypair() : generate_and_perform_key_exchange();
+                    } catch (...) {
+                        request->error = std::current_exception();
+                    }
+                }
+                break;
+        }
+        completed_.fetch_add(live.size(), std::memory_order_relaxed);
+    }
+} // namespace SPHINXKey
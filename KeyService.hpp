@@ -0,0 +1,206 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+#ifndef SPHINX_KEY_SERVICE_HPP
+#define SPHINX_KEY_SERVICE_HPP
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <variant>
+#include <coroutine>
+#include <optional>
+#include <exception>
+#include <functional>
+#include <stop_token>
+#include <condition_variable>
+
+#include "Key.hpp"
+
+namespace SPHINXKey {
+
+    // Blocking entry point a KeyService request runs
+    enum class KeyOperation : uint8_t {
+        GenerateKeypair,    // generate_hybrid_keypair
+        KeyExchange,        // generate_and_perform_key_exchange
+        GenerateAddress     // generateAddress
+    };
+
+    class KeyService;
+    struct KeyRequest;
+
+    // Function that resumes an awaiting coroutine once its request has completed, e.g. by posting the handle to the caller's event loop or a ThreadPool
+    // It is called on a service worker, or on the thread that triggered a cancellation, and must neither block nor throw
+    using KeyExecutor = std::function<void(std::coroutine_handle<>)>;
+
+    // Stop callback of a request waiting in a KeyService: takes it out of the queue and completes it with operation_canceled
+    struct KeyRequestCanceller {
+        KeyService* service;
+        KeyRequest* request;
+
+        void operator()() const;
+    };
+
+    // State of one request, shared by the caller and the service worker that runs it
+    struct KeyRequest {
+        KeyOperation operation = KeyOperation::GenerateKeypair;
+        SPHINXPubKey publicKey{};    // Input of GenerateAddress
+        std::stop_token stopToken;
+        std::variant<std::monostate, SPHINXHybridKey::HybridKeypair, SPHINXAddress> result;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation;
+        std::optional<std::stop_callback<KeyRequestCanceller>> stopCallback;    // Registered while the request waits in the service
+
+        // A key pair result is wiped when the request is released
+        virtual ~KeyRequest();
+
+        // Function called once the result or error is set: resumes the awaiting coroutine (the future form sets its promise instead)
+        // A KeyService with an executor hands the continuation to it instead of calling this
+        virtual void complete() { continuation.resume(); }
+    };
+
+    // Awaitable result of a KeyService call; the request is queued when the task is co_awaited and the coroutine resumes through the service's executor
+    // (on a service worker, once the worker's batch has run, if there is none)
+    // co_await returns the result or throws its exception: std::system_error(std::errc::operation_canceled) if it was cancelled,
+    // std::system_error(std::errc::resource_unavailable_try_again) if the queue was full and parkedCapacity coroutines were already waiting
+    template <typename T>
+    class KeyTask {
+    public:
+        KeyTask(KeyService& service, std::shared_ptr<KeyRequest> request) : service_(&service), request_(std::move(request)) {}
+
+        KeyTask(KeyTask&&) noexcept = default;
+        KeyTask& operator=(KeyTask&&) noexcept = default;
+        KeyTask(const KeyTask&) = delete;
+        KeyTask& operator=(const KeyTask&) = delete;
+
+        bool await_ready() const noexcept { return false; }
+
+        // Returns false (resume at once) if the request was rejected; otherwise a worker may resume the coroutine before this returns
+        bool await_suspend(std::coroutine_handle<> handle);
+
+        T await_resume() {
+            if (request_->error) {
+                std::rethrow_exception(request_->error);
+            }
+            return std::get<T>(request_->result);
+        }
+
+    private:
+        KeyService* service_;
+        std::shared_ptr<KeyRequest> request_;
+    };
+
+    // Sizing of a KeyService and where its coroutines resume
+    struct KeyServiceOptions {
+        size_t workers = 0;             // Worker threads, 0 uses the number of hardware threads
+        size_t queueCapacity = 1024;    // Requests queued ahead of the workers; past this, submitters wait (backpressure)
+        size_t maxBatch = 64;           // Queued requests of one operation a worker takes at once
+        size_t parkedCapacity = 65536;  // Awaiting coroutines parked while the queue is full; past this, co_await fails at once
+        KeyExecutor executor;           // Where awaiting coroutines resume; empty resumes them on the service worker after its batch
+    };
+
+    // Counters reported by KeyService::metrics
+    struct KeyServiceMetrics {
+        uint64_t completed = 0;    // Requests that produced a result or an error
+        uint64_t cancelled = 0;    // Requests skipped because their stop token was triggered
+        uint64_t batches = 0;      // Batches taken by the workers
+        uint64_t rejected = 0;     // Awaiting coroutines refused because parkedCapacity coroutines were already waiting
+        size_t queued = 0;         // Requests waiting for a worker
+        size_t waiting = 0;        // Awaiting coroutines waiting for queue space
+    };
+
+    // Asynchronous facade over the blocking key and address functions
+    // Requests go to a bounded FIFO served by a fixed set of worker threads, so thousands of requests can be in flight without more threads than cores.
+    // A worker takes up to maxBatch queued requests of the same operation at once; addresses in a batch are hashed together with the multi-buffer generateAddresses.
+    // When the queue is full an awaiting coroutine is parked (no thread blocks) and a future call blocks its caller until a worker frees space;
+    // at most parkedCapacity coroutines are parked, so callers that keep more requests in flight than queueCapacity + parkedCapacity see them rejected.
+    // A request whose stop token is triggered while it waits is taken out at once and completes with operation_canceled.
+    // A continuation must not block on the service (e.g. wait on one of its futures): without an executor it runs on a service worker, which serves
+    // no other request meanwhile, so with one worker that is a deadlock. Set options.executor to resume coroutines on the caller's own threads.
+    class KeyService {
+    public:
+        explicit KeyService(KeyServiceOptions options = {});
+
+        // Function to stop the service: queued and parked requests complete with operation_canceled, running batches finish first
+        ~KeyService();
+
+        KeyService(const KeyService&) = delete;
+        KeyService& operator=(const KeyService&) = delete;
+
+        // Functions returning awaitable tasks
+        KeyTask<SPHINXHybridKey::HybridKeypair> generateKeypair(std::stop_token stopToken = {});
+        KeyTask<SPHINXHybridKey::HybridKeypair> keyExchange(std::stop_token stopToken = {});
+        KeyTask<SPHINXAddress> generateAddress(const SPHINXPubKey& publicKey, std::stop_token stopToken = {});
+
+        // Functions returning std::future, for callers without coroutines
+        std::future<SPHINXHybridKey::HybridKeypair> generateKeypairAsync(std::stop_token stopToken = {});
+        std::future<SPHINXHybridKey::HybridKeypair> keyExchangeAsync(std::stop_token stopToken = {});
+        std::future<SPHINXAddress> generateAddressAsync(const SPHINXPubKey& publicKey, std::stop_token stopToken = {});
+
+        // Function to return a snapshot of the service counters
+        KeyServiceMetrics metrics() const;
+
+    private:
+        template <typename T>
+        friend class KeyTask;
+        friend struct KeyRequestCanceller;
+
+        // Function to queue a request, returns false with request->error set if it was rejected (cancelled or service stopping)
+        // blocking waits for queue space; otherwise the request is parked until a worker admits it
+        bool enqueue(const std::shared_ptr<KeyRequest>& request, bool blocking);
+
+        template <typename T>
+        std::future<T> submitFuture(KeyOperation operation, const SPHINXPubKey* publicKey, std::stop_token stopToken);
+
+        // Function to take a waiting request out of the service and complete it with operation_canceled (its stop callback)
+        void cancel(KeyRequest& request);
+
+        // Function to hand a completed request back to its caller, through the executor for a coroutine if there is one
+        void finish(const std::shared_ptr<KeyRequest>& request);
+
+        void workerLoop();
+        void runBatch(std::vector<std::shared_ptr<KeyRequest>>& batch);
+
+        const KeyServiceOptions options_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable work_;
+        std::condition_variable space_;
+        std::deque<std::shared_ptr<KeyRequest>> queue_;
+        std::deque<std::shared_ptr<KeyRequest>> parked_;
+        bool stopping_ = false;
+
+        std::atomic<uint64_t> completed_{0};
+        std::atomic<uint64_t> cancelled_{0};
+        std::atomic<uint64_t> batches_{0};
+        std::atomic<uint64_t> rejected_{0};
+        std::vector<std::thread> workers_;
+    };
+
+    template <typename T>
+    bool KeyTask<T>::await_suspend(std::coroutine_handle<> handle) {
+        request_->continuation = handle;
+        return service_->enqueue(request_, false);
+    }
+} // namespace SPHINXKey
+
+#endif // SPHINX_KEY_SERVICE_HPP
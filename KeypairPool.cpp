@@ -0,0 +1,190 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code implements KeypairPool, which pre-generates hybrid key pairs in the background so that callers do not pay the Curve448 and Kyber1024 key generation latency.
+
+// KeypairPool:
+    // A fixed number of worker threads call the generator (generate_hybrid_keypair by default) and publish the key pairs into a ring of depth slots.
+    // The ring is a bounded multi-producer multi-consumer queue: each slot carries a sequence number, and producers and consumers claim positions with a compare-and-swap on their own counter, so no lock is taken on either side.
+    // When the ring is full, workers sleep on the hand-off counter (std::atomic wait) and resume as soon as a key pair is taken.
+    // The ring is allocated with SecureAllocator (SecureArena.hpp), so the waiting key pairs are locked in RAM and never written to swap.
+
+// acquire Function:
+    // Takes the oldest ready key pair in constant time, or returns std::nullopt when the ring is empty and records an empty hit.
+    // The slot is zeroized as soon as the key pair has been copied out, so secret key material never outlives its hand-off inside the pool.
+    // acquireOrGenerate falls back to generating on the calling thread when the pool is empty.
+
+// metrics Function:
+    // Reports the number of key pairs generated and handed out, the empty hits, the key pairs currently ready and the refill rate (key pairs generated per second since the pool started).
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <algorithm>
+#include <functional>
+
+#include "KeypairPool.hpp"
+#include "SecureArena.hpp"
+
+
+namespace SPHINXKey {
+
+    // Function to overwrite every secret field of a key pair with zeros
+    void wipeKeypair(SPHINXHybridKey::HybridKeypair& keypair) {
+        secureZero(keypair.merged_key.sphinxPrivKey.data(), keypair.merged_key.sphinxPrivKey.size());
+        secureZero(keypair.merged_key.sphinxPubKey.data(), keypair.merged_key.sphinxPubKey.size());
+        secureZero(keypair.public_key_pke.data(), keypair.public_key_pke.size());
+        secureZero(keypair.secret_key_pke.data(), keypair.secret_key_pke.size());
+        secureZero(keypair.shared_secret.data(), keypair.shared_secret.size());
+        keypair.shared_secret.clear();
+    }
+
+    // Function to start the pool
+    KeypairPool::KeypairPool(size_t depth, size_t workerCount, Generator generate)
+        : depth_(std::max<size_t>(1, depth)),
+          slots_(depth_),
+          generate_(std::move(generate)),
+          started_(std::chrono::steady_clock::now()) {
+        // Slot i is first written by the producer that claims position i
+        for (size_t i = 0; i < depth_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        workerCount = std::max<size_t>(1, workerCount);
+        workers_.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; ++i) {
+            workers_.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    KeypairPool::~KeypairPool() {
+        stopping_.store(true, std::memory_order_release);
+        consumed_.fetch_add(1, std::memory_order_release);
+        consumed_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+
+        // Key pairs nobody took are wiped with the pool
+        for (size_t i = 0; i < depth_; ++i) {
+            wipeKeypair(slots_[i].keypair);
+        }
+    }
+
+    bool KeypairPool::tryPush(const SPHINXHybridKey::HybridKeypair& keypair) {
+        uint64_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[pos % depth_];
+            const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const int64_t diff = static_cast<int64_t>(sequence - pos);
+            if (diff == 0) {
+                // The slot is free for this position, claim the position
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.keypair = keypair;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // The slot still holds a key pair from the previous lap: the ring is full
+                return false;
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool KeypairPool::tryPop(SPHINXHybridKey::HybridKeypair& keypair) {
+        uint64_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[pos % depth_];
+            const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const int64_t diff = static_cast<int64_t>(sequence - (pos + 1));
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    // Copy out, then zeroize the slot before handing it back to the producers for the next lap
+                    keypair = slot.keypair;
+                    wipeKeypair(slot.keypair);
+                    slot.sequence.store(pos + depth_, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // No key pair has been published at this position yet: the ring is empty
+                return false;
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void KeypairPool::workerLoop() {
+        SPHINXHybridKey::HybridKeypair keypair;
+        while (!stopping_.load(std::memory_order_acquire)) {
+            keypair = generate_();
+            generated_.fetch_add(1, std::memory_order_relaxed);
+
+            // Sleep while the ring is full; a hand-off or shutdown changes consumed_ and wakes us
+            for (;;) {
+                const uint64_t seen = consumed_.load(std::memory_order_acquire);
+                if (tryPush(keypair) || stopping_.load(std::memory_order_acquire)) {
+                    break;
+                }
+                consumed_.wait(seen, std::memory_order_acquire);
+            }
+            wipeKeypair(keypair);
+        }
+    }
+
+    // Function to take a ready key pair in constant time
+    std::optional<SPHINXHybridKey::HybridKeypair> KeypairPool::acquire() {
+        std::optional<SPHINXHybridKey::HybridKeypair> keypair(std::in_place);
+        if (!tryPop(*keypair)) {
+            emptyHits_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        consumed_.fetch_add(1, std::memory_order_release);
+        consumed_.notify_one();
+        return keypair;
+    }
+
+    // Function to take a ready key pair, generating one on the calling thread if the pool is empty
+    SPHINXHybridKey::HybridKeypair KeypairPool::acquireOrGenerate() {
+        if (auto keypair = acquire()) {
+            return std::move(*keypair);
+        }
+        return generate_();
+    }
+
+    // Function to return a snapshot of the pool counters
+    KeypairPoolMetrics KeypairPool::metrics() const {
+        KeypairPoolMetrics metrics;
+        metrics.generated = generated_.load(std::memory_order_relaxed);
+        metrics.acquired = consumed_.load(std::memory_order_relaxed);
+        metrics.emptyHits = emptyHits_.load(std::memory_order_relaxed);
+
+        const uint64_t enqueued = enqueuePos_.load(std::memory_order_acquire);
+        const uint64_t dequeued = dequeuePos_.load(std::memory_order_acquire);
+        metrics.ready = static_cast<size_t>(enqueued > dequeued ? enqueued - dequeued : 0);
+
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count();
+        metrics.refillRate = seconds > 0.0 ? static_cast<double>(metrics.generated) / seconds : 0.0;
+        return metrics;
+    }
+} // namespace SPHINXKey
@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+#ifndef SPHINX_KEYPAIR_POOL_HPP
+#define SPHINX_KEYPAIR_POOL_HPP
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <functional>
+
+#include "Key.hpp"
+#include "SecureArena.hpp"
+
+namespace SPHINXKey {
+
+    // Counters reported by KeypairPool::metrics
+    struct KeypairPoolMetrics {
+        uint64_t generated = 0;    // Key pairs produced by the workers since the pool started
+        uint64_t acquired = 0;     // Key pairs handed out from the ring
+        uint64_t emptyHits = 0;    // Calls that found the ring empty
+        size_t ready = 0;          // Key pairs currently waiting in the ring
+        double refillRate = 0.0;   // Key pairs produced per second since the pool started
+    };
+
+    // Pool of hybrid key pairs generated ahead of time by background workers
+    // Ready key pairs wait in a fixed-size lock-free ring; a slot is zeroized as soon as its key pair is handed out
+    class KeypairPool {
+    public:
+        using Generator = std::function<SPHINXHybridKey::HybridKeypair()>;
+
+        // Function to start the pool: workerCount threads keep up to depth key pairs ready
+        // generate defaults to generate_hybrid_keypair
+        explicit KeypairPool(size_t depth, size_t workerCount = 1, Generator generate = generate_hybrid_keypair);
+        ~KeypairPool();
+
+        KeypairPool(const KeypairPool&) = delete;
+        KeypairPool& operator=(const KeypairPool&) = delete;
+
+        // Function to take a ready key pair in constant time, returns std::nullopt (and counts an empty hit) if none is ready
+        std::optional<SPHINXHybridKey::HybridKeypair> acquire();
+
+        // Function to take a ready key pair, generating one on the calling thread if the pool is empty
+        SPHINXHybridKey::HybridKeypair acquireOrGenerate();
+
+        // Function to return the number of slots in the ring
+        size_t depth() const { return depth_; }
+
+        // Function to return a snapshot of the pool counters
+        KeypairPoolMetrics metrics() const;
+
+    private:
+        // One ring slot; sequence tells producers and consumers whose turn the slot is (bounded MPMC queue)
+        struct alignas(64) Slot {
+            std::atomic<uint64_t> sequence{0};
+            SPHINXHybridKey::HybridKeypair keypair;
+        };
+
+        bool tryPush(const SPHINXHybridKey::HybridKeypair& keypair);
+        bool tryPop(SPHINXHybridKey::HybridKeypair& keypair);
+        void workerLoop();
+
+        const size_t depth_;
+        std::vector<Slot, SecureAllocator<Slot>> slots_;    // Locked in RAM and zeroized on release (SecureArena.hpp)
+        Generator generate_;
+
+        alignas(64) std::atomic<uint64_t> enqueuePos_{0};
+        alignas(64) std::atomic<uint64_t> dequeuePos_{0};
+
+        // Bumped on every hand-off, workers blocked on a full ring wait for it to change
+        alignas(64) std::atomic<uint64_t> consumed_{0};
+        std::atomic<bool> stopping_{false};
+
+        std::atomic<uint64_t> generated_{0};
+        std::atomic<uint64_t> emptyHits_{0};
+        const std::chrono::steady_clock::time_point started_;
+        std::vector<std::thread> workers_;
+    };
+
+    // Function to overwrite every secret field of a key pair with zeros
+    void wipeKeypair(SPHINXHybridKey::HybridKeypair& keypair);
+} // namespace SPHINXKey
+
+#endif // SPHINX_KEYPAIR_POOL_HPP
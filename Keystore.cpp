@@ -0,0 +1,589 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code implements the SPHINXKey keystore: a binary file of fixed-stride key pair records that is opened with mmap.
+
+// File layout:
+    // [0, 4096): two 2048-byte header slots. A header holds the magic, format version, byte order, the key sizes the file was written with
+    // (SPHINX_256_DIGEST_SIZE, KYBER1024_PKE_*, ADDRESS_MAX_LENGTH), a generation counter, the record capacity and count, and the location of the address index runs.
+    // The header also stores how many records the index covers: an address hash that repeats is indexed once (for its first record), so the entry count can be lower.
+    // Headers are written alternately to the two slots with a checksum, and open() uses the valid slot with the highest generation, so a torn header write falls back to the previous one.
+    // The checksum can be recomputed for a crafted file, so the capacity, counts and run locations are bounded by the file size before they are used.
+    // [4096, 4096 + capacity * KEYSTORE_RECORD_STRIDE): record slots. A KeystoreRecord holds the merged key pair, the Kyber1024 PKE key pair, the address and its RIPEMD-160 hash, and a checksum.
+    // After the record slots: the address index, up to KEYSTORE_MAX_RUNS page-aligned runs of 32-byte entries (address hash, record number), each sorted by address hash.
+    // Runs are kept in file order, oldest first, and each is more than twice the size of the next, so there are about log2(records / 4096) of them.
+    // Integers are stored in the writer's byte order; a file written on a machine of the other byte order is rejected.
+
+// open Function:
+    // Reads the headers, checks that the key sizes match this build, and maps the file read-only; records, public keys and addresses are then read in place.
+    // Only the records appended since the index was last written are scanned and indexed in memory. A header never leaves more than KEYSTORE_MAX_UNINDEXED of them
+    // (valid() rejects one that does), so opening takes the same few milliseconds for any keystore size.
+
+// append Function:
+    // Writes the new records into free slots past the committed count and syncs them, then commits a header with the new count and syncs it.
+    // Records past the committed count are ignored by open(), so a crash at any point leaves either the old or the new keystore.
+    // If the new records would leave more than KEYSTORE_MAX_UNINDEXED records unindexed, their index run is written first and committed in the same header as the new count.
+    // When the slots run out the capacity doubles; the runs are first merged into one run past the new record area and committed together with the new capacity.
+
+// flushIndex Function:
+    // Writes the in-memory tail as a new sorted run, merging it with the newest runs while the older run is at most twice the merged size (a size-tiered merge),
+    // so each index entry is rewritten O(log records) times and loading N records writes O(N log N) index bytes rather than O(N^2).
+    // A merged run that would overlap a run the current header points to is written past the end first and committed, then copied down and committed again, so the file does not grow with dead runs.
+
+// findByAddress Function:
+    // Decodes the Base58Check address to its RIPEMD-160 hash, binary-searches the mapped index and then checks the in-memory tail.
+
+// The keystore stores the private keys unencrypted; protecting the file (permissions are 0600, disk encryption) is left to the caller.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <span>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Key.hpp"
+#include "Hasher.hpp"
+#include "Keystore.hpp"
+#include "SecureArena.hpp"
+
+
+namespace SPHINXKey {
+
+    namespace {
+        constexpr std::array<char, 8> KEYSTORE_MAGIC = {'S', 'P', 'H', 'X', 'K', 'E', 'Y', 'S'};
+        constexpr uint32_t KEYSTORE_FORMAT_VERSION = 1;
+        constexpr uint32_t KEYSTORE_BYTE_ORDER = 0x01020304;
+        constexpr size_t KEYSTORE_HEADER_SLOT_SIZE = 2048;
+        constexpr size_t KEYSTORE_DATA_OFFSET = 2 * KEYSTORE_HEADER_SLOT_SIZE;
+        constexpr size_t KEYSTORE_PAGE_SIZE = 4096;
+
+        // Records appended after the last index write that open() indexes in memory; append writes an index run before a header would leave more
+        constexpr size_t KEYSTORE_MAX_UNINDEXED = 4096;
+
+        // Index runs a header can point to; the size-tiered merge keeps far fewer
+        constexpr size_t KEYSTORE_MAX_RUNS = 64;
+
+        size_t roundUpToPage(size_t offset) {
+            return (offset + KEYSTORE_PAGE_SIZE - 1) / KEYSTORE_PAGE_SIZE * KEYSTORE_PAGE_SIZE;
+        }
+
+        [[noreturn]] void throwSystemError(const char* what) {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        void writeAll(int fd, const void* data, size_t length, size_t offset) {
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            while (length > 0) {
+                const ssize_t written = ::pwrite(fd, p, length, static_cast<off_t>(offset));
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throwSystemError("Keystore: write failed");
+                }
+                p += written;
+                offset += static_cast<size_t>(written);
+                length -= static_cast<size_t>(written);
+            }
+        }
+
+        void syncFile(int fd) {
+#if defined(__APPLE__)
+            const int result = ::fsync(fd);
+#else
+            const int result = ::fdatasync(fd);
+#endif
+            if (result != 0) {
+                throwSystemError("Keystore: sync failed");
+            }
+        }
+
+        // First 8 bytes of SPHINX_256 over the given bytes
+        std::array<unsigned char, 8> checksum8(const void* data, size_t length) {
+            const SPHINXHash::SPHINX256Digest digest = SPHINXHash::SPHINX_256(std::span<const unsigned char>(static_cast<const unsigned char*>(data), length));
+            std::array<unsigned char, 8> checksum;
+            std::copy_n(digest.begin(), checksum.size(), checksum.begin());
+            return checksum;
+        }
+
+        bool lessHash(const SPHINXHash::RIPEMD160Digest& a, const SPHINXHash::RIPEMD160Digest& b) {
+            return std::memcmp(a.data(), b.data(), a.size()) < 0;
+        }
+
+        // Wipes a buffer of key material when it goes out of scope, on the exception path as well
+        struct WipeOnExit {
+            void* data;
+            size_t length;
+
+            ~WipeOnExit() { secureZero(data, length); }
+        };
+    } // namespace
+
+    // Address index entry
+    struct Keystore::IndexEntry {
+        SPHINXHash::RIPEMD160Digest addressHash;
+        std::array<unsigned char, 4> reserved;
+        uint64_t record;
+    };
+
+    // Header slot contents
+    struct Keystore::Header {
+        std::array<char, 8> magic;
+        uint32_t formatVersion;
+        uint32_t byteOrder;
+        uint32_t recordSize;
+        uint32_t recordStride;
+        uint32_t sphinxKeySize;
+        uint32_t pkePublicKeySize;
+        uint32_t pkePrivateKeySize;
+        uint32_t addressMaxLength;
+        uint64_t generation;
+        uint64_t capacity;
+        uint64_t recordCount;
+        uint64_t indexedRecords;                 // Records [0, indexedRecords) are covered by the index
+        uint64_t runCount;
+        std::array<IndexRun, KEYSTORE_MAX_RUNS> runs;
+        std::array<unsigned char, 8> checksum;   // Over the fields above
+
+        // Whether the header is intact, written with this build's sizes, and everything it points to lies in fileSize bytes
+        // Every bound divides rather than multiplies, so a crafted header cannot wrap an offset back into the mapping
+        bool valid(size_t fileSize) const {
+            if (!(magic == KEYSTORE_MAGIC && formatVersion == KEYSTORE_FORMAT_VERSION && byteOrder == KEYSTORE_BYTE_ORDER &&
+                  recordSize == KEYSTORE_RECORD_SIZE && recordStride == KEYSTORE_RECORD_STRIDE &&
+                  sphinxKeySize == SPHINX_256_DIGEST_SIZE && pkePublicKeySize == KYBER1024_PKE_PUBLIC_KEY_LENGTH &&
+                  pkePrivateKeySize == KYBER1024_PKE_PRIVATE_KEY_LENGTH && addressMaxLength == ADDRESS_MAX_LENGTH &&
+                  checksum == checksum8(this, offsetof(Header, checksum)))) {
+                return false;
+            }
+            if (fileSize < KEYSTORE_DATA_OFFSET || capacity > (fileSize - KEYSTORE_DATA_OFFSET) / KEYSTORE_RECORD_STRIDE ||
+                recordCount > capacity || indexedRecords > recordCount || recordCount - indexedRecords > KEYSTORE_MAX_UNINDEXED || runCount > KEYSTORE_MAX_RUNS) {
+                return false;
+            }
+
+            // Runs lie past the record slots, in file order, without overlapping
+            uint64_t end = roundUpToPage(KEYSTORE_DATA_OFFSET + capacity * KEYSTORE_RECORD_STRIDE);
+            uint64_t entries = 0;
+            for (size_t i = 0; i < runCount; ++i) {
+                const IndexRun& run = runs[i];
+                if (run.offset % KEYSTORE_PAGE_SIZE != 0 || run.offset < end || run.offset > fileSize || run.count > (fileSize - run.offset) / sizeof(IndexEntry)) {
+                    return false;
+                }
+                end = run.offset + run.count * sizeof(IndexEntry);
+                entries += run.count;
+            }
+            return entries <= indexedRecords;
+        }
+    };
+
+    size_t Keystore::DigestHash::operator()(const SPHINXHash::RIPEMD160Digest& digest) const {
+        // The digest is uniformly distributed, so its first bytes are a good hash
+        size_t value;
+        std::memcpy(&value, digest.data(), sizeof(value));
+        return value;
+    }
+
+    // Function to create a new keystore file
+    Keystore Keystore::create(const std::string& path, size_t initialCapacity) {
+        Keystore keystore;
+        keystore.fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (keystore.fd_ < 0) {
+            throwSystemError("Keystore: cannot create file");
+        }
+        keystore.writable_ = true;
+        const size_t capacity = std::max<size_t>(1, initialCapacity);
+        if (capacity > (SIZE_MAX - 2 * KEYSTORE_PAGE_SIZE) / KEYSTORE_RECORD_STRIDE) {
+            throw std::length_error("Keystore: capacity too large");
+        }
+
+        // Size the file up to the index (sparse), so appends within the capacity never change the mapping
+        if (::ftruncate(keystore.fd_, static_cast<off_t>(roundUpToPage(keystore.recordOffset(capacity)))) != 0) {
+            throwSystemError("Keystore: cannot size file");
+        }
+        keystore.commitHeader(capacity, 0, 0, {});
+        keystore.capacity_ = capacity;
+        keystore.remap();
+        return keystore;
+    }
+
+    // Function to open an existing keystore
+    Keystore Keystore::open(const std::string& path, bool writable) {
+        Keystore keystore;
+        keystore.fd_ = ::open(path.c_str(), (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+        if (keystore.fd_ < 0) {
+            throwSystemError("Keystore: cannot open file");
+        }
+        keystore.writable_ = writable;
+
+        // Step 1: Map the file, a file too small for the header slots is not a keystore
+        struct stat info;
+        if (::fstat(keystore.fd_, &info) != 0) {
+            throwSystemError("Keystore: cannot stat file");
+        }
+        if (static_cast<size_t>(info.st_size) < KEYSTORE_DATA_OFFSET) {
+            throw std::runtime_error("Keystore: not a keystore or written with different key sizes");
+        }
+        keystore.remap();
+
+        // Step 2: Use the valid header slot with the highest generation; valid() checks that everything it points to is inside the mapping
+        std::optional<Header> current;
+        for (size_t slot = 0; slot < 2; ++slot) {
+            Header header;
+            std::memcpy(&header, keystore.map_ + slot * KEYSTORE_HEADER_SLOT_SIZE, sizeof(header));
+            if (header.valid(keystore.mapSize_) && (!current || header.generation > current->generation)) {
+                current = header;
+            }
+        }
+        if (!current) {
+            throw std::runtime_error("Keystore: not a keystore, corrupted, or written with different key sizes");
+        }
+        keystore.generation_ = current->generation;
+        keystore.capacity_ = current->capacity;
+        keystore.recordCount_ = current->recordCount;
+        keystore.indexedRecords_ = current->indexedRecords;
+        keystore.runs_.assign(current->runs.begin(), current->runs.begin() + current->runCount);
+
+        // Step 3: Index the records appended since the last index write (at most KEYSTORE_MAX_UNINDEXED)
+        for (size_t i = keystore.indexedRecords_; i < keystore.recordCount_; ++i) {
+            if (!keystore.verify(i)) {
+                throw std::runtime_error("Keystore: record checksum mismatch");
+            }
+            const SPHINXHash::RIPEMD160Digest& addressHash = keystore.record(i).addressHash;
+            if (!keystore.findByAddressHash(addressHash)) {
+                keystore.tail_.emplace(addressHash, i);
+            }
+        }
+        return keystore;
+    }
+
+    Keystore::Keystore(Keystore&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    Keystore& Keystore::operator=(Keystore&& other) noexcept {
+        // Swap, so other releases this keystore's mapping and file when it is destroyed
+        std::swap(fd_, other.fd_);
+        std::swap(writable_, other.writable_);
+        std::swap(map_, other.map_);
+        std::swap(mapSize_, other.mapSize_);
+        std::swap(generation_, other.generation_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(recordCount_, other.recordCount_);
+        std::swap(indexedRecords_, other.indexedRecords_);
+        std::swap(runs_, other.runs_);
+        std::swap(tail_, other.tail_);
+        return *this;
+    }
+
+    Keystore::~Keystore() {
+        if (map_ != nullptr) {
+            ::munmap(map_, mapSize_);
+            map_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    size_t Keystore::recordOffset(size_t index) const {
+        return KEYSTORE_DATA_OFFSET + index * KEYSTORE_RECORD_STRIDE;
+    }
+
+    void Keystore::commitHeader(uint64_t capacity, uint64_t recordCount, uint64_t indexedRecords, std::span<const IndexRun> runs) {
+        static_assert(sizeof(Header) <= KEYSTORE_HEADER_SLOT_SIZE, "Keystore header must fit its slot");
+
+        Header header{};
+        header.magic = KEYSTORE_MAGIC;
+        header.formatVersion = KEYSTORE_FORMAT_VERSION;
+        header.byteOrder = KEYSTORE_BYTE_ORDER;
+        header.recordSize = KEYSTORE_RECORD_SIZE;
+        header.recordStride = KEYSTORE_RECORD_STRIDE;
+        header.sphinxKeySize = SPHINX_256_DIGEST_SIZE;
+        header.pkePublicKeySize = KYBER1024_PKE_PUBLIC_KEY_LENGTH;
+        header.pkePrivateKeySize = KYBER1024_PKE_PRIVATE_KEY_LENGTH;
+        header.addressMaxLength = ADDRESS_MAX_LENGTH;
+        header.generation = generation_ + 1;
+        header.capacity = capacity;
+        header.recordCount = recordCount;
+        header.indexedRecords = indexedRecords;
+        header.runCount = runs.size();
+        std::copy(runs.begin(), runs.end(), header.runs.begin());
+        header.checksum = checksum8(&header, offsetof(Header, checksum));
+
+        // Overwrite the older slot, the newer one stays intact until this write is synced
+        writeAll(fd_, &header, sizeof(header), (header.generation % 2) * KEYSTORE_HEADER_SLOT_SIZE);
+        syncFile(fd_);
+        generation_ = header.generation;
+    }
+
+    void Keystore::remap() {
+        if (map_ != nullptr) {
+            ::munmap(map_, mapSize_);
+            map_ = nullptr;
+            mapSize_ = 0;
+        }
+        struct stat info;
+        if (::fstat(fd_, &info) != 0) {
+            throwSystemError("Keystore: cannot stat file");
+        }
+        mapSize_ = static_cast<size_t>(info.st_size);
+        void* mapping = ::mmap(nullptr, mapSize_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (mapping == MAP_FAILED) {
+            mapSize_ = 0;
+            throwSystemError("Keystore: mmap failed");
+        }
+        map_ = static_cast<unsigned char*>(mapping);
+    }
+
+    const Keystore::IndexEntry* Keystore::runBegin(const IndexRun& run) const {
+        return reinterpret_cast<const IndexEntry*>(map_ + run.offset);
+    }
+
+    // Function to read a record in place
+    const KeystoreRecord& Keystore::record(size_t index) const {
+        if (index >= recordCount_) {
+            throw std::out_of_range("Keystore: record index out of range");
+        }
+        return *reinterpret_cast<const KeystoreRecord*>(map_ + recordOffset(index));
+    }
+
+    // Function to copy a record out as a HybridKeypair
+    SPHINXHybridKey::HybridKeypair Keystore::keypair(size_t index) const {
+        const KeystoreRecord& r = record(index);
+        SPHINXHybridKey::HybridKeypair keypair;
+        keypair.merged_key.sphinxPrivKey = r.sphinxPrivKey;
+        keypair.merged_key.sphinxPubKey = r.sphinxPubKey;
+        keypair.public_key_pke = r.publicKeyPke;
+        keypair.secret_key_pke = r.secretKeyPke;
+        return keypair;
+    }
+
+    // Function to check a record against its checksum
+    bool Keystore::verify(size_t index) const {
+        const KeystoreRecord& r = record(index);
+        return checksum8(&r, offsetof(KeystoreRecord, checksum)) == r.checksum;
+    }
+
+    // Function to find the record of an address hash
+    std::optional<size_t> Keystore::findByAddressHash(const SPHINXHash::RIPEMD160Digest& addressHash) const {
+        // Runs never share a hash, so the first match is the only one
+        for (const IndexRun& run : runs_) {
+            const IndexEntry* begin = runBegin(run);
+            const IndexEntry* end = begin + run.count;
+            const IndexEntry* found = std::lower_bound(begin, end, addressHash, [](const IndexEntry& entry, const SPHINXHash::RIPEMD160Digest& hash) {
+                return lessHash(entry.addressHash, hash);
+            });
+            if (found != end && found->addressHash == addressHash) {
+                return static_cast<size_t>(found->record);
+            }
+        }
+        const auto tail = tail_.find(addressHash);
+        if (tail != tail_.end()) {
+            return tail->second;
+        }
+        return std::nullopt;
+    }
+
+    // Function to find the record of an address
+    std::optional<size_t> Keystore::findByAddress(std::string_view address) const {
+        std::vector<unsigned char> payload;
+        if (!DecodeBase58Check(std::string(address), payload) || payload.size() != 1 + RIPEMD_160_DIGEST_SIZE || payload[0] != ADDRESS_VERSION_BYTE) {
+            return std::nullopt;
+        }
+        SPHINXHash::RIPEMD160Digest addressHash;
+        std::copy(payload.begin() + 1, payload.end(), addressHash.begin());
+        return findByAddressHash(addressHash);
+    }
+
+    // Function to append key pairs
+    void Keystore::append(std::span<const SPHINXHybridKey::HybridKeypair> keypairs) {
+        if (!writable_) {
+            throw std::logic_error("Keystore: opened read-only");
+        }
+        if (keypairs.empty()) {
+            return;
+        }
+        if (recordCount_ + keypairs.size() > capacity_) {
+            grow(std::max<size_t>(2 * capacity_, recordCount_ + keypairs.size()));
+        }
+
+        // Step 1: Build the records, deriving the addresses in one batch
+        std::vector<SPHINXPubKey> publicKeys(keypairs.size());
+        for (size_t i = 0; i < keypairs.size(); ++i) {
+            publicKeys[i] = keypairs[i].merged_key.sphinxPubKey;
+        }
+        std::vector<SPHINXAddress> addresses(keypairs.size());
+        generateAddresses(publicKeys, "", addresses);
+
+        // The staging buffer and record hold private keys; both are wiped however this function exits
+        std::vector<unsigned char> buffer(keypairs.size() * KEYSTORE_RECORD_STRIDE, 0);
+        const WipeOnExit wipeBuffer{buffer.data(), buffer.size()};
+        KeystoreRecord record;
+        const WipeOnExit wipeRecord{&record, sizeof(record)};
+        for (size_t i = 0; i < keypairs.size(); ++i) {
+            record = KeystoreRecord{};
+            record.sphinxPubKey = keypairs[i].merged_key.sphinxPubKey;
+            record.sphinxPrivKey = keypairs[i].merged_key.sphinxPrivKey;
+            record.publicKeyPke = keypairs[i].public_key_pke;
+            record.secretKeyPke = keypairs[i].secret_key_pke;
+            record.addressHash = SPHINXHash::RIPEMD_160(SPHINXHash::SPHINX_256(record.sphinxPubKey));
+            std::copy_n(addresses[i].chars.begin(), addresses[i].length, record.address.begin());
+            record.addressLength = static_cast<uint8_t>(addresses[i].length);
+            record.checksum = checksum8(&record, offsetof(KeystoreRecord, checksum));
+            std::memcpy(buffer.data() + i * KEYSTORE_RECORD_STRIDE, &record, sizeof(record));
+        }
+
+        // Step 2: Write the records past the committed count and make them durable
+        writeAll(fd_, buffer.data(), buffer.size(), recordOffset(recordCount_));
+        syncFile(fd_);
+
+        // Step 3: Collect the address hashes that have no record yet, a repeated hash keeps its first record
+        TailMap added;
+        for (size_t i = 0; i < keypairs.size(); ++i) {
+            const SPHINXHash::RIPEMD160Digest& addressHash = reinterpret_cast<const KeystoreRecord*>(buffer.data() + i * KEYSTORE_RECORD_STRIDE)->addressHash;
+            if (!findByAddressHash(addressHash)) {
+                added.emplace(addressHash, recordCount_ + i);
+            }
+        }
+
+        // Step 4: Commit the new count, the records become visible to open() only now
+        // Past KEYSTORE_MAX_UNINDEXED unindexed records, the index run is written first and committed in the same header
+        const size_t recordCount = recordCount_ + keypairs.size();
+        if (recordCount - indexedRecords_ > KEYSTORE_MAX_UNINDEXED) {
+            writeIndex(capacity_, recordCount, added, false);
+            return;
+        }
+        commitHeader(capacity_, recordCount, indexedRecords_, runs_);
+        recordCount_ = recordCount;
+        tail_.merge(added);
+    }
+
+    void Keystore::grow(size_t capacity) {
+        // The index lives right after the record slots, so it has to move before the slots can be extended over it
+        if (capacity > (SIZE_MAX - 2 * KEYSTORE_PAGE_SIZE) / KEYSTORE_RECORD_STRIDE) {
+            throw std::length_error("Keystore: capacity too large");
+        }
+        writeIndex(capacity, recordCount_, {}, true);
+    }
+
+    // Function to write the address index so it covers every record
+    void Keystore::flushIndex() {
+        if (!writable_) {
+            throw std::logic_error("Keystore: opened read-only");
+        }
+        writeIndex(capacity_, recordCount_, {}, false);
+    }
+
+    // Write tail_ and added as a new run, merged with the newest runs (all of them if mergeAll), and commit it with the given capacity and count
+    // The members only change once a header describing them is durable, so a failed write leaves the keystore as it was
+    void Keystore::writeIndex(size_t capacity, size_t recordCount, const TailMap& added, bool mergeAll) {
+        const auto less = [](const IndexEntry& a, const IndexEntry& b) { return lessHash(a.addressHash, b.addressHash); };
+
+        // Step 1: Sort the unindexed entries
+        std::vector<IndexEntry> tail;
+        tail.reserve(tail_.size() + added.size());
+        const auto collect = [&tail](const TailMap& map) {
+            for (const auto& [hash, index] : map) {
+                tail.push_back(IndexEntry{hash, {}, index});
+            }
+        };
+        collect(tail_);
+        collect(added);
+        std::sort(tail.begin(), tail.end(), less);
+
+        // Step 2: Pick the newest runs to merge: while the older run is at most twice the merged size, and always enough to stay within KEYSTORE_MAX_RUNS
+        size_t kept = runs_.size();
+        size_t mergedCount = tail.size();
+        while (kept > 0 && (mergeAll || runs_[kept - 1].count <= 2 * mergedCount || kept + 1 > KEYSTORE_MAX_RUNS)) {
+            --kept;
+            mergedCount += runs_[kept].count;
+        }
+
+        std::vector<IndexEntry> entries;
+        entries.reserve(mergedCount);
+        for (size_t r = kept; r < runs_.size(); ++r) {
+            const size_t middle = entries.size();
+            entries.insert(entries.end(), runBegin(runs_[r]), runBegin(runs_[r]) + runs_[r].count);
+            std::inplace_merge(entries.begin(), entries.begin() + middle, entries.end(), less);
+        }
+        const size_t middle = entries.size();
+        entries.insert(entries.end(), tail.begin(), tail.end());
+        std::inplace_merge(entries.begin(), entries.begin() + middle, entries.end(), less);
+
+        // Step 3: The merged run belongs right after the kept runs (or the record slots); if that overlaps a run the current header
+        // points to, it is first written past everything and committed there
+        const size_t base = roundUpToPage(recordOffset(capacity));
+        const size_t liveEnd = runs_.empty() ? base : runs_.back().offset + runs_.back().count * sizeof(IndexEntry);
+        const size_t start = kept == 0 ? base : roundUpToPage(runs_[kept - 1].offset + runs_[kept - 1].count * sizeof(IndexEntry));
+        const size_t bytes = entries.size() * sizeof(IndexEntry);
+        const bool overlaps = kept < runs_.size() && start < liveEnd;
+        const size_t offset = overlaps ? roundUpToPage(std::max(liveEnd, start + bytes)) : start;
+
+        std::vector<IndexRun> runs(runs_.begin(), runs_.begin() + kept);
+        if (!entries.empty()) {
+            runs.push_back(IndexRun{offset, entries.size()});
+        }
+        const size_t end = runs.empty() ? base : std::max(base, runs.back().offset + runs.back().count * sizeof(IndexEntry));
+
+        // Step 4: Write the run, size the file to cover the record slots and the run, make both durable and commit the header
+        if (bytes > 0) {
+            writeAll(fd_, entries.data(), bytes, offset);
+        }
+        if (mapSize_ < end && ::ftruncate(fd_, static_cast<off_t>(end)) != 0) {
+            throwSystemError("Keystore: cannot size file");
+        }
+        syncFile(fd_);
+        commitHeader(capacity, recordCount, recordCount, runs);
+        capacity_ = capacity;
+        recordCount_ = recordCount;
+        indexedRecords_ = recordCount;
+        runs_ = std::move(runs);
+        tail_.clear();
+        remap();
+
+        // Step 5: Copy a run written past the end down to its place; the header committed above keeps pointing at the first copy until this one is durable
+        if (overlaps) {
+            writeAll(fd_, entries.data(), bytes, start);
+            syncFile(fd_);
+            std::vector<IndexRun> moved = runs_;
+            moved.back().offset = start;
+            commitHeader(capacity_, recordCount_, indexedRecords_, moved);
+            runs_ = std::move(moved);
+        }
+
+        // Step 6: Drop whatever lies past the last run
+        const size_t used = runs_.empty() ? base : std::max(base, runs_.back().offset + runs_.back().count * sizeof(IndexEntry));
+        if (used < mapSize_) {
+            if (::ftruncate(fd_, static_cast<off_t>(used)) != 0) {
+                throwSystemError("Keystore: cannot size file");
+            }
+            remap();
+        }
+    }
+} // namespace SPHINXKey
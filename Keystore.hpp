@@ -0,0 +1,138 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+#ifndef SPHINX_KEYSTORE_HPP
+#define SPHINX_KEYSTORE_HPP
+
+#pragma once
+
+#include <span>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+
+#include "Key.hpp"
+#include "Hasher.hpp"
+
+namespace SPHINXKey {
+
+    // On-disk keystore record: one HybridKeypair with its address, followed by a checksum of the preceding bytes
+    // Every field is a byte array, so the record has no padding and can be read in place from the mapped file
+    struct KeystoreRecord {
+        SPHINXPubKey sphinxPubKey;
+        SPHINXPrivKey sphinxPrivKey;
+        KyberPKEPubKey publicKeyPke;
+        KyberPKEPrivKey secretKeyPke;
+        SPHINXHash::RIPEMD160Digest addressHash;   // RIPEMD-160 hash inside the address, the key of the address index
+        std::array<char, ADDRESS_MAX_LENGTH> address;
+        uint8_t addressLength;
+        std::array<unsigned char, 8> checksum;     // First 8 bytes of SPHINX_256 over the fields above
+
+        std::string_view addressView() const { return std::string_view(address.data(), addressLength); }
+    };
+
+    // Record size and stride (records start on 64-byte boundaries)
+    constexpr size_t KEYSTORE_RECORD_SIZE = 2 * SPHINX_256_DIGEST_SIZE + KYBER1024_PKE_PUBLIC_KEY_LENGTH + KYBER1024_PKE_PRIVATE_KEY_LENGTH + RIPEMD_160_DIGEST_SIZE + ADDRESS_MAX_LENGTH + 1 + 8;
+    constexpr size_t KEYSTORE_RECORD_STRIDE = (KEYSTORE_RECORD_SIZE + 63) / 64 * 64;
+    static_assert(sizeof(KeystoreRecord) == KEYSTORE_RECORD_SIZE, "KeystoreRecord must not contain padding");
+
+    // Memory-mapped keystore file
+    // Layout: two header slots (the newest valid one wins), fixed-stride record slots up to the capacity, then the address index
+    // (a few runs of entries sorted by address hash). Records appended since the index was last written are indexed in memory at open
+    class Keystore {
+    public:
+        // Function to create a new keystore file, fails if the file exists
+        static Keystore create(const std::string& path, size_t initialCapacity = 1024);
+
+        // Function to open an existing keystore, writable is required for append and flushIndex
+        static Keystore open(const std::string& path, bool writable = false);
+
+        Keystore(Keystore&& other) noexcept;
+        Keystore& operator=(Keystore&& other) noexcept;
+        ~Keystore();
+
+        Keystore(const Keystore&) = delete;
+        Keystore& operator=(const Keystore&) = delete;
+
+        // Function to return the number of committed records
+        size_t size() const { return recordCount_; }
+
+        // Functions to read a record in place; references and views stay valid until the next append
+        const KeystoreRecord& record(size_t index) const;
+        const SPHINXPubKey& publicKey(size_t index) const { return record(index).sphinxPubKey; }
+        std::string_view address(size_t index) const { return record(index).addressView(); }
+
+        // Function to copy a record out as a HybridKeypair
+        SPHINXHybridKey::HybridKeypair keypair(size_t index) const;
+
+        // Function to check a record against its checksum
+        bool verify(size_t index) const;
+
+        // Functions to find the record of an address, through the sorted index and then the unindexed tail
+        std::optional<size_t> findByAddress(std::string_view address) const;
+        std::optional<size_t> findByAddressHash(const SPHINXHash::RIPEMD160Digest& addressHash) const;
+
+        // Function to append key pairs; they are durable (fsync) and visible to open() once append returns
+        // A crash during append leaves the keystore as it was before the call
+        void append(std::span<const SPHINXHybridKey::HybridKeypair> keypairs);
+
+        // Function to write the address index so it covers every record (append does this on its own before more than a few thousand records are unindexed)
+        void flushIndex();
+
+    private:
+        struct Header;
+        struct IndexEntry;
+
+        // Sorted run of IndexEntry in the file; runs never share an address hash
+        struct IndexRun {
+            uint64_t offset;
+            uint64_t count;
+        };
+
+        struct DigestHash {
+            size_t operator()(const SPHINXHash::RIPEMD160Digest& digest) const;
+        };
+
+        Keystore() = default;
+
+        using TailMap = std::unordered_map<SPHINXHash::RIPEMD160Digest, size_t, DigestHash>;
+
+        void commitHeader(uint64_t capacity, uint64_t recordCount, uint64_t indexedRecords, std::span<const IndexRun> runs);
+        void remap();
+        void grow(size_t capacity);
+        void writeIndex(size_t capacity, size_t recordCount, const TailMap& added, bool mergeAll);
+        const IndexEntry* runBegin(const IndexRun& run) const;
+        size_t recordOffset(size_t index) const;
+
+        int fd_ = -1;
+        bool writable_ = false;
+        unsigned char* map_ = nullptr;
+        size_t mapSize_ = 0;
+
+        uint64_t generation_ = 0;
+        uint64_t capacity_ = 0;
+        uint64_t recordCount_ = 0;
+        uint64_t indexedRecords_ = 0;
+        std::vector<IndexRun> runs_;
+
+        // Records [indexedRecords_, recordCount_) keyed by address hash; a repeated hash keeps its first record
+        TailMap tail_;
+    };
+} // namespace SPHINXKey
+
+#endif // SPHINX_KEYSTORE_HPP
@@ -0,0 +1,139 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+#ifndef SPHINX_PARAMETER_SET_HPP
+#define SPHINX_PARAMETER_SET_HPP
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#include "Hasher.hpp"
+
+namespace SPHINXKey {
+
+    // Kyber parameter sets (CRYSTALS-Kyber round 3): module rank K and ciphertext compression DU / DV
+    // Private key layout: IND-CPA secret key || public key || H(public key) || z
+    template <size_t Rank, size_t Du, size_t Dv, const char* Name>
+    struct KyberParameters {
+        static constexpr size_t K = Rank;
+        static constexpr size_t POLYVEC_BYTES = 384 * K;
+        static constexpr size_t SYMBYTES = 32;
+        static constexpr size_t PUBLIC_KEY_LENGTH = POLYVEC_BYTES + SYMBYTES;
+        static constexpr size_t PRIVATE_KEY_LENGTH = POLYVEC_BYTES + PUBLIC_KEY_LENGTH + 2 * SYMBYTES;
+        static constexpr size_t PUBLIC_KEY_OFFSET = POLYVEC_BYTES;   // Offset of the public key inside the private key
+        static constexpr size_t CIPHERTEXT_LENGTH = (Du * K + Dv) * 256 / 8;
+        static constexpr size_t SHARED_SECRET_LENGTH = SYMBYTES;
+        static constexpr const char* NAME = Name;
+    };
+
+    inline constexpr char KYBER512_NAME[] = "Kyber512";
+    inline constexpr char KYBER768_NAME[] = "Kyber768";
+    inline constexpr char KYBER1024_NAME[] = "Kyber1024";
+
+    using Kyber512 = KyberParameters<2, 10, 4, KYBER512_NAME>;
+    using Kyber768 = KyberParameters<3, 10, 4, KYBER768_NAME>;
+    using Kyber1024 = KyberParameters<4, 11, 5, KYBER1024_NAME>;
+
+    static_assert(Kyber512::PUBLIC_KEY_LENGTH == 800 && Kyber512::PRIVATE_KEY_LENGTH == 1632 && Kyber512::CIPHERTEXT_LENGTH == 768);
+    static_assert(Kyber768::PUBLIC_KEY_LENGTH == 1184 && Kyber768::PRIVATE_KEY_LENGTH == 2400 && Kyber768::CIPHERTEXT_LENGTH == 1088);
+    static_assert(Kyber1024::PUBLIC_KEY_LENGTH == 1568 && Kyber1024::PRIVATE_KEY_LENGTH == 3168 && Kyber1024::CIPHERTEXT_LENGTH == 1568);
+
+    // Montgomery curve Diffie-Hellman parameter sets (RFC 7748)
+    template <size_t KeySize, const char* Name>
+    struct CurveParameters {
+        static constexpr size_t PRIVATE_KEY_SIZE = KeySize;
+        static constexpr size_t PUBLIC_KEY_SIZE = KeySize;
+        static constexpr size_t SHARED_SECRET_SIZE = KeySize;
+        static constexpr const char* NAME = Name;
+    };
+
+    inline constexpr char X25519_NAME[] = "X25519";
+    inline constexpr char X448_NAME[] = "X448";
+
+    using X25519 = CurveParameters<32, X25519_NAME>;
+    using X448 = CurveParameters<56, X448_NAME>;
+
+    // Hybrid parameter set: every size and fixed-size key type of one Kyber / curve combination
+    template <typename Kem, typename Curve>
+    struct HybridParameterSet {
+        using KemParameters = Kem;
+        using CurveParameters = Curve;
+
+        static constexpr size_t CURVE_PRIVATE_KEY_SIZE = Curve::PRIVATE_KEY_SIZE;
+        static constexpr size_t CURVE_PUBLIC_KEY_SIZE = Curve::PUBLIC_KEY_SIZE;
+        static constexpr size_t KEM_PUBLIC_KEY_LENGTH = Kem::PUBLIC_KEY_LENGTH;
+        static constexpr size_t KEM_PRIVATE_KEY_LENGTH = Kem::PRIVATE_KEY_LENGTH;
+        static constexpr size_t KEM_CIPHERTEXT_LENGTH = Kem::CIPHERTEXT_LENGTH;
+
+        // The PKE key pair is a Kyber key pair of the same set
+        static constexpr size_t PKE_PUBLIC_KEY_LENGTH = Kem::PUBLIC_KEY_LENGTH;
+        static constexpr size_t PKE_PRIVATE_KEY_LENGTH = Kem::PRIVATE_KEY_LENGTH;
+
+        // Hybrid ciphertext: the ephemeral curve public key followed by the Kyber ciphertext
+        static constexpr size_t HYBRID_CIPHERTEXT_LENGTH = CURVE_PUBLIC_KEY_SIZE + KEM_CIPHERTEXT_LENGTH;
+
+        // Largest HMAC digest used by the key derivation (HMAC-SHA512)
+        static constexpr size_t HMAC_SIZE = 64;
+
+        // Curve public key + Kyber public key + master private key and chain code (2 * HMAC_SIZE)
+        static constexpr size_t HYBRID_KEYPAIR_LENGTH = CURVE_PUBLIC_KEY_SIZE + KEM_PUBLIC_KEY_LENGTH + 2 * HMAC_SIZE;
+
+        using CurvePrivKey = std::array<unsigned char, CURVE_PRIVATE_KEY_SIZE>;
+        using CurvePubKey = std::array<unsigned char, CURVE_PUBLIC_KEY_SIZE>;
+        using KemPrivKey = std::array<unsigned char, KEM_PRIVATE_KEY_LENGTH>;
+        using KemPubKey = std::array<unsigned char, KEM_PUBLIC_KEY_LENGTH>;
+        using PkePrivKey = std::array<uint8_t, PKE_PRIVATE_KEY_LENGTH>;
+        using PkePubKey = std::array<uint8_t, PKE_PUBLIC_KEY_LENGTH>;
+        using HybridCiphertext = std::array<uint8_t, HYBRID_CIPHERTEXT_LENGTH>;
+    };
+
+    // The six supported combinations; Kyber1024 with X448 is the one SPHINXKey uses by default
+    using Kyber512X25519 = HybridParameterSet<Kyber512, X25519>;
+    using Kyber512X448 = HybridParameterSet<Kyber512, X448>;
+    using Kyber768X25519 = HybridParameterSet<Kyber768, X25519>;
+    using Kyber768X448 = HybridParameterSet<Kyber768, X448>;
+    using Kyber1024X25519 = HybridParameterSet<Kyber1024, X25519>;
+    using Kyber1024X448 = HybridParameterSet<Kyber1024, X448>;
+    using DefaultParameterSet = Kyber1024X448;
+
+    // Function to merge the curve and Kyber private keys of a parameter set into the 32-byte SPHINX private key
+    // Both keys have compile-time sizes, so the hasher runs a fixed number of block compressions with no length checks
+    template <typename Params>
+    SPHINXHash::SPHINX256Digest mergePrivateKeys(const typename Params::CurvePrivKey& curvePrivateKey, const typename Params::KemPrivKey& kemPrivateKey) {
+        SPHINXHash::SPHINX256Hasher hasher;
+        hasher.update(curvePrivateKey).update(kemPrivateKey);
+        return hasher.finalize();
+    }
+
+    // Function to merge the curve and Kyber public keys of a parameter set into the 32-byte SPHINX public key
+    template <typename Params>
+    SPHINXHash::SPHINX256Digest mergePublicKeys(const typename Params::CurvePubKey& curvePublicKey, const typename Params::KemPubKey& kemPublicKey) {
+        SPHINXHash::SPHINX256Hasher hasher;
+        hasher.update(curvePublicKey).update(kemPublicKey);
+        return hasher.finalize();
+    }
+
+    // Function to extract the Kyber public key embedded in a Kyber private key of a parameter set
+    template <typename Params>
+    typename Params::KemPubKey calculatePublicKey(const typename Params::KemPrivKey& privateKey) {
+        typename Params::KemPubKey publicKey;
+        std::copy_n(privateKey.begin() + Params::KemParameters::PUBLIC_KEY_OFFSET, publicKey.size(), publicKey.begin());
+        return publicKey;
+    }
+} // namespace SPHINXKey
+
+#endif // SPHINX_PARAMETER_SET_HPP
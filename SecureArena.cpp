@@ -0,0 +1,259 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code implements the secure arena used for private key material.
+
+// SecureArena Class:
+    // Slabs are mapped with mmap (aligned to the slab size), pinned with mlock() so they are never written to swap, and marked MADV_DONTDUMP so they stay out of core dumps.
+    // mlock() can fail against RLIMIT_MEMLOCK; the slab is then still used and stats() reports it as unlocked.
+    // The first slot of each slab holds a small header, so deallocate() finds the slab of a slot by masking its address.
+    // Free slots are kept on a Treiber stack: the head packs the top slot index with a tag that changes on every update, so a slot that is popped
+    // and pushed back between another thread's load and compare-exchange cannot be mistaken for an unchanged head (ABA).
+    // The links live in a side array rather than in the slots, so a thread reading a stale link never touches memory that already holds a key.
+    // deallocate() zeroizes the slot before it is pushed; allocate() only takes the refill mutex when the stack is empty and a new slab is mapped.
+
+// secureAllocate and secureDeallocate Functions:
+    // Requests up to SECURE_ARENA_MAX_SLOT bytes are rounded up to a power of two (at least 64) and served by one process-wide arena per size.
+    // Those arenas are never destroyed, so SecureKey objects with static storage can still be released during exit. Larger requests get their own locked mapping.
+
+// secureZero Function:
+    // Zeroes memory through a volatile pointer, so the stores are kept even when the memory is freed or goes out of scope right afterwards.
+    // The wipes of key material across SPHINXKey (arena slots, KeypairPool, HD derivation, the stream cipher, the keystore) go through it.
+
+// SecureAllocator and SecureKey:
+    // SecureAllocator lets standard containers keep secrets in the arenas; SecureKey owns one key (SPHINXPrivKey, Curve448PrivKey, KyberPrivKey, ...) in a slot.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <mutex>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "SecureArena.hpp"
+
+
+namespace SPHINXKey {
+
+    namespace {
+        constexpr uint64_t FREE_INDEX_MASK = 0xffffffffull;
+        constexpr size_t SECURE_MIN_SLOT = 64;
+
+        size_t pageSize() {
+            static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            return size;
+        }
+
+        // Map length bytes aligned to alignment, returns nullptr on failure
+        unsigned char* mapAligned(size_t length, size_t alignment) {
+            const size_t span = length + alignment;
+            void* mapping = ::mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapping == MAP_FAILED) {
+                return nullptr;
+            }
+            const uintptr_t start = reinterpret_cast<uintptr_t>(mapping);
+            const uintptr_t aligned = (start + alignment - 1) & ~(uintptr_t(alignment) - 1);
+            if (aligned > start) {
+                ::munmap(mapping, aligned - start);
+            }
+            const uintptr_t end = start + span;
+            if (end > aligned + length) {
+                ::munmap(reinterpret_cast<void*>(aligned + length), end - aligned - length);
+            }
+            return reinterpret_cast<unsigned char*>(aligned);
+        }
+
+        // Pin a mapping in RAM and keep it out of core dumps, returns whether mlock succeeded
+        bool protectMapping(void* memory, size_t length) {
+#if defined(MADV_DONTDUMP)
+            ::madvise(memory, length, MADV_DONTDUMP);
+#endif
+            return ::mlock(memory, length) == 0;
+        }
+
+        void releaseMapping(void* memory, size_t length) {
+            ::munlock(memory, length);
+            ::munmap(memory, length);
+        }
+
+        size_t slotClass(size_t bytes) {
+            return static_cast<size_t>(std::countr_zero(std::bit_ceil(std::max(bytes, SECURE_MIN_SLOT)))) - static_cast<size_t>(std::countr_zero(SECURE_MIN_SLOT));
+        }
+
+        constexpr size_t SECURE_SLOT_CLASSES = static_cast<size_t>(std::countr_zero(SECURE_ARENA_MAX_SLOT)) - static_cast<size_t>(std::countr_zero(SECURE_MIN_SLOT)) + 1;
+
+        SecureArena& classArena(size_t index) {
+            // Never destroyed: see the summary above
+            static const std::array<SecureArena*, SECURE_SLOT_CLASSES> arenas = [] {
+                std::array<SecureArena*, SECURE_SLOT_CLASSES> created;
+                for (size_t i = 0; i < created.size(); ++i) {
+                    created[i] = new SecureArena(SECURE_MIN_SLOT << i);
+                }
+                return created;
+            }();
+            return *arenas[index];
+        }
+    } // namespace
+
+    // Function to create an arena of slotSize-byte slots
+    SecureArena::SecureArena(size_t slotSize)
+        : slotSize_(std::bit_ceil(std::max(slotSize, SECURE_MIN_SLOT))),
+          slabSize_(std::max(MIN_SLAB_SIZE, 16 * slotSize_)),
+          slotsPerSlab_(static_cast<uint32_t>(slabSize_ / slotSize_)) {
+        static_assert(sizeof(SlabHeader) <= SECURE_MIN_SLOT, "Slab header must fit one slot");
+    }
+
+    SecureArena::~SecureArena() {
+        const size_t count = slabCount_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            unsigned char* slab = slabs_[i].load(std::memory_order_relaxed);
+            secureZero(slab, slabSize_);
+            releaseMapping(slab, slabSize_);
+        }
+    }
+
+    void* SecureArena::slotAt(uint32_t index) const {
+        return slabs_[index / slotsPerSlab_].load(std::memory_order_acquire) + static_cast<size_t>(index % slotsPerSlab_) * slotSize_;
+    }
+
+    uint32_t SecureArena::indexOf(void* slot) const {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(slot);
+        const uintptr_t base = address & ~(uintptr_t(slabSize_) - 1);
+        const SlabHeader* header = reinterpret_cast<const SlabHeader*>(base);
+        return header->firstIndex + static_cast<uint32_t>((address - base) / slotSize_);
+    }
+
+    // Function to take a zero-filled slot
+    void* SecureArena::allocate() {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        while ((head & FREE_INDEX_MASK) != 0) {
+            const uint32_t index = static_cast<uint32_t>(head & FREE_INDEX_MASK) - 1;
+            const uint32_t next = next_[index / slotsPerSlab_][index % slotsPerSlab_].load(std::memory_order_relaxed);
+            const uint64_t desired = (((head >> 32) + 1) << 32) | next;
+            if (head_.compare_exchange_weak(head, desired, std::memory_order_acquire, std::memory_order_acquire)) {
+                return slotAt(index);
+            }
+        }
+        return refill();
+    }
+
+    // Function to zeroize a slot and return it to the arena
+    void SecureArena::deallocate(void* slot) {
+        secureZero(slot, slotSize_);
+        const uint32_t index = indexOf(slot);
+        std::atomic<uint32_t>& link = next_[index / slotsPerSlab_][index % slotsPerSlab_];
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        uint64_t desired;
+        do {
+            link.store(static_cast<uint32_t>(head & FREE_INDEX_MASK), std::memory_order_relaxed);
+            desired = (((head >> 32) + 1) << 32) | (index + 1);
+        } while (!head_.compare_exchange_weak(head, desired, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void* SecureArena::refill() {
+        std::unique_lock<std::mutex> lock(refillMutex_);
+
+        // Another thread may have mapped a slab (or released slots) while this one waited
+        if ((head_.load(std::memory_order_acquire) & FREE_INDEX_MASK) != 0) {
+            lock.unlock();
+            return allocate();
+        }
+
+        // Step 1: Map, pin and register a new slab
+        const size_t count = slabCount_.load(std::memory_order_relaxed);
+        if (count == MAX_SLABS) {
+            throw std::bad_alloc();
+        }
+        unsigned char* slab = mapAligned(slabSize_, slabSize_);
+        if (slab == nullptr) {
+            throw std::bad_alloc();
+        }
+        if (protectMapping(slab, slabSize_)) {
+            lockedSlabs_.fetch_add(1, std::memory_order_relaxed);
+        }
+        const uint32_t firstIndex = static_cast<uint32_t>(count) * slotsPerSlab_;
+        *reinterpret_cast<SlabHeader*>(slab) = SlabHeader{this, firstIndex};
+        next_[count] = std::make_unique<std::atomic<uint32_t>[]>(slotsPerSlab_);
+        slabs_[count].store(slab, std::memory_order_release);
+        slabCount_.store(count + 1, std::memory_order_release);
+
+        // Step 2: Slot 0 is the header and slot 1 goes to the caller; chain slots 2.. and push them in one exchange
+        std::atomic<uint32_t>* links = next_[count].get();
+        for (uint32_t i = 2; i + 1 < slotsPerSlab_; ++i) {
+            links[i].store(firstIndex + i + 2, std::memory_order_relaxed);
+        }
+        std::atomic<uint32_t>& last = links[slotsPerSlab_ - 1];
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        uint64_t desired;
+        do {
+            last.store(static_cast<uint32_t>(head & FREE_INDEX_MASK), std::memory_order_relaxed);
+            desired = (((head >> 32) + 1) << 32) | (firstIndex + 2 + 1);
+        } while (!head_.compare_exchange_weak(head, desired, std::memory_order_release, std::memory_order_relaxed));
+
+        return slab + slotSize_;
+    }
+
+    // Function to return a snapshot of the arena counters
+    SecureArenaStats SecureArena::stats() const {
+        SecureArenaStats stats;
+        stats.slotSize = slotSize_;
+        stats.slabs = slabCount_.load(std::memory_order_acquire);
+        stats.lockedSlabs = lockedSlabs_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    // Function to take secure memory
+    void* secureAllocate(size_t bytes) {
+        if (bytes <= SECURE_ARENA_MAX_SLOT) {
+            return classArena(slotClass(bytes)).allocate();
+        }
+        const size_t length = (bytes + pageSize() - 1) / pageSize() * pageSize();
+        void* mapping = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        protectMapping(mapping, length);
+        return mapping;
+    }
+
+    // Function to zero memory that held secrets
+    void secureZero(void* data, size_t length) {
+        volatile unsigned char* p = static_cast<volatile unsigned char*>(data);
+        for (size_t i = 0; i < length; ++i) {
+            p[i] = 0;
+        }
+    }
+
+    // Function to zeroize and release secure memory
+    void secureDeallocate(void* memory, size_t bytes) {
+        if (memory == nullptr) {
+            return;
+        }
+        if (bytes <= SECURE_ARENA_MAX_SLOT) {
+            classArena(slotClass(bytes)).deallocate(memory);
+            return;
+        }
+        const size_t length = (bytes + pageSize() - 1) / pageSize() * pageSize();
+        secureZero(memory, length);
+        releaseMapping(memory, length);
+    }
+} // namespace SPHINXKey
@@ -0,0 +1,159 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+#ifndef SPHINX_SECURE_ARENA_HPP
+#define SPHINX_SECURE_ARENA_HPP
+
+#pragma once
+
+#include <mutex>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace SPHINXKey {
+
+    // Counters reported by SecureArena::stats
+    struct SecureArenaStats {
+        size_t slotSize = 0;
+        size_t slabs = 0;          // Slabs mapped so far (slabs are kept until the arena is destroyed)
+        size_t lockedSlabs = 0;    // Slabs that mlock() pinned in RAM; the rest failed against RLIMIT_MEMLOCK
+    };
+
+    // Arena of fixed-size slots for secret data
+    // Slots are carved from slabs that are mapped, mlock()ed and excluded from core dumps; free slots sit on a lock-free
+    // (Treiber) stack whose head carries a tag against ABA, so allocate and deallocate take no lock unless a new slab is mapped
+    // Every slot is zeroized when it is released
+    class SecureArena {
+    public:
+        static constexpr size_t MIN_SLAB_SIZE = size_t(1) << 16;
+        static constexpr size_t MAX_SLABS = 1024;
+
+        // Function to create an arena of slotSize-byte slots (a power of two, at least 64)
+        explicit SecureArena(size_t slotSize);
+        ~SecureArena();
+
+        SecureArena(const SecureArena&) = delete;
+        SecureArena& operator=(const SecureArena&) = delete;
+
+        // Function to take a zero-filled slot, throws std::bad_alloc when no slab can be mapped
+        void* allocate();
+
+        // Function to zeroize a slot and return it to the arena
+        void deallocate(void* slot);
+
+        // Function to return the slot size
+        size_t slotSize() const { return slotSize_; }
+
+        // Function to return a snapshot of the arena counters
+        SecureArenaStats stats() const;
+
+    private:
+        // The first slot of every slab holds its header, so a slot finds its slab by masking its address
+        struct SlabHeader {
+            SecureArena* arena;
+            uint32_t firstIndex;
+        };
+
+        void* slotAt(uint32_t index) const;
+        uint32_t indexOf(void* slot) const;
+        void* refill();
+
+        const size_t slotSize_;
+        const size_t slabSize_;
+        const uint32_t slotsPerSlab_;
+
+        // Free list: low 32 bits are the top slot's index + 1 (0 when empty), high 32 bits are a tag bumped on every change
+        alignas(64) std::atomic<uint64_t> head_{0};
+
+        std::mutex refillMutex_;
+        std::array<std::atomic<unsigned char*>, MAX_SLABS> slabs_{};
+        std::array<std::unique_ptr<std::atomic<uint32_t>[]>, MAX_SLABS> next_;
+        std::atomic<size_t> slabCount_{0};
+        std::atomic<size_t> lockedSlabs_{0};
+    };
+
+    // Function to take secure memory of at least bytes bytes (aligned to 64)
+    // Requests up to SECURE_ARENA_MAX_SLOT bytes come from process-wide arenas of power-of-two slots, larger ones get their own locked mapping
+    void* secureAllocate(size_t bytes);
+
+    // Function to zeroize and release memory taken with secureAllocate(bytes)
+    void secureDeallocate(void* memory, size_t bytes);
+
+    constexpr size_t SECURE_ARENA_MAX_SLOT = 16384;
+
+    // Function to zero memory that held secrets; the stores are not removed as dead even if the memory is released right after
+    void secureZero(void* data, size_t length);
+
+    // Standard allocator over secureAllocate, for containers that hold secrets
+    template <typename T>
+    struct SecureAllocator {
+        using value_type = T;
+
+        static_assert(alignof(T) <= 64, "SecureAllocator aligns to 64 bytes");
+
+        SecureAllocator() noexcept = default;
+        template <typename U>
+        SecureAllocator(const SecureAllocator<U>&) noexcept {}
+
+        T* allocate(size_t n) {
+            if (n > SIZE_MAX / sizeof(T)) {
+                throw std::bad_array_new_length();
+            }
+            return static_cast<T*>(secureAllocate(n * sizeof(T)));
+        }
+
+        void deallocate(T* p, size_t n) noexcept { secureDeallocate(p, n * sizeof(T)); }
+
+        template <typename U>
+        bool operator==(const SecureAllocator<U>&) const noexcept { return true; }
+    };
+
+    // Owning handle of one key held in secure memory; the key is zeroized when the handle is destroyed
+    template <typename Key>
+    class SecureKey {
+    public:
+        SecureKey() : key_(new (secureAllocate(sizeof(Key))) Key{}) {}
+        explicit SecureKey(const Key& key) : SecureKey() { *key_ = key; }
+
+        SecureKey(SecureKey&& other) noexcept : key_(std::exchange(other.key_, nullptr)) {}
+        SecureKey& operator=(SecureKey&& other) noexcept {
+            std::swap(key_, other.key_);
+            return *this;
+        }
+
+        SecureKey(const SecureKey&) = delete;
+        SecureKey& operator=(const SecureKey&) = delete;
+
+        ~SecureKey() {
+            if (key_ != nullptr) {
+                key_->~Key();
+                secureDeallocate(key_, sizeof(Key));
+            }
+        }
+
+        Key& operator*() { return *key_; }
+        const Key& operator*() const { return *key_; }
+        Key* operator->() { return key_; }
+        const Key* operator->() const { return key_; }
+
+    private:
+        Key* key_;
+    };
+} // namespace SPHINXKey
+
+#endif // SPHINX_SECURE_ARENA_HPP
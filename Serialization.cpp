@@ -0,0 +1,290 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code implements hex and binary serialization of SPHINX keys and hybrid key pairs into caller buffers.
+
+// Hex Encoding:
+    // hexEncode converts 8 bytes per step with GCC/Clang vector extensions: each byte is widened to a 16-bit lane, split into its two nibbles,
+    // both nibbles are mapped to '0'-'9' / 'a'-'f' with one compare and add, and the lane is stored as the two characters (little-endian targets).
+    // hexDecode does the reverse for 16 characters per step and rejects any non-hex character in the block; other targets and the tails use a lookup table.
+    // toHex returns the hex text of a fixed-size key in a stack array, and hexEncodeKeys writes many keys as fixed-stride lines into one buffer,
+    // so bulk export makes no allocation and no iostream call per key.
+
+// Binary Wire Format:
+    // A HybridKeypair is written as the magic "SPXK", a version and field count, then each field as a 4-byte little-endian length and its bytes.
+    // The lengths of the fixed-size fields must match this build's sizes, so a key pair from another parameter set is rejected instead of misread.
+    // parseKeypair returns spans into the input buffer (no copy); deserializeKeypair copies them straight into the caller's HybridKeypair,
+    // wiping its previous shared secret first, so no temporary copy of the secrets is left unwiped.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <span>
+#include <array>
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+
+#include "Key.hpp"
+#include "Serialization.hpp"
+#include "SecureArena.hpp"
+
+
+namespace SPHINXKey {
+
+    namespace {
+        constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+        // Reverse lookup table for hex digits, -1 marks other characters
+        constexpr std::array<int8_t, 256> HEX_MAP = [] {
+            std::array<int8_t, 256> map{};
+            for (auto& entry : map) {
+                entry = -1;
+            }
+            for (int i = 0; i < 10; ++i) {
+                map['0' + i] = static_cast<int8_t>(i);
+            }
+            for (int i = 0; i < 6; ++i) {
+                map['a' + i] = static_cast<int8_t>(10 + i);
+                map['A' + i] = static_cast<int8_t>(10 + i);
+            }
+            return map;
+        }();
+
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define SPHINX_HEX_VECTOR 1
+        // 16-byte vectors with signed lanes, so the compares map to single SSE2 / NEON instructions instead of being split into scalar code
+        typedef unsigned char HexBytes __attribute__((vector_size(8)));
+        typedef short HexPairs __attribute__((vector_size(16)));
+        typedef unsigned short HexWords __attribute__((vector_size(16)));
+        typedef unsigned char HexChars __attribute__((vector_size(16)));
+        typedef signed char HexSignedChars __attribute__((vector_size(16)));
+
+        // Bytes per vector step
+        constexpr size_t HEX_BLOCK = sizeof(HexBytes);
+
+        // Encode 8 bytes into 16 characters
+        void hexEncodeBlock(const unsigned char* data, char* out) {
+            HexBytes bytes;
+            std::memcpy(&bytes, data, sizeof(bytes));
+            const HexPairs wide = __builtin_convertvector(bytes, HexPairs);
+            const HexPairs high = wide >> 4;
+            const HexPairs low = wide & 15;
+            // A nibble above 9 gets 'a' - '0' - 10 = 39 added on top of '0' (the compare yields all ones per true lane)
+            const HexPairs highChars = high + '0' + ((high > 9) & 39);
+            const HexPairs lowChars = low + '0' + ((low > 9) & 39);
+            const HexPairs chars = highChars | (lowChars << 8);
+            std::memcpy(out, &chars, sizeof(chars));
+        }
+
+        // Decode 16 characters into 8 bytes, returns false if any character is not a hex digit
+        bool hexDecodeBlock(const char* hex, unsigned char* out) {
+            HexChars chars;
+            std::memcpy(&chars, hex, sizeof(chars));
+            const HexChars lower = chars | 0x20;
+            // Unsigned "at most" compares: flipping the sign bit turns them into signed compares
+            const HexChars isDigit = reinterpret_cast<HexChars>(reinterpret_cast<HexSignedChars>((chars - '0') ^ 0x80) <= static_cast<signed char>(-128 + 9));
+            const HexChars isLetter = reinterpret_cast<HexChars>(reinterpret_cast<HexSignedChars>((lower - 'a') ^ 0x80) <= static_cast<signed char>(-128 + 5));
+            const HexChars valid = isDigit | isLetter;
+            uint64_t lanes[sizeof(valid) / sizeof(uint64_t)];
+            std::memcpy(lanes, &valid, sizeof(valid));
+            if ((lanes[0] & lanes[1]) != ~uint64_t(0)) {
+                return false;
+            }
+            const HexChars nibbles = ((chars - '0') & isDigit) | ((lower - 'a' + 10) & isLetter);
+
+            // Each 16-bit lane holds the high nibble character in its low byte
+            HexWords pairs;
+            std::memcpy(&pairs, &nibbles, sizeof(pairs));
+            const HexWords bytes = ((pairs & 0xff) << 4) | (pairs >> 8);
+            const HexBytes narrow = __builtin_convertvector(bytes, HexBytes);
+            std::memcpy(out, &narrow, sizeof(narrow));
+            return true;
+        }
+#endif
+
+        void putLength(unsigned char* out, uint32_t length) {
+            for (size_t i = 0; i < 4; ++i) {
+                out[i] = static_cast<unsigned char>(length >> (8 * i));
+            }
+        }
+
+        uint32_t getLength(const unsigned char* in) {
+            uint32_t length = 0;
+            for (size_t i = 0; i < 4; ++i) {
+                length |= static_cast<uint32_t>(in[i]) << (8 * i);
+            }
+            return length;
+        }
+    } // namespace
+
+    // Function to write data as lowercase hex
+    size_t hexEncode(std::span<const unsigned char> data, std::span<char> out) {
+        if (out.size() / 2 < data.size()) {
+            throw std::length_error("hexEncode: output buffer too small");
+        }
+        size_t i = 0;
+#if defined(SPHINX_HEX_VECTOR)
+        for (; i + HEX_BLOCK <= data.size(); i += HEX_BLOCK) {
+            hexEncodeBlock(data.data() + i, out.data() + 2 * i);
+        }
+#endif
+        for (; i < data.size(); ++i) {
+            out[2 * i] = HEX_DIGITS[data[i] >> 4];
+            out[2 * i + 1] = HEX_DIGITS[data[i] & 15];
+        }
+        return 2 * data.size();
+    }
+
+    // Function to decode hex into out
+    bool hexDecode(std::string_view hex, std::span<unsigned char> out) {
+        if (hex.size() % 2 != 0 || out.size() != hex.size() / 2) {
+            return false;
+        }
+        size_t i = 0;
+#if defined(SPHINX_HEX_VECTOR)
+        for (; i + HEX_BLOCK <= out.size(); i += HEX_BLOCK) {
+            if (!hexDecodeBlock(hex.data() + 2 * i, out.data() + i)) {
+                return false;
+            }
+        }
+#endif
+        for (; i < out.size(); ++i) {
+            const int high = HEX_MAP[static_cast<unsigned char>(hex[2 * i])];
+            const int low = HEX_MAP[static_cast<unsigned char>(hex[2 * i + 1])];
+            if (high < 0 || low < 0) {
+                return false;
+            }
+            out[i] = static_cast<unsigned char>((high << 4) | low);
+        }
+        return true;
+    }
+
+    // Function to export many public keys as hex lines
+    size_t hexEncodeKeys(std::span<const SPHINXPubKey> keys, std::span<char> out, char separator) {
+        constexpr size_t stride = 2 * SPHINX_256_DIGEST_SIZE + 1;
+        if (out.size() / stride < keys.size()) {
+            throw std::length_error("hexEncodeKeys: output buffer too small");
+        }
+        for (size_t i = 0; i < keys.size(); ++i) {
+            char* line = out.data() + i * stride;
+            hexEncode(keys[i], std::span<char>(line, stride - 1));
+            line[stride - 1] = separator;
+        }
+        return keys.size() * stride;
+    }
+
+    // Function to return the serialized size of a key pair
+    size_t serializedSize(const SPHINXHybridKey::HybridKeypair& keypair) {
+        return KEYPAIR_WIRE_HEADER_SIZE + 4 * KEYPAIR_WIRE_FIELDS + keypair.merged_key.sphinxPrivKey.size() + keypair.merged_key.sphinxPubKey.size() +
+               keypair.public_key_pke.size() + keypair.secret_key_pke.size() + keypair.shared_secret.size();
+    }
+
+    // Function to serialize a key pair into out
+    size_t serializeKeypair(const SPHINXHybridKey::HybridKeypair& keypair, std::span<unsigned char> out) {
+        const size_t size = serializedSize(keypair);
+        if (out.size() < size) {
+            throw std::length_error("serializeKeypair: output buffer too small");
+        }
+        if (keypair.shared_secret.size() > UINT32_MAX) {
+            throw std::length_error("serializeKeypair: shared secret too long");
+        }
+
+        unsigned char* p = out.data();
+        std::memcpy(p, KEYPAIR_WIRE_MAGIC.data(), KEYPAIR_WIRE_MAGIC.size());
+        p += KEYPAIR_WIRE_MAGIC.size();
+        *p++ = KEYPAIR_WIRE_VERSION;
+        *p++ = static_cast<unsigned char>(KEYPAIR_WIRE_FIELDS);
+        auto putField = [&](const void* data, size_t length) {
+            putLength(p, static_cast<uint32_t>(length));
+            if (length > 0) {
+                std::memcpy(p + 4, data, length);
+            }
+            p += 4 + length;
+        };
+        putField(keypair.merged_key.sphinxPrivKey.data(), keypair.merged_key.sphinxPrivKey.size());
+        putField(keypair.merged_key.sphinxPubKey.data(), keypair.merged_key.sphinxPubKey.size());
+        putField(keypair.public_key_pke.data(), keypair.public_key_pke.size());
+        putField(keypair.secret_key_pke.data(), keypair.secret_key_pke.size());
+        putField(keypair.shared_secret.data(), keypair.shared_secret.size());
+        return size;
+    }
+
+    // Function to parse a serialized key pair without copying it
+    HybridKeypairView parseKeypair(std::span<const unsigned char> in) {
+        // Step 1: Check the header
+        if (in.size() < KEYPAIR_WIRE_HEADER_SIZE || !std::equal(KEYPAIR_WIRE_MAGIC.begin(), KEYPAIR_WIRE_MAGIC.end(), in.begin())) {
+            throw std::invalid_argument("parseKeypair: not a serialized key pair");
+        }
+        if (in[KEYPAIR_WIRE_MAGIC.size()] != KEYPAIR_WIRE_VERSION || in[KEYPAIR_WIRE_MAGIC.size() + 1] != KEYPAIR_WIRE_FIELDS) {
+            throw std::invalid_argument("parseKeypair: unsupported format version");
+        }
+
+        // Step 2: Walk the length-prefixed fields, checking each against the expected size
+        size_t offset = KEYPAIR_WIRE_HEADER_SIZE;
+        auto field = [&](size_t expected, bool fixed) {
+            if (in.size() - offset < 4) {
+                throw std::invalid_argument("parseKeypair: truncated input");
+            }
+            const size_t length = getLength(in.data() + offset);
+            if (fixed && length != expected) {
+                throw std::invalid_argument("parseKeypair: field length does not match this build's key sizes");
+            }
+            if (in.size() - offset - 4 < length) {
+                throw std::invalid_argument("parseKeypair: truncated input");
+            }
+            const std::span<const unsigned char> bytes = in.subspan(offset + 4, length);
+            offset += 4 + length;
+            return bytes;
+        };
+        const auto sphinxPrivKey = field(SPHINX_256_DIGEST_SIZE, true);
+        const auto sphinxPubKey = field(SPHINX_256_DIGEST_SIZE, true);
+        const auto publicKeyPke = field(KYBER1024_PKE_PUBLIC_KEY_LENGTH, true);
+        const auto secretKeyPke = field(KYBER1024_PKE_PRIVATE_KEY_LENGTH, true);
+        const auto sharedSecret = field(0, false);
+
+        return HybridKeypairView{sphinxPrivKey.first<SPHINX_256_DIGEST_SIZE>(), sphinxPubKey.first<SPHINX_256_DIGEST_SIZE>(),
+                                 publicKeyPke.first<KYBER1024_PKE_PUBLIC_KEY_LENGTH>(), secretKeyPke.first<KYBER1024_PKE_PRIVATE_KEY_LENGTH>(),
+                                 sharedSecret, offset};
+    }
+
+    // Function to copy the fields of a view into a HybridKeypair
+    SPHINXHybridKey::HybridKeypair HybridKeypairView::toKeypair() const {
+        SPHINXHybridKey::HybridKeypair keypair;
+        copyTo(keypair);
+        return keypair;
+    }
+
+    // Function to copy the fields of a view into an existing HybridKeypair
+    void HybridKeypairView::copyTo(SPHINXHybridKey::HybridKeypair& keypair) const {
+        std::copy(sphinxPrivKey.begin(), sphinxPrivKey.end(), keypair.merged_key.sphinxPrivKey.begin());
+        std::copy(sphinxPubKey.begin(), sphinxPubKey.end(), keypair.merged_key.sphinxPubKey.begin());
+        std::copy(publicKeyPke.begin(), publicKeyPke.end(), keypair.public_key_pke.begin());
+        std::copy(secretKeyPke.begin(), secretKeyPke.end(), keypair.secret_key_pke.begin());
+
+        // assign() may free the old buffer, so wipe the old secret first
+        secureZero(keypair.shared_secret.data(), keypair.shared_secret.size());
+        keypair.shared_secret.assign(sharedSecret.begin(), sharedSecret.end());
+    }
+
+    // Function to parse and copy a serialized key pair
+    size_t deserializeKeypair(std::span<const unsigned char> in, SPHINXHybridKey::HybridKeypair& keypair) {
+        const HybridKeypairView view = parseKeypair(in);
+        view.copyTo(keypair);
+        return view.size;
+    }
+} // namespace SPHINXKey
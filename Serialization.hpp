@@ -0,0 +1,95 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+#ifndef SPHINX_SERIALIZATION_HPP
+#define SPHINX_SERIALIZATION_HPP
+
+#pragma once
+
+#include <span>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "Key.hpp"
+
+namespace SPHINXKey {
+
+    // Function to write data as lowercase hex (two characters per byte, leading zeros kept) into out, returns the number of characters written
+    // Throws std::length_error if out is shorter than 2 * data.size()
+    size_t hexEncode(std::span<const unsigned char> data, std::span<char> out);
+
+    // Function to decode hex (either case) into out, which must hold exactly hex.size() / 2 bytes
+    // Returns false on an odd length, a size mismatch or a non-hex character; out is then unspecified
+    bool hexDecode(std::string_view hex, std::span<unsigned char> out);
+
+    // Fixed-size hex text of a key, held on the stack
+    template <size_t N>
+    struct HexString {
+        std::array<char, 2 * N> chars;
+
+        std::string_view view() const { return std::string_view(chars.data(), chars.size()); }
+        operator std::string_view() const { return view(); }
+    };
+
+    // Function to return the hex text of a fixed-size key without allocating
+    template <size_t N>
+    HexString<N> toHex(const std::array<unsigned char, N>& key) {
+        HexString<N> hex;
+        hexEncode(key, hex.chars);
+        return hex;
+    }
+
+    // Function to export many public keys as hex lines: key i is written at out + i * (2 * SPHINX_256_DIGEST_SIZE + 1), followed by separator
+    // Returns the number of characters written; throws std::length_error if out is too small
+    size_t hexEncodeKeys(std::span<const SPHINXPubKey> keys, std::span<char> out, char separator = '\n');
+
+    // HybridKeypair wire format: magic "SPXK", format version (1 byte), field count (1 byte), then every field as a
+    // 4-byte little-endian length followed by its bytes: merged private key, merged public key, PKE public key, PKE private key, shared secret
+    constexpr std::array<unsigned char, 4> KEYPAIR_WIRE_MAGIC = {'S', 'P', 'X', 'K'};
+    constexpr uint8_t KEYPAIR_WIRE_VERSION = 1;
+    constexpr size_t KEYPAIR_WIRE_FIELDS = 5;
+    constexpr size_t KEYPAIR_WIRE_HEADER_SIZE = KEYPAIR_WIRE_MAGIC.size() + 2;
+
+    // Read-only view of a serialized HybridKeypair; every span points into the buffer it was parsed from
+    struct HybridKeypairView {
+        std::span<const unsigned char, SPHINX_256_DIGEST_SIZE> sphinxPrivKey;
+        std::span<const unsigned char, SPHINX_256_DIGEST_SIZE> sphinxPubKey;
+        std::span<const unsigned char, KYBER1024_PKE_PUBLIC_KEY_LENGTH> publicKeyPke;
+        std::span<const unsigned char, KYBER1024_PKE_PRIVATE_KEY_LENGTH> secretKeyPke;
+        std::span<const unsigned char> sharedSecret;
+        size_t size;   // Bytes of the buffer taken by this key pair
+
+        // Function to copy the fields into a HybridKeypair
+        SPHINXHybridKey::HybridKeypair toKeypair() const;
+
+        // Function to copy the fields into an existing HybridKeypair in place; its previous shared secret is wiped before it is replaced
+        void copyTo(SPHINXHybridKey::HybridKeypair& keypair) const;
+    };
+
+    // Function to return the serialized size of a key pair
+    size_t serializedSize(const SPHINXHybridKey::HybridKeypair& keypair);
+
+    // Function to serialize a key pair into out, returns the number of bytes written; throws std::length_error if out is too small
+    size_t serializeKeypair(const SPHINXHybridKey::HybridKeypair& keypair, std::span<unsigned char> out);
+
+    // Function to parse a serialized key pair at the start of in without copying it
+    // Throws std::invalid_argument if the magic, version, field count or a field length is wrong or in is truncated
+    HybridKeypairView parseKeypair(std::span<const unsigned char> in);
+
+    // Function to parse and copy a serialized key pair straight into keypair (no temporary copy of the secrets), returns the number of bytes consumed
+    size_t deserializeKeypair(std::span<const unsigned char> in, SPHINXHybridKey::HybridKeypair& keypair);
+} // namespace SPHINXKey
+
+#endif // SPHINX_SERIALIZATION_HPP
@@ -0,0 +1,544 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code implements streaming encryption of large payloads to a hybrid key pair.
+
+// aeadEncrypt and aeadDecrypt Functions:
+    // ChaCha20-Poly1305 as specified in RFC 8439: the Poly1305 key is the first ChaCha20 block (counter 0), the payload is XORed with the blocks from counter 1,
+    // and the tag covers the additional data, the ciphertext and both lengths. Poly1305 uses 44/44/42-bit limbs with 128-bit products.
+    // aeadDecrypt compares the tag in constant time and only decrypts once it matches.
+    // chacha20Encrypt and poly1305 expose the two primitives on their own, so they can be checked against the RFC 8439 test vectors.
+
+// Stream format:
+    // Header: "SPHXSTRM", format version, chunk size, a 16-byte random salt and the encapsulated key returned by encapsulateHybridSharedSecret.
+    // Key: SPHINX_256 over a domain label, the salt and the shared secret, so every stream has its own key even if the KEM were deterministic.
+    // Chunks: each chunk of chunkSize plaintext bytes is sealed separately and written as ciphertext followed by its 16-byte tag.
+    // The nonce holds the chunk number and a last-chunk flag, and every chunk authenticates SPHINX_256 of the header as additional data,
+    // so chunks cannot be reordered, dropped, moved to another stream or cut off at a chunk boundary without decryptStream noticing.
+    // The last chunk is the first one shorter than chunkSize; a stream whose length is a multiple of chunkSize ends with an empty last chunk.
+
+// encryptStream and decryptStream Functions:
+    // Double buffering: while chunk k is sealed (or opened) on the calling thread, chunk k + 1 is read into the other input buffer and chunk k - 1
+    // is written from the other output buffer, both on helper threads. Reads are issued one at a time and writes one at a time, in stream order.
+    // Memory use is two input and two output buffers of one chunk each; the plaintext buffers and the key are zeroized before returning.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <span>
+#include <array>
+#include <future>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+
+#include <unistd.h>
+
+#include "Hybrid_key.hpp"
+#include "Key.hpp"
+#include "Hasher.hpp"
+#include "StreamCipher.hpp"
+#include "SecureArena.hpp"
+
+
+namespace SPHINXKey {
+
+    namespace {
+        constexpr std::array<unsigned char, 8> STREAM_MAGIC = {'S', 'P', 'H', 'X', 'S', 'T', 'R', 'M'};
+        constexpr unsigned char STREAM_FORMAT_VERSION = 1;
+        constexpr size_t STREAM_SALT_SIZE = 16;
+        // magic, version, 3 reserved bytes, chunk size, salt, encapsulated key length
+        constexpr size_t STREAM_FIXED_HEADER_SIZE = 8 + 4 + 4 + STREAM_SALT_SIZE + 4;
+        constexpr size_t STREAM_MAX_ENCAPSULATED_KEY_SIZE = 16384;
+        constexpr char STREAM_KEY_LABEL[] = "SPHINXKey stream key v1";
+
+        uint32_t load32(const unsigned char* p) {
+            return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+        }
+
+        uint64_t load64(const unsigned char* p) {
+            return static_cast<uint64_t>(load32(p)) | static_cast<uint64_t>(load32(p + 4)) << 32;
+        }
+
+        void store32(unsigned char* p, uint32_t value) {
+            for (size_t i = 0; i < 4; ++i) {
+                p[i] = static_cast<unsigned char>(value >> (8 * i));
+            }
+        }
+
+        void store64(unsigned char* p, uint64_t value) {
+            store32(p, static_cast<uint32_t>(value));
+            store32(p + 4, static_cast<uint32_t>(value >> 32));
+        }
+
+        uint32_t rotl32(uint32_t value, int shift) {
+            return (value << shift) | (value >> (32 - shift));
+        }
+
+        void quarterRound(uint32_t& a, uint32_t& b, uint32_t& c, uint32_t& d) {
+            a += b; d ^= a; d = rotl32(d, 16);
+            c += d; b ^= c; b = rotl32(b, 12);
+            a += b; d ^= a; d = rotl32(d, 8);
+            c += d; b ^= c; b = rotl32(b, 7);
+        }
+
+        // ChaCha20 block function (RFC 8439 section 2.3)
+        void chacha20Block(const AeadKey& key, uint32_t counter, const AeadNonce& nonce, unsigned char out[64]) {
+            std::array<uint32_t, 16> input = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+            for (size_t i = 0; i < 8; ++i) {
+                input[4 + i] = load32(key.data() + 4 * i);
+            }
+            input[12] = counter;
+            for (size_t i = 0; i < 3; ++i) {
+                input[13 + i] = load32(nonce.data() + 4 * i);
+            }
+            std::array<uint32_t, 16> x = input;
+            for (int round = 0; round < 10; ++round) {
+                quarterRound(x[0], x[4], x[8], x[12]);
+                quarterRound(x[1], x[5], x[9], x[13]);
+                quarterRound(x[2], x[6], x[10], x[14]);
+                quarterRound(x[3], x[7], x[11], x[15]);
+                quarterRound(x[0], x[5], x[10], x[15]);
+                quarterRound(x[1], x[6], x[11], x[12]);
+                quarterRound(x[2], x[7], x[8], x[13]);
+                quarterRound(x[3], x[4], x[9], x[14]);
+            }
+            for (size_t i = 0; i < 16; ++i) {
+                store32(out + 4 * i, x[i] + input[i]);
+            }
+            secureZero(x.data(), sizeof(x));
+            secureZero(input.data(), sizeof(input));
+        }
+
+        // XOR data with the ChaCha20 keystream starting at the given block counter
+        void chacha20Xor(const AeadKey& key, uint32_t counter, const AeadNonce& nonce, const unsigned char* data, size_t length, unsigned char* out) {
+            unsigned char block[64];
+            for (size_t offset = 0; offset < length; offset += 64, ++counter) {
+                chacha20Block(key, counter, nonce, block);
+                const size_t n = std::min<size_t>(64, length - offset);
+                for (size_t i = 0; i < n; ++i) {
+                    out[offset + i] = data[offset + i] ^ block[i];
+                }
+            }
+            secureZero(block, sizeof(block));
+        }
+
+        // Poly1305 one-time authenticator (RFC 8439 section 2.5) on 44/44/42-bit limbs
+        class Poly1305 {
+        public:
+            explicit Poly1305(const unsigned char key[32]) {
+                const uint64_t t0 = load64(key);
+                const uint64_t t1 = load64(key + 8);
+                r_[0] = t0 & 0xffc0fffffffull;
+                r_[1] = ((t0 >> 44) | (t1 << 20)) & 0xfffffc0ffffull;
+                r_[2] = (t1 >> 24) & 0x00ffffffc0full;
+                pad_[0] = load64(key + 16);
+                pad_[1] = load64(key + 24);
+            }
+
+            ~Poly1305() {
+                secureZero(this, sizeof(*this));
+            }
+
+            // Function to absorb data
+            void update(const unsigned char* data, size_t length) {
+                if (leftover_ > 0) {
+                    const size_t take = std::min(length, 16 - leftover_);
+                    std::memcpy(buffer_ + leftover_, data, take);
+                    leftover_ += take;
+                    data += take;
+                    length -= take;
+                    if (leftover_ < 16) {
+                        return;
+                    }
+                    blocks(buffer_, 16, false);
+                    leftover_ = 0;
+                }
+                const size_t whole = length & ~size_t(15);
+                blocks(data, whole, false);
+                std::memcpy(buffer_, data + whole, length - whole);
+                leftover_ = length - whole;
+            }
+
+            // Function to absorb zero bytes up to the next 16-byte boundary of the data absorbed so far
+            void padTo16(size_t absorbed) {
+                static const unsigned char zeros[16] = {};
+                if (absorbed % 16 != 0) {
+                    update(zeros, 16 - absorbed % 16);
+                }
+            }
+
+            // Function to write the tag
+            void finish(unsigned char mac[16]) {
+                constexpr uint64_t mask44 = 0xfffffffffffull;
+                constexpr uint64_t mask42 = 0x3ffffffffffull;
+                if (leftover_ > 0) {
+                    buffer_[leftover_] = 1;
+                    std::memset(buffer_ + leftover_ + 1, 0, 16 - leftover_ - 1);
+                    blocks(buffer_, 16, true);
+                }
+
+                // Fully carry h
+                uint64_t h0 = h_[0], h1 = h_[1], h2 = h_[2];
+                uint64_t c = h1 >> 44; h1 &= mask44;
+                h2 += c; c = h2 >> 42; h2 &= mask42;
+                h0 += c * 5; c = h0 >> 44; h0 &= mask44;
+                h1 += c; c = h1 >> 44; h1 &= mask44;
+                h2 += c; c = h2 >> 42; h2 &= mask42;
+                h0 += c * 5; c = h0 >> 44; h0 &= mask44;
+                h1 += c;
+
+                // g = h + 5 - 2^130, keep g if it did not underflow (h >= p)
+                uint64_t g0 = h0 + 5; c = g0 >> 44; g0 &= mask44;
+                uint64_t g1 = h1 + c; c = g1 >> 44; g1 &= mask44;
+                uint64_t g2 = h2 + c - (uint64_t(1) << 42);
+                c = (g2 >> 63) - 1;
+                g0 &= c; g1 &= c; g2 &= c;
+                c = ~c;
+                h0 = (h0 & c) | g0;
+                h1 = (h1 & c) | g1;
+                h2 = (h2 & c) | g2;
+
+                // tag = (h + pad) mod 2^128
+                const uint64_t t0 = pad_[0];
+                const uint64_t t1 = pad_[1];
+                h0 += t0 & mask44; c = h0 >> 44; h0 &= mask44;
+                h1 += (((t0 >> 44) | (t1 << 20)) & mask44) + c; c = h1 >> 44; h1 &= mask44;
+                h2 += ((t1 >> 24) & mask42) + c; h2 &= mask42;
+                store64(mac, h0 | (h1 << 44));
+                store64(mac + 8, (h1 >> 20) | (h2 << 24));
+            }
+
+        private:
+            void blocks(const unsigned char* data, size_t length, bool final) {
+                using u128 = unsigned __int128;
+                constexpr uint64_t mask44 = 0xfffffffffffull;
+                const uint64_t hibit = final ? 0 : uint64_t(1) << 40;
+                const uint64_t r0 = r_[0], r1 = r_[1], r2 = r_[2];
+                const uint64_t s1 = r1 * (5 << 2);
+                const uint64_t s2 = r2 * (5 << 2);
+                uint64_t h0 = h_[0], h1 = h_[1], h2 = h_[2];
+                for (; length >= 16; data += 16, length -= 16) {
+                    const uint64_t t0 = load64(data);
+                    const uint64_t t1 = load64(data + 8);
+                    h0 += t0 & mask44;
+                    h1 += ((t0 >> 44) | (t1 << 20)) & mask44;
+                    h2 += ((t1 >> 24) & 0x3ffffffffffull) | hibit;
+
+                    u128 d0 = u128(h0) * r0 + u128(h1) * s2 + u128(h2) * s1;
+                    u128 d1 = u128(h0) * r1 + u128(h1) * r0 + u128(h2) * s2;
+                    u128 d2 = u128(h0) * r2 + u128(h1) * r1 + u128(h2) * r0;
+
+                    uint64_t c = static_cast<uint64_t>(d0 >> 44); h0 = static_cast<uint64_t>(d0) & mask44;
+                    d1 += c; c = static_cast<uint64_t>(d1 >> 44); h1 = static_cast<uint64_t>(d1) & mask44;
+                    d2 += c; c = static_cast<uint64_t>(d2 >> 42); h2 = static_cast<uint64_t>(d2) & 0x3ffffffffffull;
+                    h0 += c * 5; c = h0 >> 44; h0 &= mask44;
+                    h1 += c;
+                }
+                h_[0] = h0; h_[1] = h1; h_[2] = h2;
+            }
+
+            uint64_t r_[3];
+            uint64_t h_[3] = {0, 0, 0};
+            uint64_t pad_[2];
+            unsigned char buffer_[16];
+            size_t leftover_ = 0;
+        };
+
+        // Tag over the additional data and the ciphertext (RFC 8439 section 2.8)
+        AeadTag aeadTag(const AeadKey& key, const AeadNonce& nonce, std::span<const unsigned char> aad, const unsigned char* ciphertext, size_t length) {
+            unsigned char polyKey[64];
+            chacha20Block(key, 0, nonce, polyKey);
+            Poly1305 poly(polyKey);
+            secureZero(polyKey, sizeof(polyKey));
+
+            poly.update(aad.data(), aad.size());
+            poly.padTo16(aad.size());
+            poly.update(ciphertext, length);
+            poly.padTo16(length);
+            unsigned char lengths[16];
+            store64(lengths, aad.size());
+            store64(lengths + 8, length);
+            poly.update(lengths, sizeof(lengths));
+
+            AeadTag tag;
+            poly.finish(tag.data());
+            return tag;
+        }
+
+        // Per-stream state shared by the chunk functions
+        struct StreamKey {
+            AeadKey key;
+            SPHINXHash::SPHINX256Digest headerDigest;   // Additional data of every chunk
+
+            ~StreamKey() { secureZero(key.data(), key.size()); }
+        };
+
+        void deriveStreamKey(StreamKey& streamKey, std::span<const unsigned char> salt, const std::string& sharedSecret, std::span<const unsigned char> header) {
+            SPHINXHash::SPHINX256Hasher hasher;
+            hasher.update(reinterpret_cast<const unsigned char*>(STREAM_KEY_LABEL), sizeof(STREAM_KEY_LABEL) - 1);
+            hasher.update(salt);
+            hasher.update(reinterpret_cast<const unsigned char*>(sharedSecret.data()), sharedSecret.size());
+            hasher.finalize(streamKey.key.data());
+            streamKey.headerDigest = SPHINXHash::SPHINX_256(header);
+        }
+
+        // Nonce of a chunk: 3 zero bytes, the chunk number (big-endian) and the last-chunk flag
+        AeadNonce chunkNonce(uint64_t index, bool last) {
+            AeadNonce nonce{};
+            for (size_t i = 0; i < 8; ++i) {
+                nonce[3 + i] = static_cast<unsigned char>(index >> (56 - 8 * i));
+            }
+            nonce[11] = last ? 1 : 0;
+            return nonce;
+        }
+
+        // Read until the buffer is full or the reader reports the end of the stream
+        size_t readFull(const StreamReader& in, std::span<unsigned char> buffer) {
+            size_t total = 0;
+            while (total < buffer.size()) {
+                const size_t n = in(buffer.subspan(total));
+                if (n == 0) {
+                    break;
+                }
+                total += n;
+            }
+            return total;
+        }
+
+        // Two input and two output buffers of one chunk each, the plaintext side is zeroized on destruction
+        struct ChunkBuffers {
+            std::array<std::vector<unsigned char>, 2> input;
+            std::array<std::vector<unsigned char>, 2> output;
+            bool plaintextIsInput;
+
+            ChunkBuffers(size_t inputSize, size_t outputSize, bool plaintextIsInput)
+                : input{std::vector<unsigned char>(inputSize), std::vector<unsigned char>(inputSize)},
+                  output{std::vector<unsigned char>(outputSize), std::vector<unsigned char>(outputSize)},
+                  plaintextIsInput(plaintextIsInput) {}
+
+            ~ChunkBuffers() {
+                for (auto& buffer : plaintextIsInput ? input : output) {
+                    secureZero(buffer.data(), buffer.size());
+                }
+            }
+        };
+
+        // Run the chunk pipeline: process(k, input, inputLength, last, output) returns the output length of chunk k,
+        // and the chunk is the last one when its read came back shorter than inputSize
+        using ChunkFunction = std::function<size_t(uint64_t, const unsigned char*, size_t, bool, unsigned char*)>;
+
+        uint64_t runPipeline(const StreamReader& in, const StreamWriter& out, ChunkBuffers& buffers, const ChunkFunction& process, bool requireChunk) {
+            const size_t inputSize = buffers.input[0].size();
+            uint64_t produced = 0;
+
+            // Declared after the buffers, so an exception joins the helper threads before the buffers go away
+            std::future<size_t> readAhead;
+            std::future<void> writeBehind;
+
+            size_t length = readFull(in, buffers.input[0]);
+            for (uint64_t index = 0;; ++index) {
+                // A stream always ends with a short chunk, so running out of data on a chunk boundary means it was cut off
+                if (length == 0 && requireChunk) {
+                    throw std::runtime_error("decryptStream: stream is truncated");
+                }
+                const size_t current = index % 2;
+                const bool last = length < inputSize;
+                if (!last) {
+                    readAhead = std::async(std::launch::async, [&in, &buffers, current] { return readFull(in, buffers.input[1 - current]); });
+                }
+
+                const size_t outputLength = process(index, buffers.input[current].data(), length, last, buffers.output[current].data());
+                produced += outputLength;
+
+                if (writeBehind.valid()) {
+                    writeBehind.get();
+                }
+                writeBehind = std::async(std::launch::async, [&out, &buffers, current, outputLength] {
+                    out(std::span<const unsigned char>(buffers.output[current].data(), outputLength));
+                });
+                if (last) {
+                    break;
+                }
+                length = readAhead.get();
+            }
+            writeBehind.get();
+            return produced;
+        }
+    } // namespace
+
+    // Function to XOR data with the ChaCha20 keystream
+    void chacha20Encrypt(const AeadKey& key, uint32_t counter, const AeadNonce& nonce, std::span<const unsigned char> data, unsigned char* out) {
+        chacha20Xor(key, counter, nonce, data.data(), data.size(), out);
+    }
+
+    // Function to compute a Poly1305 tag
+    AeadTag poly1305(std::span<const unsigned char, 32> key, std::span<const unsigned char> message) {
+        Poly1305 poly(key.data());
+        poly.update(message.data(), message.size());
+        AeadTag tag;
+        poly.finish(tag.data());
+        return tag;
+    }
+
+    // Function to encrypt data with ChaCha20-Poly1305
+    AeadTag aeadEncrypt(const AeadKey& key, const AeadNonce& nonce, std::span<const unsigned char> aad, std::span<const unsigned char> data, unsigned char* out) {
+        chacha20Xor(key, 1, nonce, data.data(), data.size(), out);
+        return aeadTag(key, nonce, aad, out, data.size());
+    }
+
+    // Function to check the tag and decrypt data with ChaCha20-Poly1305
+    bool aeadDecrypt(const AeadKey& key, const AeadNonce& nonce, std::span<const unsigned char> aad, std::span<const unsigned char> data, const AeadTag& tag, unsigned char* out) {
+        const AeadTag expected = aeadTag(key, nonce, aad, data.data(), data.size());
+        unsigned char difference = 0;
+        for (size_t i = 0; i < tag.size(); ++i) {
+            difference |= expected[i] ^ tag[i];
+        }
+        if (difference != 0) {
+            return false;
+        }
+        chacha20Xor(key, 1, nonce, data.data(), data.size(), out);
+        return true;
+    }
+
+    // Function to read from a file descriptor
+    StreamReader fdStreamReader(int fd) {
+        return [fd](std::span<unsigned char> buffer) {
+            size_t total = 0;
+            while (total < buffer.size()) {
+                const ssize_t n = ::read(fd, buffer.data() + total, buffer.size() - total);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n < 0) {
+                    throw std::system_error(errno, std::generic_category(), "fdStreamReader: read failed");
+                }
+                if (n == 0) {
+                    break;
+                }
+                total += static_cast<size_t>(n);
+            }
+            return total;
+        };
+    }
+
+    // Function to write to a file descriptor
+    StreamWriter fdStreamWriter(int fd) {
+        return [fd](std::span<const unsigned char> buffer) {
+            size_t total = 0;
+            while (total < buffer.size()) {
+                const ssize_t n = ::write(fd, buffer.data() + total, buffer.size() - total);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n < 0) {
+                    throw std::system_error(errno, std::generic_category(), "fdStreamWriter: write failed");
+                }
+                total += static_cast<size_t>(n);
+            }
+        };
+    }
+
+    // Function to encrypt a stream to the recipient's key pair
+    uint64_t encryptStream(const SPHINXHybridKey::HybridKeypair& recipient, const StreamReader& in, const StreamWriter& out, size_t chunkSize) {
+        if (chunkSize == 0 || chunkSize > STREAM_MAX_CHUNK_SIZE) {
+            throw std::invalid_argument("encryptStream: chunk size must be between 1 and STREAM_MAX_CHUNK_SIZE");
+        }
+
+        // Step 1: Encapsulate once and write the header
+        std::vector<uint8_t> encapsulatedKey;
+        std::string sharedSecret = SPHINXHybridKey::encapsulateHybridSharedSecret(recipient, encapsulatedKey);
+        if (encapsulatedKey.size() > STREAM_MAX_ENCAPSULATED_KEY_SIZE) {
+            throw std::length_error("encryptStream: encapsulated key is too large");
+        }
+        std::vector<unsigned char> header(STREAM_FIXED_HEADER_SIZE + encapsulatedKey.size(), 0);
+        std::memcpy(header.data(), STREAM_MAGIC.data(), STREAM_MAGIC.size());
+        header[8] = STREAM_FORMAT_VERSION;
+        store32(header.data() + 12, static_cast<uint32_t>(chunkSize));
+        std::random_device random;
+        for (size_t i = 0; i < STREAM_SALT_SIZE; i += 4) {
+            store32(header.data() + 16 + i, random());
+        }
+        store32(header.data() + 16 + STREAM_SALT_SIZE, static_cast<uint32_t>(encapsulatedKey.size()));
+        std::memcpy(header.data() + STREAM_FIXED_HEADER_SIZE, encapsulatedKey.data(), encapsulatedKey.size());
+
+        // Step 2: Derive the stream key from the salt and the shared secret
+        StreamKey streamKey;
+        deriveStreamKey(streamKey, std::span<const unsigned char>(header.data() + 16, STREAM_SALT_SIZE), sharedSecret, header);
+        secureZero(sharedSecret.data(), sharedSecret.size());
+        out(header);
+
+        // Step 3: Seal the chunks, each output chunk is the ciphertext followed by its tag
+        uint64_t plaintextBytes = 0;
+        ChunkBuffers buffers(chunkSize, chunkSize + AEAD_TAG_SIZE, true);
+        runPipeline(in, out, buffers,
+                    [&](uint64_t index, const unsigned char* data, size_t length, bool last, unsigned char* sealed) {
+                        const AeadTag tag = aeadEncrypt(streamKey.key, chunkNonce(index, last), streamKey.headerDigest, std::span<const unsigned char>(data, length), sealed);
+                        std::memcpy(sealed + length, tag.data(), tag.size());
+                        plaintextBytes += length;
+                        return length + AEAD_TAG_SIZE;
+                    }, false);
+        return plaintextBytes;
+    }
+
+    // Function to decrypt a stream written by encryptStream
+    uint64_t decryptStream(const SPHINXHybridKey::HybridKeypair& keypair, const StreamReader& in, const StreamWriter& out) {
+        // Step 1: Read and check the header
+        std::vector<unsigned char> header(STREAM_FIXED_HEADER_SIZE);
+        if (readFull(in, header) != header.size() || std::memcmp(header.data(), STREAM_MAGIC.data(), STREAM_MAGIC.size()) != 0) {
+            throw std::runtime_error("decryptStream: not an encrypted stream");
+        }
+        if (header[8] != STREAM_FORMAT_VERSION) {
+            throw std::runtime_error("decryptStream: unsupported stream version");
+        }
+        const size_t chunkSize = load32(header.data() + 12);
+        const size_t encapsulatedKeySize = load32(header.data() + 16 + STREAM_SALT_SIZE);
+        if (chunkSize == 0 || chunkSize > STREAM_MAX_CHUNK_SIZE || encapsulatedKeySize > STREAM_MAX_ENCAPSULATED_KEY_SIZE) {
+            throw std::runtime_error("decryptStream: invalid stream header");
+        }
+        header.resize(STREAM_FIXED_HEADER_SIZE + encapsulatedKeySize);
+        if (readFull(in, std::span<unsigned char>(header.data() + STREAM_FIXED_HEADER_SIZE, encapsulatedKeySize)) != encapsulatedKeySize) {
+            throw std::runtime_error("decryptStream: stream is truncated");
+        }
+
+        // Step 2: Decapsulate and derive the stream key
+        const std::vector<uint8_t> encapsulatedKey(header.begin() + STREAM_FIXED_HEADER_SIZE, header.end());
+        std::string sharedSecret = SPHINXHybridKey::decapsulateHybridSharedSecret(keypair, encapsulatedKey);
+        StreamKey streamKey;
+        deriveStreamKey(streamKey, std::span<const unsigned char>(header.data() + 16, STREAM_SALT_SIZE), sharedSecret, header);
+        secureZero(sharedSecret.data(), sharedSecret.size());
+
+        // Step 3: Open the chunks; a chunk that fails authentication (wrong key, tampering, reordering) stops the stream
+        ChunkBuffers buffers(chunkSize + AEAD_TAG_SIZE, chunkSize, false);
+        return runPipeline(in, out, buffers,
+                           [&](uint64_t index, const unsigned char* data, size_t length, bool last, unsigned char* opened) {
+                               if (length < AEAD_TAG_SIZE) {
+                                   throw std::runtime_error("decryptStream: stream is truncated");
+                               }
+                               const size_t plaintextLength = length - AEAD_TAG_SIZE;
+                               AeadTag tag;
+                               std::memcpy(tag.data(), data + plaintextLength, tag.size());
+                               if (!aeadDecrypt(streamKey.key, chunkNonce(index, last), streamKey.headerDigest, std::span<const unsigned char>(data, plaintextLength), tag, opened)) {
+                                   throw std::runtime_error("decryptStream: chunk authentication failed");
+                               }
+                               return plaintextLength;
+                           }, true);
+    }
+} // namespace SPHINXKey
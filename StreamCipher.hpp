@@ -0,0 +1,75 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+#ifndef SPHINX_STREAM_CIPHER_HPP
+#define SPHINX_STREAM_CIPHER_HPP
+
+#pragma once
+
+#include <span>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "Key.hpp"
+
+namespace SPHINXKey {
+
+    // ChaCha20-Poly1305 (RFC 8439) key, nonce and tag sizes
+    constexpr size_t AEAD_KEY_SIZE = 32;
+    constexpr size_t AEAD_NONCE_SIZE = 12;
+    constexpr size_t AEAD_TAG_SIZE = 16;
+
+    using AeadKey = std::array<unsigned char, AEAD_KEY_SIZE>;
+    using AeadNonce = std::array<unsigned char, AEAD_NONCE_SIZE>;
+    using AeadTag = std::array<unsigned char, AEAD_TAG_SIZE>;
+
+    // Function to XOR data into out (same length) with the ChaCha20 keystream starting at block counter (RFC 8439 section 2.4)
+    void chacha20Encrypt(const AeadKey& key, uint32_t counter, const AeadNonce& nonce, std::span<const unsigned char> data, unsigned char* out);
+
+    // Function to compute the Poly1305 tag of a message under a one-time key (RFC 8439 section 2.5)
+    AeadTag poly1305(std::span<const unsigned char, 32> key, std::span<const unsigned char> message);
+
+    // Function to encrypt data into out (same length) with ChaCha20-Poly1305, returns the tag; data and out may be the same buffer
+    AeadTag aeadEncrypt(const AeadKey& key, const AeadNonce& nonce, std::span<const unsigned char> aad, std::span<const unsigned char> data, unsigned char* out);
+
+    // Function to check the tag and decrypt data into out (same length), returns false and writes nothing if the tag does not match
+    bool aeadDecrypt(const AeadKey& key, const AeadNonce& nonce, std::span<const unsigned char> aad, std::span<const unsigned char> data, const AeadTag& tag, unsigned char* out);
+
+    // Plaintext bytes per chunk of an encrypted stream
+    constexpr size_t STREAM_DEFAULT_CHUNK_SIZE = size_t(1) << 20;
+    constexpr size_t STREAM_MAX_CHUNK_SIZE = size_t(1) << 26;
+
+    // Source of a stream: fills the buffer and returns the number of bytes written, fewer than requested only at the end of the stream
+    using StreamReader = std::function<size_t(std::span<unsigned char>)>;
+
+    // Sink of a stream: consumes the whole buffer
+    using StreamWriter = std::function<void(std::span<const unsigned char>)>;
+
+    // Functions to read from and write to a file descriptor (retrying short reads and writes), throw std::system_error on failure
+    StreamReader fdStreamReader(int fd);
+    StreamWriter fdStreamWriter(int fd);
+
+    // Function to encrypt a stream to the recipient's key pair, returns the number of plaintext bytes
+    // Encapsulates once with encapsulateHybridSharedSecret, derives a ChaCha20-Poly1305 key and seals each chunk with its own nonce and tag
+    // Memory use is four chunk buffers, whatever the stream length
+    uint64_t encryptStream(const SPHINXHybridKey::HybridKeypair& recipient, const StreamReader& in, const StreamWriter& out, size_t chunkSize = STREAM_DEFAULT_CHUNK_SIZE);
+
+    // Function to decrypt a stream written by encryptStream, returns the number of plaintext bytes
+    // Every chunk is authenticated before it is written; a corrupted, reordered or truncated stream throws std::runtime_error,
+    // in which case the plaintext already written must be discarded
+    uint64_t decryptStream(const SPHINXHybridKey::HybridKeypair& keypair, const StreamReader& in, const StreamWriter& out);
+} // namespace SPHINXKey
+
+#endif // SPHINX_STREAM_CIPHER_HPP
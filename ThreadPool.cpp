@@ -0,0 +1,208 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code implements the work-stealing thread pool used by the batch APIs of SPHINXKey.
+
+// ThreadPool:
+    // A fixed number of worker threads is started once; each worker owns a deque of tasks.
+    // A worker pops tasks from the back of its own deque (most recently queued, still warm in cache) and, when its deque is empty, steals from the front of the other workers' deques.
+    // Idle workers sleep on a condition variable and are woken when a task is queued.
+
+// parallelFor Function:
+    // Splits [0, count) into chunks of at most grain items and spreads them round-robin over the worker deques.
+    // The calling thread also executes chunks, so a parallelFor issued from inside a worker cannot deadlock the pool.
+    // The call returns when every chunk has run; the first exception thrown by a chunk is rethrown to the caller.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+#include "ThreadPool.hpp"
+
+
+namespace SPHINXKey {
+
+    namespace {
+        // Pool and deque index of the worker running on this thread, if any
+        thread_local const ThreadPool* currentPool = nullptr;
+        thread_local size_t currentIndex = 0;
+    }
+
+    // Function to start the pool
+    ThreadPool::ThreadPool(size_t threadCount) {
+        if (threadCount == 0) {
+            threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+
+        // Create all deques before any worker starts stealing from them
+        workers_.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; ++i) {
+            workers_.push_back(std::make_unique<Worker>());
+        }
+        threads_.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; ++i) {
+            threads_.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    // Function to return the process-wide pool sized to the hardware
+    ThreadPool& ThreadPool::shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    void ThreadPool::push(size_t index, std::function<void()> task) {
+        {
+            // Count the task before releasing the deque: a thief can only take it under this mutex, so its decrement always follows this increment
+            std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+            workers_[index]->tasks.push_back(std::move(task));
+            pending_.fetch_add(1, std::memory_order_release);
+        }
+
+        // Wake after publishing, a sleeper re-checks pending_ under wakeMutex_
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+        }
+        wake_.notify_one();
+    }
+
+    // Function to queue a task
+    void ThreadPool::submit(std::function<void()> task) {
+        const size_t index = (currentPool == this) ? currentIndex : nextQueue_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+        push(index, std::move(task));
+    }
+
+    bool ThreadPool::tryPop(size_t index, std::function<void()>& task) {
+        Worker& worker = *workers_[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty()) {
+            return false;
+        }
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+        return true;
+    }
+
+    bool ThreadPool::trySteal(size_t thief, std::function<void()>& task) {
+        const size_t count = workers_.size();
+        for (size_t offset = 1; offset <= count; ++offset) {
+            Worker& victim = *workers_[(thief + offset) % count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ThreadPool::tryRunOne(size_t self) {
+        std::function<void()> task;
+        if (!tryPop(self, task) && !trySteal(self, task)) {
+            return false;
+        }
+        pending_.fetch_sub(1, std::memory_order_acq_rel);
+        task();
+        return true;
+    }
+
+    void ThreadPool::workerLoop(size_t index) {
+        currentPool = this;
+        currentIndex = index;
+        for (;;) {
+            if (tryRunOne(index)) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            wake_.wait(lock, [this] { return stopping_ || pending_.load(std::memory_order_acquire) > 0; });
+            if (stopping_ && pending_.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+        }
+    }
+
+    // Function to run body(begin, end) over [0, count) in chunks of at most grain items
+    void ThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+        if (count == 0) {
+            return;
+        }
+        grain = std::max<size_t>(1, grain);
+        const size_t chunks = (count + grain - 1) / grain;
+        if (chunks == 1) {
+            body(0, count);
+            return;
+        }
+
+        // Completion state is shared with the tasks: the last one still touches it after the caller may have returned
+        struct ForState {
+            std::atomic<size_t> remaining;
+            std::exception_ptr error;
+            std::mutex errorMutex;
+        };
+        auto state = std::make_shared<ForState>();
+        state->remaining.store(chunks, std::memory_order_relaxed);
+
+        // Spread the chunks round-robin so every worker starts with local work
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            const size_t begin = chunk * grain;
+            const size_t end = std::min(count, begin + grain);
+            push(chunk % workers_.size(), [state, &body, begin, end] {
+                try {
+                    body(begin, end);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(state->errorMutex);
+                    if (!state->error) {
+                        state->error = std::current_exception();
+                    }
+                }
+                if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    state->remaining.notify_all();
+                }
+            });
+        }
+
+        // Help out until no chunk is left to take, then wait for the ones still running elsewhere
+        const size_t self = (currentPool == this) ? currentIndex : 0;
+        while (state->remaining.load(std::memory_order_acquire) > 0 && tryRunOne(self)) {
+        }
+        for (size_t left = state->remaining.load(std::memory_order_acquire); left > 0; left = state->remaining.load(std::memory_order_acquire)) {
+            state->remaining.wait(left, std::memory_order_acquire);
+        }
+
+        if (state->error) {
+            std::rethrow_exception(state->error);
+        }
+    }
+} // namespace SPHINXKey
@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+#ifndef SPHINX_THREAD_POOL_HPP
+#define SPHINX_THREAD_POOL_HPP
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include <condition_variable>
+
+namespace SPHINXKey {
+
+    // Fixed-size thread pool with one task deque per worker
+    // Workers pop their own deque from the back and steal from the front of the others when it runs dry
+    class ThreadPool {
+    public:
+        // Function to start the pool, threadCount of 0 uses the number of hardware threads
+        explicit ThreadPool(size_t threadCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Function to return the number of worker threads
+        size_t size() const { return threads_.size(); }
+
+        // Function to queue a task, tasks queued from a worker go to that worker's own deque
+        void submit(std::function<void()> task);
+
+        // Function to run body(begin, end) over [0, count) in chunks of at most grain items
+        // The calling thread helps execute chunks and the first exception thrown by body is rethrown here
+        void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+        // Function to return the process-wide pool sized to the hardware
+        static ThreadPool& shared();
+
+    private:
+        struct Worker {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        void push(size_t index, std::function<void()> task);
+        bool tryPop(size_t index, std::function<void()>& task);
+        bool trySteal(size_t thief, std::function<void()>& task);
+        bool tryRunOne(size_t self);
+        void workerLoop(size_t index);
+
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::vector<std::thread> threads_;
+        std::atomic<size_t> pending_{0};
+        std::atomic<size_t> nextQueue_{0};
+        std::mutex wakeMutex_;
+        std::condition_variable wake_;
+        bool stopping_ = false;
+    };
+} // namespace SPHINXKey
+
+#endif // SPHINX_THREAD_POOL_HPP
@@ -0,0 +1,301 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code implements a parallel search for contract addresses that start with a chosen Base58 pattern (vanity addresses).
+
+// VanityPrefilter:
+    // An address is '1' for every leading zero byte of the payload (version byte 0x00 + RIPEMD-160 hash + checksum) followed by the Base58 digits of the remaining number N.
+    // The fixed part of the pattern (up to the first '?') therefore fixes the number of leading zero bytes and confines N to one range per possible digit count: [S * 58^m, (S + 1) * 58^m).
+    // The checksum only occupies the low 32 bits of N, so each range is turned into a range of the RIPEMD-160 hash alone, and candidates are rejected on the raw hash bytes before the checksum and Base58 encoding are computed.
+
+// matchesVanityPattern Function:
+    // Compares the start of an address with the pattern, '?' matching any character; this is the final check on every candidate the prefilter accepts.
+
+// VanitySearch:
+    // run() creates a work-stealing ThreadPool with the requested number of threads and keeps it busy with batches of VANITY_BATCH attempts.
+    // A batch generates its key pairs, hashes the merged public keys with SPHINX_256_multi and RIPEMD_160_multi, and runs generateAddress only for the candidates accepted by the prefilter.
+    // The first match stops the search; cancel() and maxAttempts stop it the same way. Batches check the stop flag before every key generation, so run() returns soon after.
+    // Key pairs that did not match are zeroized before their batch returns.
+    // attempts() and attemptsPerSecond() can be read from any thread while the search runs.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <mutex>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+#include <string_view>
+
+#include "Key.hpp"
+#include "Hasher.hpp"
+#include "ThreadPool.hpp"
+#include "KeypairPool.hpp"
+#include "VanitySearch.hpp"
+
+
+namespace SPHINXKey {
+
+    // The prefilter assumes the version byte is the payload's first leading zero byte
+    static_assert(ADDRESS_VERSION_BYTE == 0x00, "VanityPrefilter assumes a zero version byte");
+
+    namespace {
+        // Key pairs per parallelFor chunk, a multiple of every multi-buffer lane count
+        constexpr size_t VANITY_BATCH = 64;
+
+        // Chunks queued per worker and round, so workers that finish early can steal
+        constexpr size_t VANITY_CHUNKS_PER_THREAD = 4;
+
+        // Bits of N (the payload after its leading zero byte) and of the checksum below the hash
+        constexpr size_t VANITY_NUMBER_BITS = 8 * (RIPEMD_160_DIGEST_SIZE + 4);
+
+        // 256-bit unsigned number in little-endian 32-bit limbs, wide enough for every range bound
+        using Wide = std::array<uint32_t, 8>;
+
+        void mulAdd(Wide& value, uint32_t factor, uint32_t addend) {
+            uint64_t carry = addend;
+            for (auto& limb : value) {
+                const uint64_t product = static_cast<uint64_t>(limb) * factor + carry;
+                limb = static_cast<uint32_t>(product);
+                carry = product >> 32;
+            }
+        }
+
+        // Whether value >= 2^VANITY_NUMBER_BITS, the limit of N
+        bool exceedsNumber(const Wide& value) {
+            for (size_t i = VANITY_NUMBER_BITS / 32; i < value.size(); ++i) {
+                if (value[i] != 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void decrement(Wide& value) {
+            for (auto& limb : value) {
+                if (limb-- != 0) {
+                    break;
+                }
+            }
+        }
+    } // namespace
+
+    // Function to build the prefilter
+    VanityPrefilter::VanityPrefilter(std::string_view pattern) {
+        if (pattern.empty() || (pattern[0] != '1' && pattern[0] != '?')) {
+            throw std::invalid_argument("VanityPrefilter: addresses with version byte 0x00 start with '1'");
+        }
+        for (char c : pattern) {
+            if (c != '?' && base58_chars.find(c) == std::string::npos) {
+                throw std::invalid_argument("VanityPrefilter: pattern has characters outside base58_chars");
+            }
+        }
+        if (pattern.size() > ADDRESS_MAX_LENGTH) {
+            throw std::invalid_argument("VanityPrefilter: pattern is longer than an address");
+        }
+
+        // Step 1: Split the fixed part of the pattern into its leading '1's (zero bytes) and the digits S of N
+        const std::string_view fixed = pattern.substr(0, pattern.find('?'));
+        const size_t ones = std::min(fixed.find_first_not_of('1'), fixed.size());
+        const std::string_view digits = fixed.substr(ones);
+        if (ones == 0) {
+            // The pattern starts with '?', nothing is known before encoding
+            return;
+        }
+        zeroBytes_ = ones - 1;
+        exactZeroBytes_ = !digits.empty();
+        if (zeroBytes_ > RIPEMD_160_DIGEST_SIZE) {
+            throw std::invalid_argument("VanityPrefilter: too many leading '1's");
+        }
+        if (digits.empty()) {
+            return;
+        }
+
+        // Step 2: For every digit count m after S, N lies in [S * 58^m, (S + 1) * 58^m); keep the ranges below 2^192
+        Wide low{};
+        for (char c : digits) {
+            mulAdd(low, 58, static_cast<uint32_t>(base58_chars.find(c)));
+        }
+        Wide high = low;
+        mulAdd(high, 1, 1);
+        while (!exceedsNumber(low)) {
+            Wide last = high;
+            if (exceedsNumber(last)) {
+                last = Wide{};
+                last[VANITY_NUMBER_BITS / 32] = 1;
+            }
+            decrement(last);
+
+            // Step 3: Drop the 32 checksum bits to get the range of the hash itself
+            Limbs160 hashLow;
+            Limbs160 hashHigh;
+            for (size_t i = 0; i < hashLow.size(); ++i) {
+                hashLow[i] = low[i + 1];
+                hashHigh[i] = last[i + 1];
+            }
+            ranges_.emplace_back(hashLow, hashHigh);
+
+            mulAdd(low, 58, 0);
+            mulAdd(high, 58, 0);
+        }
+    }
+
+    // Function to test whether an address built from this RIPEMD-160 hash can start with the pattern's fixed part
+    bool VanityPrefilter::accepts(const unsigned char* ripemd160Hash) const {
+        // Leading zero bytes of the hash become leading '1's after the version byte's '1'
+        const unsigned char* firstNonZero = std::find_if(ripemd160Hash, ripemd160Hash + RIPEMD_160_DIGEST_SIZE, [](unsigned char b) { return b != 0; });
+        const size_t zeroBytes = static_cast<size_t>(firstNonZero - ripemd160Hash);
+        if (zeroBytes < zeroBytes_ || (exactZeroBytes_ && zeroBytes != zeroBytes_)) {
+            return false;
+        }
+        if (ranges_.empty()) {
+            return true;
+        }
+
+        Limbs160 hash;
+        for (size_t i = 0; i < hash.size(); ++i) {
+            const unsigned char* p = ripemd160Hash + 4 * (hash.size() - 1 - i);
+            hash[i] = (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+        }
+        auto lessOrEqual = [](const Limbs160& a, const Limbs160& b) {
+            for (size_t i = a.size(); i-- > 0;) {
+                if (a[i] != b[i]) {
+                    return a[i] < b[i];
+                }
+            }
+            return true;
+        };
+        return std::any_of(ranges_.begin(), ranges_.end(), [&](const auto& range) {
+            return lessOrEqual(range.first, hash) && lessOrEqual(hash, range.second);
+        });
+    }
+
+    // Function to test whether an address starts with a pattern
+    bool matchesVanityPattern(std::string_view address, std::string_view pattern) {
+        if (address.size() < pattern.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            if (pattern[i] != '?' && pattern[i] != address[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Function to prepare a search
+    VanitySearch::VanitySearch(VanityOptions options, Generator generate)
+        : options_(std::move(options)),
+          generate_(std::move(generate)),
+          prefilter_(options_.pattern) {
+    }
+
+    // Function to stop the search from any thread
+    void VanitySearch::cancel() {
+        stop_.store(true, std::memory_order_release);
+    }
+
+    // Function to report the attempt rate of the running (or finished) search
+    double VanitySearch::attemptsPerSecond() const {
+        const auto started = startTicks_.load(std::memory_order_acquire);
+        if (started == 0) {
+            return 0.0;
+        }
+        const auto elapsed = std::chrono::steady_clock::now().time_since_epoch().count() - started;
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::duration(elapsed)).count();
+        return seconds > 0.0 ? static_cast<double>(attempts()) / seconds : 0.0;
+    }
+
+    void VanitySearch::searchBatch(size_t count) {
+        // Step 1: Generate the key pairs, checking the stop flag before each one
+        std::vector<SPHINXHybridKey::HybridKeypair> keypairs;
+        keypairs.reserve(count);
+        while (keypairs.size() < count && !stop_.load(std::memory_order_acquire)) {
+            keypairs.push_back(generate_());
+        }
+        const size_t n = keypairs.size();
+        const uint64_t total = attempts_.fetch_add(n, std::memory_order_relaxed) + n;
+        if (options_.maxAttempts != 0 && total >= options_.maxAttempts) {
+            stop_.store(true, std::memory_order_release);
+        }
+
+        // Step 2: Hash the merged public keys in SIMD lanes
+        std::array<const unsigned char*, VANITY_BATCH> messages;
+        std::array<unsigned char, VANITY_BATCH * SPHINX_256_DIGEST_SIZE> sphinxHashes;
+        std::array<unsigned char, VANITY_BATCH * RIPEMD_160_DIGEST_SIZE> ripemd160Hashes;
+        for (size_t i = 0; i < n; ++i) {
+            messages[i] = keypairs[i].merged_key.sphinxPubKey.data();
+        }
+        SPHINXHash::SPHINX_256_multi(messages.data(), SPHINX_256_DIGEST_SIZE, n, sphinxHashes.data());
+        SPHINXHash::RIPEMD_160_multi(std::span<const unsigned char>(sphinxHashes.data(), n * SPHINX_256_DIGEST_SIZE), SPHINX_256_DIGEST_SIZE, ripemd160Hashes.data());
+
+        // Step 3: Encode only the candidates the prefilter accepts and check them against the full pattern
+        for (size_t i = 0; i < n; ++i) {
+            if (!prefilter_.accepts(ripemd160Hashes.data() + i * RIPEMD_160_DIGEST_SIZE)) {
+                continue;
+            }
+            encoded_.fetch_add(1, std::memory_order_relaxed);
+            const SPHINXAddress address = generateAddress(keypairs[i].merged_key.sphinxPubKey, options_.contractName);
+            if (!matchesVanityPattern(address.view(), options_.pattern)) {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(resultMutex_);
+            if (!result_.found) {
+                result_.found = true;
+                result_.keypair = keypairs[i];
+                result_.address = address;
+            }
+            stop_.store(true, std::memory_order_release);
+            break;
+        }
+
+        // Step 4: Zeroize the key pairs of this batch, the match has been copied out
+        for (auto& keypair : keypairs) {
+            wipeKeypair(keypair);
+        }
+    }
+
+    // Function to run the search until a match, cancel() or maxAttempts
+    VanityResult VanitySearch::run() {
+        const auto started = std::chrono::steady_clock::now();
+        startTicks_.store(started.time_since_epoch().count(), std::memory_order_release);
+
+        // Queue a few chunks per worker each round so faster workers steal from slower ones
+        ThreadPool pool(options_.threadCount);
+        const size_t chunks = VANITY_CHUNKS_PER_THREAD * pool.size();
+        while (!stop_.load(std::memory_order_acquire)) {
+            pool.parallelFor(chunks * VANITY_BATCH, VANITY_BATCH, [this](size_t begin, size_t end) {
+                if (!stop_.load(std::memory_order_acquire)) {
+                    searchBatch(end - begin);
+                }
+            });
+        }
+
+        std::lock_guard<std::mutex> lock(resultMutex_);
+        VanityResult result = result_;
+        wipeKeypair(result_.keypair);
+        result.attempts = attempts();
+        result.encoded = encoded_.load(std::memory_order_relaxed);
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        result.attemptsPerSecond = result.seconds > 0.0 ? static_cast<double>(result.attempts) / result.seconds : 0.0;
+        return result;
+    }
+} // namespace SPHINXKey
@@ -0,0 +1,114 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+#ifndef SPHINX_VANITY_SEARCH_HPP
+#define SPHINX_VANITY_SEARCH_HPP
+
+#pragma once
+
+#include <mutex>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+#include "Key.hpp"
+
+namespace SPHINXKey {
+
+    // Search parameters
+    // pattern is matched against the start of the address; '?' matches any character and every other character must be in base58_chars
+    // Addresses with version byte 0x00 start with '1', so the pattern must as well
+    struct VanityOptions {
+        std::string pattern;
+        std::string contractName;
+        size_t threadCount = 0;     // 0 uses the number of hardware threads
+        uint64_t maxAttempts = 0;   // 0 searches until a match is found or the search is cancelled
+    };
+
+    // Outcome of VanitySearch::run
+    struct VanityResult {
+        bool found = false;
+        SPHINXHybridKey::HybridKeypair keypair;   // Valid when found
+        SPHINXAddress address;                     // Valid when found
+        uint64_t attempts = 0;                     // Key pairs generated
+        uint64_t encoded = 0;                      // Candidates that passed the hash prefilter and were Base58 encoded
+        double seconds = 0.0;
+        double attemptsPerSecond = 0.0;
+    };
+
+    // Prefilter derived from the fixed leading part of a pattern
+    // It checks the RIPEMD-160 hash of a candidate against the numeric ranges whose Base58 form starts with that part,
+    // so almost every candidate is rejected before its checksum and Base58 encoding are computed
+    class VanityPrefilter {
+    public:
+        // Function to build the prefilter, throws std::invalid_argument on patterns no address can match
+        explicit VanityPrefilter(std::string_view pattern);
+
+        // Function to test whether an address built from this RIPEMD-160 hash can start with the pattern's fixed part
+        bool accepts(const unsigned char* ripemd160Hash) const;
+
+    private:
+        using Limbs160 = std::array<uint32_t, 5>;
+
+        size_t zeroBytes_ = 0;       // Leading zero bytes required in the RIPEMD-160 hash
+        bool exactZeroBytes_ = false;
+        std::vector<std::pair<Limbs160, Limbs160>> ranges_;   // Inclusive ranges of the hash as a 160-bit number
+    };
+
+    // Function to test whether an address starts with a pattern ('?' matches any character)
+    bool matchesVanityPattern(std::string_view address, std::string_view pattern);
+
+    // Parallel vanity address search
+    // Key generation and address derivation run in batches on a work-stealing ThreadPool; each batch hashes its public keys
+    // with the multi-buffer hashers and only encodes the candidates accepted by the VanityPrefilter
+    class VanitySearch {
+    public:
+        using Generator = std::function<SPHINXHybridKey::HybridKeypair()>;
+
+        // Function to prepare a search, throws std::invalid_argument on an invalid pattern
+        explicit VanitySearch(VanityOptions options, Generator generate = generate_hybrid_keypair);
+
+        // Function to run the search on the calling thread until a match, cancel() or maxAttempts; a search runs once
+        VanityResult run();
+
+        // Function to stop the search from any thread, run() returns once the batches in flight have wound down
+        void cancel();
+
+        // Functions to report progress while run() is in flight
+        uint64_t attempts() const { return attempts_.load(std::memory_order_relaxed); }
+        double attemptsPerSecond() const;
+
+    private:
+        void searchBatch(size_t count);
+
+        VanityOptions options_;
+        Generator generate_;
+        VanityPrefilter prefilter_;
+
+        std::atomic<bool> stop_{false};
+        std::atomic<uint64_t> attempts_{0};
+        std::atomic<uint64_t> encoded_{0};
+        std::atomic<std::chrono::steady_clock::rep> startTicks_{0};
+
+        std::mutex resultMutex_;
+        VanityResult result_;
+    };
+} // namespace SPHINXKey
+
+#endif // SPHINX_VANITY_SEARCH_HPP
@@ -0,0 +1,431 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code benchmarks every stage of SPHINXKey key and address generation and prints the results as JSON.
+
+// Build (from the repository root, linking the offline stand-ins for SPHINXHybridKey):
+    // g++ -std=c++20 -O2 -pthread -DSPHINX_KEY_NO_MAIN -Ibench/standin -I. bench/Benchmark.cpp bench/HybridKeyStandIn.cpp Key.cpp Hasher.cpp ThreadPool.cpp SecureArena.cpp Serialization.cpp HybridKem.cpp -o sphinx_bench
+
+// Usage:
+    // sphinx_bench [--filter <substring>] [--min-time <ms>] [--repetitions <n>] [--out <file>]
+    // --filter runs only the benchmarks whose name contains the substring, --min-time is the minimum duration of one repetition,
+    // --repetitions is the number of timed repetitions per case and --out writes the JSON to a file instead of stdout.
+
+// Stages:
+    // generate_hybrid_keypair, mergePrivateKeys, mergePublicKeys, calculatePublicKey, generateAddress, EncodeBase58 (next to the encoder it replaced, on the 8-byte payloads that one handles), decodeAddress, hexEncodeKeys and the KEM encapsulate / decapsulate pair,
+    // each at batch size 1 and at larger batch sizes; the batched address generation and validation, key generation and KEM paths are also run on 1, 2, 4, ... threads up to the hardware thread count.
+    // Note that generate_hybrid_keypair and the KEM run against the stand-ins in bench/HybridKeyStandIn.cpp, so they measure the SPHINXKey side only.
+
+// Output:
+    // One JSON object with the build and machine description and one entry per case: name, batch, threads, repetitions, iterations per repetition,
+    // and the median / min / max nanoseconds per item plus items per second (from the median). Results from two releases can be diffed by name, batch and threads.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <thread>
+#include <functional>
+#include <string_view>
+
+#include "Hybrid_key.hpp"
+#include "Key.hpp"
+#include "Hasher.hpp"
+#include "ThreadPool.hpp"
+#include "HybridKem.hpp"
+#include "Serialization.hpp"
+
+
+namespace {
+
+    // Keep the compiler from discarding a result
+    template <typename T>
+    inline void doNotOptimize(const T& value) {
+        asm volatile("" : : "r"(&value) : "memory");
+    }
+
+    // Escape a string for a JSON string literal
+    std::string jsonEscape(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    // The EncodeBase58 that the multi-precision codec replaced, kept as a baseline
+    // It packs the whole input into one uint64_t, so it only works for payloads of at most 8 bytes, and it pads its output with '1' to a fixed width
+    std::string legacyEncodeBase58(const std::vector<unsigned char>& data) {
+        // Count leading zeros
+        size_t zeros_count = 0;
+        for (const unsigned char byte : data) {
+            if (byte != 0) {
+                break;
+            }
+            ++zeros_count;
+        }
+
+        // Convert the data to a big-endian number
+        uint64_t num = 0;
+        for (size_t i = zeros_count; i < data.size(); ++i) {
+            num = num * 256 + data[i];
+        }
+
+        // Calculate the necessary length for the encoded string
+        size_t encoded_length = (data.size() - zeros_count) * 138 / 100 + 1;
+        std::string encoded(encoded_length, '1');
+
+        // Encode the big-endian number in Base58
+        for (size_t i = 0; num > 0; ++i) {
+            const uint64_t remainder = num % 58;
+            num /= 58;
+            encoded[encoded_length - i - 1] = base58_chars[remainder];
+        }
+
+        return encoded;
+    }
+
+    struct BenchOptions {
+        std::string filter;
+        double minTimeMs = 50.0;
+        size_t repetitions = 5;
+        std::string out;
+    };
+
+    struct BenchResult {
+        std::string name;
+        size_t batch;
+        size_t threads;
+        size_t repetitions;
+        uint64_t iterations;
+        double medianNs;
+        double minNs;
+        double maxNs;
+    };
+
+    class BenchRunner {
+    public:
+        explicit BenchRunner(const BenchOptions& options) : options_(options) {}
+
+        // Function to time body, which processes batch items per call, and record the nanoseconds per item
+        void run(const std::string& name, size_t batch, size_t threads, const std::function<void()>& body) {
+            if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos) {
+                return;
+            }
+
+            // Step 1: Warm up and calibrate the number of calls that fills min-time
+            using Clock = std::chrono::steady_clock;
+            uint64_t iterations = 1;
+            for (;;) {
+                const auto start = Clock::now();
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    body();
+                }
+                const double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+                if (elapsedMs >= options_.minTimeMs || iterations >= (uint64_t(1) << 30)) {
+                    break;
+                }
+                iterations = elapsedMs <= 0.0 ? iterations * 10 : std::max<uint64_t>(iterations + 1, static_cast<uint64_t>(iterations * options_.minTimeMs * 1.2 / elapsedMs));
+            }
+
+            // Step 2: Timed repetitions
+            std::vector<double> perItem;
+            perItem.reserve(options_.repetitions);
+            for (size_t r = 0; r < options_.repetitions; ++r) {
+                const auto start = Clock::now();
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    body();
+                }
+                const double elapsedNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+                perItem.push_back(elapsedNs / static_cast<double>(iterations * batch));
+            }
+            std::sort(perItem.begin(), perItem.end());
+
+            results_.push_back(BenchResult{name, batch, threads, perItem.size(), iterations, perItem[perItem.size() / 2], perItem.front(), perItem.back()});
+            std::cerr << name << " batch=" << batch << " threads=" << threads << ": " << results_.back().medianNs << " ns/item" << std::endl;
+        }
+
+        // Function to write the results as JSON
+        void writeJson(std::ostream& out) const {
+            out << "{\n";
+            out << "  \"schema\": 1,\n";
+#if defined(__VERSION__)
+            out << "  \"compiler\": \"" << jsonEscape(__VERSION__) << "\",\n";
+#endif
+            out << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+            out << "  \"multi_buffer_lanes\": " << SPHINXHash::multiBufferLanes(SPHINXHash::multiBufferKernel()) << ",\n";
+            out << "  \"min_time_ms\": " << options_.minTimeMs << ",\n";
+            out << "  \"benchmarks\": [\n";
+            for (size_t i = 0; i < results_.size(); ++i) {
+                const BenchResult& r = results_[i];
+                const double itemsPerSecond = r.medianNs > 0.0 ? 1e9 / r.medianNs : 0.0;
+                out << "    {\"name\": \"" << jsonEscape(r.name) << "\", \"batch\": " << r.batch << ", \"threads\": " << r.threads
+                    << ", \"repetitions\": " << r.repetitions << ", \"iterations\": " << r.iterations
+                    << ", \"ns_per_item_median\": " << r.medianNs << ", \"ns_per_item_min\": " << r.minNs
+                    << ", \"ns_per_item_max\": " << r.maxNs << ", \"items_per_second\": " << itemsPerSecond << "}"
+                    << (i + 1 < results_.size() ? "," : "") << "\n";
+            }
+            out << "  ]\n";
+            out << "}\n";
+        }
+
+    private:
+        const BenchOptions& options_;
+        std::vector<BenchResult> results_;
+    };
+
+    // Batch sizes of the batched cases and thread counts of the scaling cases
+    const std::vector<size_t> BATCH_SIZES = {1, 64, 1024};
+    constexpr size_t SCALING_BATCH = 4096;
+
+    std::vector<size_t> threadCounts() {
+        std::vector<size_t> counts;
+        const size_t hardware = std::max<unsigned>(1, std::thread::hardware_concurrency());
+        for (size_t threads = 1; threads < hardware; threads *= 2) {
+            counts.push_back(threads);
+        }
+        counts.push_back(hardware);
+        return counts;
+    }
+
+    template <typename Key>
+    std::vector<Key> makeKeys(size_t count, unsigned char seed) {
+        std::vector<Key> keys(count);
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t j = 0; j < keys[i].size(); ++j) {
+                keys[i][j] = static_cast<unsigned char>(seed + i * 31 + j * 7);
+            }
+        }
+        return keys;
+    }
+
+    void runBenchmarks(BenchRunner& runner) {
+        using namespace SPHINXKey;
+        const size_t maxBatch = std::max(SCALING_BATCH, *std::max_element(BATCH_SIZES.begin(), BATCH_SIZES.end()));
+        const auto curvePriv = makeKeys<Curve448PrivKey>(maxBatch, 1);
+        const auto curvePub = makeKeys<Curve448PubKey>(maxBatch, 2);
+        const auto kyberPriv = makeKeys<KyberPrivKey>(maxBatch, 3);
+        const auto kyberPub = makeKeys<KyberPubKey>(maxBatch, 4);
+        const auto sphinxPub = makeKeys<SPHINXPubKey>(maxBatch, 5);
+        const auto payloads = makeKeys<std::array<unsigned char, ADDRESS_PAYLOAD_SIZE>>(maxBatch, 6);
+
+        // Stage: key generation and merging
+        for (size_t batch : BATCH_SIZES) {
+            runner.run("generate_hybrid_keypair", batch, 1, [&] {
+                for (size_t i = 0; i < batch; ++i) {
+                    doNotOptimize(generate_hybrid_keypair());
+                }
+            });
+            runner.run("mergePrivateKeys", batch, 1, [&] {
+                for (size_t i = 0; i < batch; ++i) {
+                    doNotOptimize(mergePrivateKeys(curvePriv[i], kyberPriv[i]));
+                }
+            });
+            runner.run("mergePublicKeys", batch, 1, [&] {
+                for (size_t i = 0; i < batch; ++i) {
+                    doNotOptimize(mergePublicKeys(curvePub[i], kyberPub[i]));
+                }
+            });
+            runner.run("calculatePublicKey", batch, 1, [&] {
+                for (size_t i = 0; i < batch; ++i) {
+                    doNotOptimize(calculatePublicKey(kyberPriv[i]));
+                }
+            });
+        }
+
+        // Stage: address derivation and Base58
+        std::vector<SPHINXAddress> addresses(maxBatch);
+        std::vector<char> encoded(maxBatch * ADDRESS_MAX_LENGTH);
+        std::vector<size_t> lengths(maxBatch);
+        for (size_t batch : BATCH_SIZES) {
+            runner.run("generateAddress", batch, 1, [&] {
+                for (size_t i = 0; i < batch; ++i) {
+                    doNotOptimize(generateAddress(sphinxPub[i], ""));
+                }
+            });
+            runner.run("generateAddresses/serial", batch, 1, [&] {
+                generateAddresses(std::span<const SPHINXPubKey>(sphinxPub.data(), batch), "", std::span<SPHINXAddress>(addresses.data(), batch));
+                doNotOptimize(addresses);
+            });
+            runner.run("EncodeBase58", batch, 1, [&] {
+                for (size_t i = 0; i < batch; ++i) {
+                    doNotOptimize(EncodeBase58(payloads[i].data(), payloads[i].size(), encoded.data(), ADDRESS_MAX_LENGTH));
+                }
+            });
+            runner.run("EncodeBase58Batch", batch, 1, [&] {
+                EncodeBase58Batch(payloads[0].data(), ADDRESS_PAYLOAD_SIZE, batch, encoded.data(), ADDRESS_MAX_LENGTH, lengths.data());
+                doNotOptimize(encoded);
+            });
+        }
+
+        // Stage: Base58 against the legacy encoder, on 8-byte payloads (the largest it encodes correctly)
+        constexpr size_t LEGACY_PAYLOAD_SIZE = 8;
+        std::vector<std::vector<unsigned char>> shortPayloads(maxBatch);
+        for (size_t i = 0; i < maxBatch; ++i) {
+            shortPayloads[i].assign(payloads[i].begin(), payloads[i].begin() + LEGACY_PAYLOAD_SIZE);
+            shortPayloads[i][0] |= 0x80;
+        }
+        std::vector<unsigned char> shortPayloadBytes(maxBatch * LEGACY_PAYLOAD_SIZE);
+        for (size_t i = 0; i < maxBatch; ++i) {
+            std::copy(shortPayloads[i].begin(), shortPayloads[i].end(), shortPayloadBytes.begin() + i * LEGACY_PAYLOAD_SIZE);
+        }
+        constexpr size_t SHORT_STRIDE = Base58MaxEncodedLength(LEGACY_PAYLOAD_SIZE);
+        for (size_t batch : BATCH_SIZES) {
+            runner.run("EncodeBase58/legacy-8", batch, 1, [&] {
+                for (size_t i = 0; i < batch; ++i) {
+                    doNotOptimize(legacyEncodeBase58(shortPayloads[i]));
+                }
+            });
+            runner.run("EncodeBase58/string-8", batch, 1, [&] {
+                for (size_t i = 0; i < batch; ++i) {
+                    doNotOptimize(EncodeBase58(shortPayloads[i]));
+                }
+            });
+            runner.run("EncodeBase58/buffer-8", batch, 1, [&] {
+                for (size_t i = 0; i < batch; ++i) {
+                    doNotOptimize(EncodeBase58(shortPayloads[i].data(), LEGACY_PAYLOAD_SIZE, encoded.data(), SHORT_STRIDE));
+                }
+            });
+            runner.run("EncodeBase58Batch-8", batch, 1, [&] {
+                EncodeBase58Batch(shortPayloadBytes.data(), LEGACY_PAYLOAD_SIZE, batch, encoded.data(), SHORT_STRIDE, lengths.data());
+                doNotOptimize(encoded);
+            });
+        }
+
+        // Stage: hex export
+        std::vector<char> hexLines(maxBatch * (2 * SPHINX_256_DIGEST_SIZE + 1));
+        for (size_t batch : BATCH_SIZES) {
+            runner.run("hexEncodeKeys", batch, 1, [&] {
+                doNotOptimize(hexEncodeKeys(std::span<const SPHINXPubKey>(sphinxPub.data(), batch), hexLines));
+            });
+        }
+
+        // Stage: address validation
+        generateAddresses(std::span<const SPHINXPubKey>(sphinxPub.data(), maxBatch), "", std::span<SPHINXAddress>(addresses.data(), maxBatch));
+        std::vector<std::string_view> addressViews(maxBatch);
+        for (size_t i = 0; i < maxBatch; ++i) {
+            addressViews[i] = addresses[i].view();
+        }
+        std::vector<AddressStatus> statuses(maxBatch);
+        std::vector<SPHINXHash::RIPEMD160Digest> decodedHashes(maxBatch);
+        for (size_t batch : BATCH_SIZES) {
+            runner.run("decodeAddress", batch, 1, [&] {
+                SPHINXHash::RIPEMD160Digest hash;
+                for (size_t i = 0; i < batch; ++i) {
+                    doNotOptimize(decodeAddress(addressViews[i], hash));
+                }
+            });
+        }
+
+        const SPHINXHybridKey::HybridKeypair keypair = generate_hybrid_keypair();
+        std::vector<uint8_t> encapsulatedKey;
+        for (size_t batch : BATCH_SIZES) {
+            runner.run("encapsulateHybridSharedSecret", batch, 1, [&] {
+                for (size_t i = 0; i < batch; ++i) {
+                    doNotOptimize(SPHINXHybridKey::encapsulateHybridSharedSecret(keypair, encapsulatedKey));
+                }
+            });
+            runner.run("decapsulateHybridSharedSecret", batch, 1, [&] {
+                for (size_t i = 0; i < batch; ++i) {
+                    doNotOptimize(SPHINXHybridKey::decapsulateHybridSharedSecret(keypair, encapsulatedKey));
+                }
+            });
+        }
+
+        // Thread scaling of the batched paths
+        const std::vector<SPHINXHybridKey::HybridKeypair> recipients(SCALING_BATCH, keypair);
+        std::vector<HybridEncapsulation> encapsulations(SCALING_BATCH);
+        encapsulateHybridSharedSecrets(recipients, encapsulations);
+        std::vector<std::vector<uint8_t>> encapsulatedKeys(SCALING_BATCH);
+        for (size_t i = 0; i < SCALING_BATCH; ++i) {
+            encapsulatedKeys[i] = encapsulations[i].encapsulatedKey;
+        }
+        std::vector<std::string> sharedSecrets(SCALING_BATCH);
+        std::vector<char> arenaBuffer(SCALING_BATCH * ADDRESS_MAX_LENGTH);
+        std::vector<AddressSlot> arenaSlots(SCALING_BATCH);
+        AddressArena arena{arenaBuffer, arenaSlots};
+        for (size_t threads : threadCounts()) {
+            ThreadPool pool(threads);
+            runner.run("generateAddresses/completion", SCALING_BATCH, threads, [&] {
+                doNotOptimize(generateAddresses(std::span<const SPHINXPubKey>(sphinxPub.data(), SCALING_BATCH), "", arena, AddressOrder::Completion, pool));
+            });
+            runner.run("generateAddresses/deterministic", SCALING_BATCH, threads, [&] {
+                doNotOptimize(generateAddresses(std::span<const SPHINXPubKey>(sphinxPub.data(), SCALING_BATCH), "", arena, AddressOrder::Deterministic, pool));
+            });
+            runner.run("validateAddresses", SCALING_BATCH, threads, [&] {
+                validateAddresses(std::span<const std::string_view>(addressViews.data(), SCALING_BATCH), statuses, decodedHashes, pool);
+                doNotOptimize(statuses);
+            });
+            runner.run("generate_hybrid_keypair/parallel", SCALING_BATCH, threads, [&] {
+                pool.parallelFor(SCALING_BATCH, 64, [](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        doNotOptimize(generate_hybrid_keypair());
+                    }
+                });
+            });
+            runner.run("encapsulateHybridSharedSecrets", SCALING_BATCH, threads, [&] {
+                encapsulateHybridSharedSecrets(recipients, encapsulations, pool);
+                doNotOptimize(encapsulations);
+            });
+            runner.run("decapsulateHybridSharedSecrets", SCALING_BATCH, threads, [&] {
+                decapsulateHybridSharedSecrets(keypair, encapsulatedKeys, sharedSecrets, pool);
+                doNotOptimize(sharedSecrets);
+            });
+        }
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return 1;
+        }
+        if (arg == "--filter") {
+            options.filter = argv[++i];
+        } else if (arg == "--min-time") {
+            options.minTimeMs = std::stod(argv[++i]);
+        } else if (arg == "--repetitions") {
+            options.repetitions = std::max<size_t>(1, std::stoul(argv[++i]));
+        } else if (arg == "--out") {
+            options.out = argv[++i];
+        } else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    BenchRunner runner(options);
+    runBenchmarks(runner);
+
+    if (options.out.empty()) {
+        runner.writeJson(std::cout);
+    } else {
+        std::ofstream file(options.out);
+        runner.writeJson(file);
+    }
+    return 0;
+}
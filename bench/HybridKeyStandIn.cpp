@@ -0,0 +1,115 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code is a stand-in for the SPHINXHybridKey functions (hybrid_key.cpp) so that the benchmarks build and run offline.
+
+// Key generation:
+    // The Curve448 and Kyber1024 generators fill their fixed-size keys from a per-thread xorshift generator, so they cost roughly one memory write per byte.
+    // Benchmarks of generate_hybrid_keypair therefore measure the SPHINXKey side (merging, hashing, copies) plus that fill, not real Curve448 / Kyber1024 key generation.
+
+// KEM and PKE:
+    // encapsulateHybridSharedSecret writes a Kyber1024-sized ciphertext derived from the merged public key and returns SPHINX_256 of it; decapsulateHybridSharedSecret recomputes that digest.
+    // encryptMessage and decryptMessage XOR the message with a keystream derived from the key.
+
+// None of these functions are cryptographically meaningful; they must never be linked into a release build.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <span>
+
+#include "Hybrid_key.hpp"
+#include "Key.hpp"
+#include "Hasher.hpp"
+
+
+namespace SPHINXHybridKey {
+
+    namespace {
+        // Kyber1024 ciphertext length
+        constexpr size_t KYBER1024_CIPHERTEXT_LENGTH = SPHINXKey::DefaultParameterSet::KEM_CIPHERTEXT_LENGTH;
+
+        uint64_t nextRandom() {
+            thread_local uint64_t state = 0x9e3779b97f4a7c15ull ^ reinterpret_cast<uintptr_t>(&state);
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+
+        template <typename Key>
+        Key randomKey() {
+            Key key;
+            for (auto& byte : key) {
+                byte = static_cast<unsigned char>(nextRandom());
+            }
+            return key;
+        }
+
+        std::string applyKeystream(const std::string& input, std::span<const uint8_t> key) {
+            std::string output = input;
+            SPHINXHash::SPHINX256Digest block = SPHINXHash::SPHINX_256(key);
+            for (size_t i = 0; i < output.size(); ++i) {
+                if (i > 0 && i % block.size() == 0) {
+                    block = SPHINXHash::SPHINX_256(block);
+                }
+                output[i] = static_cast<char>(output[i] ^ block[i % block.size()]);
+            }
+            return output;
+        }
+    } // namespace
+
+    SPHINXKey::Curve448PrivKey generateCurve448PrivateKey() {
+        return randomKey<SPHINXKey::Curve448PrivKey>();
+    }
+
+    SPHINXKey::Curve448PubKey generateCurve448PublicKey() {
+        return randomKey<SPHINXKey::Curve448PubKey>();
+    }
+
+    SPHINXKey::KyberPrivKey generateKyberPrivateKey() {
+        return randomKey<SPHINXKey::KyberPrivKey>();
+    }
+
+    SPHINXKey::KyberPubKey generateKyberPublicKey() {
+        return randomKey<SPHINXKey::KyberPubKey>();
+    }
+
+    std::string encapsulateHybridSharedSecret(const HybridKeypair& hybridKeyPair, std::vector<uint8_t>& encapsulatedKey) {
+        encapsulatedKey.resize(KYBER1024_CIPHERTEXT_LENGTH);
+        SPHINXHash::SPHINX256Digest block = SPHINXHash::SPHINX_256(hybridKeyPair.merged_key.sphinxPubKey);
+        for (size_t i = 0; i < encapsulatedKey.size(); ++i) {
+            if (i > 0 && i % block.size() == 0) {
+                block = SPHINXHash::SPHINX_256(block);
+            }
+            encapsulatedKey[i] = block[i % block.size()];
+        }
+        return decapsulateHybridSharedSecret(hybridKeyPair, encapsulatedKey);
+    }
+
+    std::string decapsulateHybridSharedSecret(const HybridKeypair&, const std::vector<uint8_t>& encapsulatedKey) {
+        const SPHINXHash::SPHINX256Digest secret = SPHINXHash::SPHINX_256(encapsulatedKey);
+        return std::string(secret.begin(), secret.end());
+    }
+
+    std::string encryptMessage(const std::string& message, std::span<const uint8_t> publicKey) {
+        return applyKeystream(message, publicKey);
+    }
+
+    std::string decryptMessage(const std::string& ciphertext, std::span<const uint8_t> privateKey) {
+        return applyKeystream(ciphertext, privateKey);
+    }
+} // namespace SPHINXHybridKey
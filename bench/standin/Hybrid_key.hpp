@@ -0,0 +1,22 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+// Stand-in for "Hybrid_key.hpp" from SPHINXHybridKey so the benchmarks build offline
+// The key generation, KEM and PKE functions themselves are in bench/HybridKeyStandIn.cpp
+
+#ifndef SPHINX_BENCH_STANDIN_HYBRID_KEY_HPP
+#define SPHINX_BENCH_STANDIN_HYBRID_KEY_HPP
+
+#pragma once
+
+#endif // SPHINX_BENCH_STANDIN_HYBRID_KEY_HPP
@@ -0,0 +1,16 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+// Stand-in for "hash/Ripmed160.hpp" so the benchmarks build offline
+// SPHINXKey only needs Hasher.hpp and its own Base58 codec, so this header is intentionally empty
+#pragma once
@@ -0,0 +1,342 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code checks the address index (AddressIndex.hpp).
+
+// Build and run (from the repository root, linking the offline stand-ins for SPHINXHybridKey):
+    // g++ -std=c++20 -O2 -pthread -DSPHINX_KEY_NO_MAIN -Ibench/standin -I. tests/AddressIndexTest.cpp bench/HybridKeyStandIn.cpp AddressIndex.cpp Keystore.cpp Key.cpp Hasher.cpp ThreadPool.cpp SecureArena.cpp Serialization.cpp HybridKem.cpp -o address_index_test && ./address_index_test
+
+// Lookups:
+    // Every indexed hash is found with its value (a repeated hash keeps its first value) and absent hashes are not, through the single lookup, the batch lookup
+    // and the ThreadPool batch lookup, before and after save / open. The keystore overload maps every address to its first record.
+
+// Headers:
+    // Headers with a recomputed checksum but Bloom or table sizes that do not fit the file (including sizes whose byte counts would wrap), a count above the 75% load factor,
+    // or misplaced sections are rejected. A table with no empty slot, which only a crafted file can have, must still end every lookup.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <span>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
+
+#include <unistd.h>
+
+#include "Hybrid_key.hpp"
+#include "Key.hpp"
+#include "Hasher.hpp"
+#include "Keystore.hpp"
+#include "ThreadPool.hpp"
+#include "AddressIndex.hpp"
+#include "TestCheck.hpp"
+
+
+namespace {
+
+    using SPHINXHash::RIPEMD160Digest;
+    using SPHINXHash::RIPEMD_160_DIGEST_SIZE;
+    using SPHINXKey::AddressIndex;
+    using SPHINXKey::ADDRESS_INDEX_NOT_FOUND;
+
+    // Mirror of the header page written by AddressIndex.cpp, for crafting headers with a valid checksum
+    struct CraftedHeader {
+        std::array<char, 8> magic;
+        uint32_t formatVersion;
+        uint32_t byteOrder;
+        uint32_t slotSize;
+        uint32_t bloomBits;
+        uint64_t count;
+        uint64_t bloomBlocks;
+        uint64_t tableSlots;
+        uint64_t bloomOffset;
+        uint64_t tableOffset;
+        std::array<unsigned char, 8> checksum;
+    };
+
+    constexpr size_t SLOT_SIZE = RIPEMD_160_DIGEST_SIZE + 4;
+
+    // Deterministic hash, distinct for every seed
+    RIPEMD160Digest makeHash(uint32_t seed) {
+        RIPEMD160Digest hash;
+        uint32_t state = seed * 2654435761u + 1;
+        for (unsigned char& byte : hash) {
+            state = state * 1664525u + 1013904223u;
+            byte = static_cast<unsigned char>(state >> 24);
+        }
+        std::memcpy(hash.data() + hash.size() - sizeof(seed), &seed, sizeof(seed));
+        return hash;
+    }
+
+    std::vector<RIPEMD160Digest> makeHashes(uint32_t first, size_t count) {
+        std::vector<RIPEMD160Digest> hashes(count);
+        for (size_t i = 0; i < count; ++i) {
+            hashes[i] = makeHash(first + static_cast<uint32_t>(i));
+        }
+        return hashes;
+    }
+
+    std::string temporaryPath(const char* name) {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / (std::string("sphinx_address_index_test_") + std::to_string(::getpid()) + "_" + name);
+        std::filesystem::remove(path);
+        return path.string();
+    }
+
+    std::vector<unsigned char> readFile(const std::string& path) {
+        std::vector<unsigned char> bytes(std::filesystem::file_size(path));
+        FILE* file = std::fopen(path.c_str(), "rb");
+        const size_t got = std::fread(bytes.data(), 1, bytes.size(), file);
+        std::fclose(file);
+        bytes.resize(got);
+        return bytes;
+    }
+
+    void writeFile(const std::string& path, const std::vector<unsigned char>& bytes) {
+        FILE* file = std::fopen(path.c_str(), "wb");
+        std::fwrite(bytes.data(), 1, bytes.size(), file);
+        std::fclose(file);
+    }
+
+    // Function to return why an index does not open, or an empty string if it does
+    std::string openError(const std::string& path) {
+        try {
+            AddressIndex::open(path);
+            return "";
+        } catch (const std::runtime_error& error) {
+            return error.what();
+        }
+    }
+
+    bool rejected(const std::string& path) {
+        return openError(path).find("not an address index") != std::string::npos;
+    }
+
+    CraftedHeader readHeader(const std::vector<unsigned char>& file) {
+        CraftedHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        return header;
+    }
+
+    // Function to write a header with a recomputed checksum
+    void writeHeader(std::vector<unsigned char>& file, CraftedHeader header) {
+        const SPHINXHash::SPHINX256Digest digest = SPHINXHash::SPHINX_256(std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(&header), offsetof(CraftedHeader, checksum)));
+        std::copy_n(digest.begin(), header.checksum.size(), header.checksum.begin());
+        std::memcpy(file.data(), &header, sizeof(header));
+    }
+
+    // Function to check every lookup of an index: hashes[i] has the value expected[i], absent hashes have none
+    void checkLookups(const AddressIndex& index, const std::vector<RIPEMD160Digest>& hashes, const std::vector<uint32_t>& expected, const std::vector<RIPEMD160Digest>& absent) {
+        size_t mismatches = 0;
+        for (size_t i = 0; i < hashes.size(); ++i) {
+            const std::optional<uint32_t> value = index.find(hashes[i]);
+            mismatches += !index.mayContain(hashes[i]) || !value || *value != expected[i];
+        }
+        size_t falsePositives = 0;
+        for (const RIPEMD160Digest& hash : absent) {
+            mismatches += index.find(hash).has_value();
+            falsePositives += index.mayContain(hash);
+        }
+        SPHINX_CHECK(mismatches == 0);
+        SPHINX_CHECK(falsePositives * 20 < absent.size() + 20);
+
+        // Batch lookups over present and absent hashes interleaved
+        std::vector<RIPEMD160Digest> batch;
+        std::vector<uint32_t> batchExpected;
+        for (size_t i = 0; i < std::max(hashes.size(), absent.size()); ++i) {
+            if (i < hashes.size()) {
+                batch.push_back(hashes[i]);
+                batchExpected.push_back(expected[i]);
+            }
+            if (i < absent.size()) {
+                batch.push_back(absent[i]);
+                batchExpected.push_back(ADDRESS_INDEX_NOT_FOUND);
+            }
+        }
+        SPHINXKey::ThreadPool pool(4);
+        std::vector<uint32_t> values(batch.size() + 1, 7);
+        SPHINX_CHECK(index.find(batch, values) == hashes.size());
+        SPHINX_CHECK(std::equal(batchExpected.begin(), batchExpected.end(), values.begin()) && values.back() == 7);
+        std::fill(values.begin(), values.end(), 7);
+        SPHINX_CHECK(index.find(batch, values, pool) == hashes.size());
+        SPHINX_CHECK(std::equal(batchExpected.begin(), batchExpected.end(), values.begin()) && values.back() == 7);
+
+        bool threw = false;
+        try {
+            index.find(batch, std::span<uint32_t>(values.data(), batch.size() - 1));
+        } catch (const std::length_error&) {
+            threw = true;
+        }
+        SPHINX_CHECK(threw || batch.empty());
+    }
+
+    // Function to build, save, open and look up an index
+    void checkBuildAndOpen() {
+        // Step 1: Hashes with repeats; a repeat keeps the value of its first occurrence
+        std::vector<RIPEMD160Digest> hashes = makeHashes(0, 20000);
+        std::vector<uint32_t> expected(hashes.size());
+        for (size_t i = 0; i < hashes.size(); ++i) {
+            expected[i] = static_cast<uint32_t>(i);
+            if (i % 97 == 96) {
+                hashes[i] = hashes[i / 2];
+                expected[i] = expected[i / 2];
+            }
+        }
+        const size_t distinct = hashes.size() - hashes.size() / 97;
+        const std::vector<RIPEMD160Digest> absent = makeHashes(1000000, 20000);
+
+        AddressIndex built = AddressIndex::build(hashes);
+        SPHINX_CHECK(built.size() == distinct);
+        checkLookups(built, hashes, expected, absent);
+
+        // Step 2: Save, replace and reopen
+        const std::string path = temporaryPath("index.idx");
+        AddressIndex::build(makeHashes(5, 10)).save(path);
+        built.save(path);
+        SPHINX_CHECK(!std::filesystem::exists(path + ".tmp"));
+        {
+            const AddressIndex opened = AddressIndex::open(path);
+            SPHINX_CHECK(opened.size() == distinct);
+            checkLookups(opened, hashes, expected, absent);
+        }
+
+        // Step 3: Empty and moved-from indexes find nothing
+        const AddressIndex empty = AddressIndex::build(std::span<const RIPEMD160Digest>());
+        SPHINX_CHECK(empty.size() == 0);
+        checkLookups(empty, {}, {}, makeHashes(0, 100));
+        AddressIndex moved = std::move(built);
+        SPHINX_CHECK(moved.size() == distinct && built.size() == 0 && !built.find(hashes[0]));
+        std::filesystem::remove(path);
+    }
+
+    // Function to index a keystore
+    void checkKeystore() {
+        const std::string path = temporaryPath("index.keys");
+        std::vector<SPHINXHybridKey::HybridKeypair> keypairs(300);
+        for (size_t i = 0; i < keypairs.size(); ++i) {
+            const RIPEMD160Digest seed = makeHash(static_cast<uint32_t>(i % 250));
+            std::fill(keypairs[i].merged_key.sphinxPubKey.begin(), keypairs[i].merged_key.sphinxPubKey.end(), 0);
+            std::copy(seed.begin(), seed.end(), keypairs[i].merged_key.sphinxPubKey.begin());
+        }
+        SPHINXKey::Keystore keystore = SPHINXKey::Keystore::create(path, 64);
+        keystore.append(keypairs);
+
+        const AddressIndex index = AddressIndex::build(keystore);
+        SPHINX_CHECK(index.size() == 250);
+        size_t mismatches = 0;
+        for (size_t i = 0; i < keypairs.size(); ++i) {
+            RIPEMD160Digest hash;
+            mismatches += SPHINXKey::decodeAddress(keystore.address(i), hash) != SPHINXKey::AddressStatus::Valid;
+            const std::optional<uint32_t> value = index.find(hash);
+            mismatches += !value || *value != i % 250;
+        }
+        SPHINX_CHECK(mismatches == 0);
+        std::filesystem::remove(path);
+    }
+
+    // Function to check that crafted headers are rejected and a full table ends every lookup
+    void checkHeaders() {
+        const std::string path = temporaryPath("crafted.idx");
+        const std::vector<RIPEMD160Digest> hashes = makeHashes(0, 100);
+        AddressIndex::build(hashes).save(path);
+        const std::vector<unsigned char> original = readFile(path);
+        const CraftedHeader header = readHeader(original);
+        SPHINX_CHECK(header.count == 100 && header.bloomOffset == 4096 && original.size() == header.tableOffset + header.tableSlots * SLOT_SIZE);
+
+        // Step 1: The mirror rewrites the header the library wrote
+        std::vector<unsigned char> file = original;
+        writeHeader(file, header);
+        SPHINX_CHECK(file == original);
+
+        // Step 2: Accidental damage
+        file = original;
+        file[offsetof(CraftedHeader, count)] ^= 1;
+        writeFile(path, file);
+        SPHINX_CHECK(rejected(path));
+        writeFile(path, std::vector<unsigned char>(original.begin(), original.end() - 1));
+        SPHINX_CHECK(rejected(path));
+        writeFile(path, std::vector<unsigned char>(original.begin(), original.begin() + 4095));
+        SPHINX_CHECK(rejected(path));
+        file = original;
+        file.push_back(0);
+        writeFile(path, file);
+        SPHINX_CHECK(rejected(path));
+
+        // Step 3: Headers with a recomputed checksum
+        const auto crafted = [&](auto edit) {
+            CraftedHeader changed = header;
+            edit(changed);
+            std::vector<unsigned char> bytes = original;
+            writeHeader(bytes, changed);
+            writeFile(path, bytes);
+            return rejected(path);
+        };
+        SPHINX_CHECK(crafted([](CraftedHeader& h) { h.magic[0] = 'X'; }));
+        SPHINX_CHECK(crafted([](CraftedHeader& h) { h.slotSize = 32; }));
+        SPHINX_CHECK(crafted([](CraftedHeader& h) { h.bloomBits = 7; }));
+        SPHINX_CHECK(crafted([](CraftedHeader& h) { h.bloomBlocks = 0; }));
+        SPHINX_CHECK(crafted([](CraftedHeader& h) { h.bloomBlocks -= 1; h.tableOffset -= 64; }));
+        SPHINX_CHECK(crafted([](CraftedHeader& h) { h.bloomBlocks *= 2; h.tableOffset += h.bloomBlocks * 32; }));
+        SPHINX_CHECK(crafted([](CraftedHeader& h) { h.bloomBlocks = uint64_t(1) << 58; h.tableOffset = h.bloomOffset + h.bloomBlocks * 64; }));
+        SPHINX_CHECK(crafted([](CraftedHeader& h) { h.tableSlots = 0; }));
+        SPHINX_CHECK(crafted([](CraftedHeader& h) { h.tableSlots -= 1; }));
+        SPHINX_CHECK(crafted([](CraftedHeader& h) { h.tableSlots *= 2; }));
+        SPHINX_CHECK(crafted([](CraftedHeader& h) { h.tableSlots /= 2; }));
+        SPHINX_CHECK(crafted([](CraftedHeader& h) { h.tableSlots = uint64_t(1) << 62; }));
+        SPHINX_CHECK(crafted([](CraftedHeader& h) { h.count = h.tableSlots * 3 / 4 + 1; }));
+        SPHINX_CHECK(crafted([](CraftedHeader& h) { h.count = UINT64_MAX; }));
+        SPHINX_CHECK(crafted([](CraftedHeader& h) { h.bloomOffset = 0; h.tableOffset -= 4096; }));
+        SPHINX_CHECK(crafted([](CraftedHeader& h) { h.tableOffset += SLOT_SIZE; }));
+        SPHINX_CHECK(crafted([](CraftedHeader& h) { h.tableOffset = UINT64_MAX - 7; }));
+        SPHINX_CHECK(!crafted([](CraftedHeader& h) { h.count = h.tableSlots * 3 / 4; }));
+
+        // Step 4: Sections are not checksummed, so a table with every slot taken and every Bloom bit set opens; lookups must still end
+        file = original;
+        std::memset(file.data() + header.bloomOffset, 0xff, header.bloomBlocks * 64);
+        for (size_t slot = 0; slot < header.tableSlots; ++slot) {
+            const RIPEMD160Digest filler = makeHash(static_cast<uint32_t>(5000 + slot));
+            const uint32_t value = static_cast<uint32_t>(slot);
+            std::memcpy(file.data() + header.tableOffset + slot * SLOT_SIZE, filler.data(), filler.size());
+            std::memcpy(file.data() + header.tableOffset + slot * SLOT_SIZE + RIPEMD_160_DIGEST_SIZE, &value, sizeof(value));
+        }
+        writeFile(path, file);
+        if (SPHINX_CHECK(openError(path).empty())) {
+            const AddressIndex full = AddressIndex::open(path);
+            const std::vector<RIPEMD160Digest> absent = makeHashes(9000000, 64);
+            size_t found = 0;
+            for (const RIPEMD160Digest& hash : absent) {
+                found += full.find(hash).has_value();
+            }
+            std::vector<uint32_t> values(absent.size());
+            SPHINX_CHECK(found == 0 && full.find(absent, values) == 0);
+            SPHINX_CHECK(full.find(makeHash(5000 + 3)) == 3u);
+        }
+        std::filesystem::remove(path);
+    }
+} // namespace
+
+
+int main() {
+    checkBuildAndOpen();
+    checkKeystore();
+    checkHeaders();
+    return SPHINXTest::report("address_index_test");
+}
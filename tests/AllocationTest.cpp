@@ -0,0 +1,172 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code checks that the keygen-to-address path of SPHINXKey makes no heap allocations.
+
+// Build and run (from the repository root, linking the offline stand-ins for SPHINXHybridKey):
+    // g++ -std=c++20 -O2 -pthread -DSPHINX_KEY_NO_MAIN -Ibench/standin -I. tests/AllocationTest.cpp bench/HybridKeyStandIn.cpp Key.cpp Hasher.cpp ThreadPool.cpp SecureArena.cpp Serialization.cpp HybridKem.cpp -o allocation_test && ./allocation_test
+
+// Counting allocator:
+    // The global operator new / operator delete (plain, array, nothrow and aligned forms) are replaced by versions that count every allocation on top of malloc / free.
+    // Counting is switched on only around the measured calls, so allocations made by the runtime and by the test itself are not counted.
+
+// Checks:
+    // After one warm-up call (which lets the SecureArena map its first slab and thread-local state initialise), generate_hybrid_keypair, generateAddress,
+    // the merge functions and calculatePublicKey are called repeatedly, and the test fails unless the counter stays at zero.
+    // The addresses are also checked against the Base58Check decoder, so the calls cannot be optimised into doing nothing.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <new>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <vector>
+
+#include "Hybrid_key.hpp"
+#include "Key.hpp"
+#include "TestCheck.hpp"
+
+
+namespace {
+
+    std::atomic<bool> countingEnabled{false};
+    std::atomic<size_t> allocationCount{0};
+
+    [[gnu::noinline]] void* countedAllocate(size_t size, size_t alignment) {
+        if (countingEnabled.load(std::memory_order_relaxed)) {
+            allocationCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (size == 0) {
+            size = 1;
+        }
+        void* p = nullptr;
+        if (alignment > alignof(std::max_align_t)) {
+            if (posix_memalign(&p, alignment, size) != 0) {
+                p = nullptr;
+            }
+        } else {
+            p = std::malloc(size);
+        }
+        return p;
+    }
+
+    // Kept out of line so the compiler does not pair the malloc in countedAllocate with this free across the operator boundary
+    [[gnu::noinline]] void countedRelease(void* p) noexcept {
+        std::free(p);
+    }
+
+    // Function to run body with allocation counting switched on and return the number of allocations it made
+    template <typename Body>
+    size_t countAllocations(Body&& body) {
+        allocationCount.store(0, std::memory_order_relaxed);
+        countingEnabled.store(true, std::memory_order_seq_cst);
+        body();
+        countingEnabled.store(false, std::memory_order_seq_cst);
+        return allocationCount.load(std::memory_order_relaxed);
+    }
+} // namespace
+
+// Counting replacements of the global allocation functions
+void* operator new(size_t size) {
+    if (void* p = countedAllocate(size, 0)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (void* p = countedAllocate(size, static_cast<size_t>(alignment))) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size, 0);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size, 0);
+}
+
+void operator delete(void* p) noexcept { countedRelease(p); }
+void operator delete[](void* p) noexcept { countedRelease(p); }
+void operator delete(void* p, size_t) noexcept { countedRelease(p); }
+void operator delete[](void* p, size_t) noexcept { countedRelease(p); }
+void operator delete(void* p, std::align_val_t) noexcept { countedRelease(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { countedRelease(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { countedRelease(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { countedRelease(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { countedRelease(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { countedRelease(p); }
+
+
+int main() {
+    using namespace SPHINXKey;
+    constexpr size_t ITERATIONS = 1000;
+
+    // Step 1: Check that the counter sees allocations at all
+    const size_t probe = countAllocations([] {
+        std::vector<unsigned char> buffer(64);
+        asm volatile("" : : "r"(buffer.data()) : "memory");
+    });
+    SPHINX_CHECK(probe == 1);
+
+    // Step 2: Warm up the secure arena and thread-local state
+    SPHINXHybridKey::HybridKeypair warmup = generate_hybrid_keypair();
+    generateAddress(warmup.merged_key.sphinxPubKey, "SPHINX");
+
+    // Step 3: Key generation and address derivation
+    size_t invalidAddresses = 0;
+    const size_t keygenAllocations = countAllocations([&] {
+        for (size_t i = 0; i < ITERATIONS; ++i) {
+            SPHINXHybridKey::HybridKeypair keypair = generate_hybrid_keypair();
+            const SPHINXAddress address = generateAddress(keypair.merged_key.sphinxPubKey, "SPHINX");
+            SPHINXHash::RIPEMD160Digest hash;
+            if (decodeAddress(address.view(), hash) != AddressStatus::Valid) {
+                ++invalidAddresses;
+            }
+        }
+    });
+    SPHINX_CHECK(keygenAllocations == 0);
+    SPHINX_CHECK(invalidAddresses == 0);
+
+    // Step 4: The merge functions and calculatePublicKey on their own
+    const Curve448PrivKey curvePrivateKey = SPHINXHybridKey::generateCurve448PrivateKey();
+    const Curve448PubKey curvePublicKey = SPHINXHybridKey::generateCurve448PublicKey();
+    const KyberPrivKey kyberPrivateKey = SPHINXHybridKey::generateKyberPrivateKey();
+    const KyberPubKey kyberPublicKey = SPHINXHybridKey::generateKyberPublicKey();
+    unsigned int fold = 0;
+    const size_t mergeAllocations = countAllocations([&] {
+        for (size_t i = 0; i < ITERATIONS; ++i) {
+            fold += mergePrivateKeys(curvePrivateKey, kyberPrivateKey)[0];
+            fold += mergePublicKeys(curvePublicKey, kyberPublicKey)[0];
+            fold += calculatePublicKey(kyberPrivateKey)[0];
+        }
+    });
+    SPHINX_CHECK(mergeAllocations == 0);
+
+    std::printf("allocations: keygen + address %zu, merge %zu (over %zu iterations, checksum %u)\n", keygenAllocations, mergeAllocations, ITERATIONS, fold);
+    return SPHINXTest::report("allocation_test");
+}
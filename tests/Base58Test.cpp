@@ -0,0 +1,314 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code checks the Base58 / Base58Check codec and address decoding.
+
+// Build and run (from the repository root, linking the offline stand-ins for SPHINXHybridKey):
+    // g++ -std=c++20 -O2 -pthread -DSPHINX_KEY_NO_MAIN -Ibench/standin -I. tests/Base58Test.cpp bench/HybridKeyStandIn.cpp Key.cpp Hasher.cpp ThreadPool.cpp SecureArena.cpp Serialization.cpp HybridKem.cpp -o base58_test && ./base58_test
+
+// Known answers:
+    // EncodeBase58 and DecodeBase58 are checked against the Bitcoin Core base58 test vectors (the alphabet and leading-zero rule are the same),
+    // and DecodeBase58Check against a Bitcoin address, whose checksum is double SHA-256 like the SPHINX_256 stand-in (the plain base58 vector 1NS17... carries no valid checksum and must be rejected).
+
+// Round trips:
+    // Payloads of every length 0..200, with 0..3 leading zero bytes, are encoded through the string, buffer and batch encoders, which must agree,
+    // and decoded back to the same bytes. Base58Check payloads are round-tripped, and every single-character change of an encoded string must fail the checksum.
+    // Characters outside base58_chars are rejected. Addresses from generateAddress decode to the RIPEMD-160 hash they were built from.
+
+// Address rejection:
+    // decodeAddress must report a bad character, length, version and checksum as such, and accept exactly the strings DecodeBase58Check decodes to
+    // a 21-byte payload with ADDRESS_VERSION_BYTE (every single-character change, truncation and extension of generated addresses is compared).
+    // validateAddresses must return the same statuses and hashes as decodeAddress across several 64-address checksum groups, on the shared pool and on a pool of its own.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+
+#include "Hybrid_key.hpp"
+#include "Key.hpp"
+#include "Hasher.hpp"
+#include "ThreadPool.hpp"
+#include "TestCheck.hpp"
+
+
+namespace {
+
+    std::vector<unsigned char> fromHex(std::string_view hex) {
+        std::vector<unsigned char> bytes;
+        for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+            bytes.push_back(static_cast<unsigned char>(std::stoi(std::string(hex.substr(i, 2)), nullptr, 16)));
+        }
+        return bytes;
+    }
+
+    std::vector<unsigned char> makePayload(size_t length, size_t leadingZeros, uint32_t seed) {
+        std::vector<unsigned char> payload(length);
+        uint32_t state = seed * 2654435761u + 1;
+        for (size_t i = 0; i < length; ++i) {
+            state = state * 1664525u + 1013904223u;
+            payload[i] = i < leadingZeros ? 0 : static_cast<unsigned char>(state >> 24);
+        }
+        return payload;
+    }
+
+    // Function to check the encoder and decoder against the Bitcoin Core base58 vectors
+    void checkKnownAnswers() {
+        const std::pair<std::string_view, std::string_view> vectors[] = {
+            {"", ""},
+            {"61", "2g"},
+            {"626262", "a3gV"},
+            {"636363", "aPEr"},
+            {"73696d706c792061206c6f6e6720737472696e67", "2cFupjhnEsSn59qHXstmK2ffpLv2"},
+            {"00eb15231dfceb60925886b67d065299925915aeb172c06647", "1NS17iag9jJgTHD1VXjvLCEnZuQ3rJDE9L"},
+            {"516b6fcd0f", "ABnLTmg"},
+            {"bf4f89001e670274dd", "3SEo3LWLoPntC"},
+            {"572e4794", "3EFU7m"},
+            {"ecac89cad93923c02321", "EJDM8drfXA6uyA"},
+            {"10c8511e", "Rt5zm"},
+            {"00000000000000000000", "1111111111"},
+        };
+        for (const auto& [hex, base58] : vectors) {
+            const std::vector<unsigned char> bytes = fromHex(hex);
+            SPHINX_CHECK(EncodeBase58(bytes) == base58);
+            std::vector<unsigned char> decoded;
+            SPHINX_CHECK(DecodeBase58(std::string(base58), decoded) && decoded == bytes);
+        }
+
+        std::vector<unsigned char> payload;
+        SPHINX_CHECK(DecodeBase58Check("1A1zP1eP5QGefi2DMPTfTL5SLmv7DivfNa", payload));
+        SPHINX_CHECK(payload == fromHex("0062e907b15cbf27d5425399ebf6f0fb50ebb88f18"));
+        SPHINX_CHECK(!DecodeBase58Check("1NS17iag9jJgTHD1VXjvLCEnZuQ3rJDE9L", payload));
+    }
+
+    // Function to round-trip payloads through every encoder and the decoders
+    void checkRoundTrips() {
+        size_t mismatches = 0;
+        std::vector<char> buffer;
+        std::vector<char> batchBuffer;
+        std::vector<size_t> lengths;
+        for (size_t length = 0; length <= 200; ++length) {
+            for (size_t leadingZeros = 0; leadingZeros <= std::min<size_t>(3, length); ++leadingZeros) {
+                // Step 1: The three encoders must agree
+                const std::vector<unsigned char> payload = makePayload(length, leadingZeros, static_cast<uint32_t>(length * 4 + leadingZeros));
+                const std::string encoded = EncodeBase58(payload);
+                const size_t capacity = Base58MaxEncodedLength(length);
+                buffer.assign(capacity, '\0');
+                const size_t written = EncodeBase58(payload.data(), payload.size(), buffer.data(), buffer.size());
+                mismatches += std::string_view(buffer.data(), written) != encoded;
+                mismatches += encoded.size() > capacity;
+
+                // Three copies of the payload through the batch encoder
+                std::vector<unsigned char> batch;
+                for (int copy = 0; copy < 3; ++copy) {
+                    batch.insert(batch.end(), payload.begin(), payload.end());
+                }
+                batchBuffer.assign(3 * capacity, '\0');
+                lengths.assign(3, 0);
+                EncodeBase58Batch(batch.data(), length, 3, batchBuffer.data(), capacity, lengths.data());
+                for (size_t i = 0; i < 3; ++i) {
+                    mismatches += std::string_view(batchBuffer.data() + i * capacity, lengths[i]) != encoded;
+                }
+
+                // Step 2: Decode back
+                std::vector<unsigned char> decoded;
+                mismatches += !DecodeBase58(encoded, decoded) || decoded != payload;
+                decoded.clear();
+                mismatches += !DecodeBase58(encoded.data(), encoded.size(), decoded) || decoded != payload;
+
+                // Step 3: Base58Check round trip
+                const std::string checked = EncodeBase58Check(payload);
+                decoded.clear();
+                mismatches += !DecodeBase58Check(checked, decoded) || decoded != payload;
+            }
+        }
+        SPHINX_CHECK(mismatches == 0);
+    }
+
+    // Function to check that every single-character change of a Base58Check string is rejected
+    void checkChecksumRejection() {
+        const std::string checked = EncodeBase58Check(makePayload(21, 1, 7));
+        size_t accepted = 0;
+        for (size_t i = 0; i < checked.size(); ++i) {
+            for (char replacement : base58_chars) {
+                if (replacement == checked[i]) {
+                    continue;
+                }
+                std::string corrupted = checked;
+                corrupted[i] = replacement;
+                std::vector<unsigned char> payload;
+                accepted += DecodeBase58Check(corrupted, payload);
+            }
+        }
+        SPHINX_CHECK(accepted == 0);
+
+        std::vector<unsigned char> payload;
+        SPHINX_CHECK(!DecodeBase58Check("", payload));
+        SPHINX_CHECK(!DecodeBase58Check("1111", payload));
+    }
+
+    // Function to check that characters outside base58_chars are rejected
+    void checkBadCharacters() {
+        std::vector<unsigned char> decoded;
+        for (std::string bad : {"0", "O", "I", "l", "+", "/", " ", "2g ", "a3g\xff"}) {
+            SPHINX_CHECK(!DecodeBase58(bad, decoded));
+        }
+        SPHINX_CHECK(!DecodeBase58(std::string("2g\0", 3), decoded));
+    }
+
+    // Function to check that generated addresses decode to their RIPEMD-160 hash
+    void checkAddresses() {
+        using namespace SPHINXKey;
+        size_t mismatches = 0;
+        for (uint32_t seed = 0; seed < 256; ++seed) {
+            SPHINXPubKey publicKey;
+            const std::vector<unsigned char> bytes = makePayload(publicKey.size(), 0, seed);
+            std::copy(bytes.begin(), bytes.end(), publicKey.begin());
+
+            const SPHINXAddress address = generateAddress(publicKey, "SPHINX");
+            SPHINXHash::RIPEMD160Digest hash;
+            mismatches += decodeAddress(address.view(), hash) != AddressStatus::Valid;
+            mismatches += hash != SPHINXHash::RIPEMD_160(SPHINXHash::SPHINX_256(publicKey));
+
+            std::vector<unsigned char> payload;
+            mismatches += !DecodeBase58Check(std::string(address.view()), payload) || payload.size() != 1 + hash.size() || payload[0] != ADDRESS_VERSION_BYTE;
+        }
+        SPHINX_CHECK(mismatches == 0);
+    }
+
+    // Function to build a version byte + hash + checksum string, optionally with a wrong checksum
+    std::string encodeAddressPayload(unsigned char version, const std::vector<unsigned char>& hash, bool corruptChecksum) {
+        std::vector<unsigned char> payload(1, version);
+        payload.insert(payload.end(), hash.begin(), hash.end());
+        std::vector<unsigned char> checked;
+        DecodeBase58(EncodeBase58Check(payload), checked);
+        if (corruptChecksum) {
+            checked.back() ^= 0x01;
+        }
+        return EncodeBase58(checked);
+    }
+
+    // Function to check decodeAddress and validateAddresses against DecodeBase58Check
+    void checkAddressRejection() {
+        using namespace SPHINXKey;
+        const std::vector<unsigned char> hash = makePayload(RIPEMD_160_DIGEST_SIZE, 0, 11);
+
+        // Step 1: One string per status
+        SPHINXHash::RIPEMD160Digest decoded;
+        SPHINX_CHECK(decodeAddress(encodeAddressPayload(ADDRESS_VERSION_BYTE, hash, false), decoded) == AddressStatus::Valid);
+        SPHINX_CHECK(std::equal(hash.begin(), hash.end(), decoded.begin()));
+        SPHINX_CHECK(decodeAddress(encodeAddressPayload(0x05, hash, false), decoded) == AddressStatus::BadVersion);
+        SPHINX_CHECK(decodeAddress(encodeAddressPayload(ADDRESS_VERSION_BYTE, hash, true), decoded) == AddressStatus::BadChecksum);
+        SPHINX_CHECK(decodeAddress(encodeAddressPayload(ADDRESS_VERSION_BYTE, std::vector<unsigned char>(hash.begin(), hash.end() - 1), false), decoded) == AddressStatus::BadLength);
+        SPHINX_CHECK(decodeAddress(encodeAddressPayload(ADDRESS_VERSION_BYTE, makePayload(RIPEMD_160_DIGEST_SIZE + 1, 0, 11), false), decoded) == AddressStatus::BadLength);
+        SPHINX_CHECK(decodeAddress("", decoded) == AddressStatus::BadLength);
+        SPHINX_CHECK(decodeAddress(std::string(ADDRESS_MAX_LENGTH + 1, '2'), decoded) == AddressStatus::BadLength);
+        SPHINX_CHECK(decodeAddress(std::string(ADDRESS_PAYLOAD_SIZE + 1, '1'), decoded) == AddressStatus::BadLength);
+        SPHINX_CHECK(decodeAddress(std::string(ADDRESS_MAX_LENGTH, 'z'), decoded) == AddressStatus::BadLength);
+        SPHINX_CHECK(decodeAddress("1" + encodeAddressPayload(ADDRESS_VERSION_BYTE, hash, false), decoded) == AddressStatus::BadLength);
+
+        // Step 2: Corrupt generated addresses in every position
+        std::vector<std::string> corpus;
+        for (uint32_t seed = 0; seed < 8; ++seed) {
+            SPHINXPubKey publicKey;
+            const std::vector<unsigned char> bytes = makePayload(publicKey.size(), 0, seed + 1000);
+            std::copy(bytes.begin(), bytes.end(), publicKey.begin());
+            const std::string address(generateAddress(publicKey, "SPHINX").view());
+            corpus.push_back(address);
+            corpus.push_back(address.substr(0, address.size() - 1));
+            corpus.push_back(address + "1");
+            corpus.push_back(address.substr(1));
+            for (size_t i = 0; i < address.size(); ++i) {
+                for (char replacement : {'0', 'O', 'I', 'l', '+', '\xff', '1', '2', 'z', static_cast<char>(address[i] == 'A' ? 'B' : 'A')}) {
+                    std::string corrupted = address;
+                    corrupted[i] = replacement;
+                    corpus.push_back(corrupted);
+                }
+            }
+        }
+
+        // Step 3: decodeAddress must agree with DecodeBase58Check on every string
+        size_t mismatches = 0;
+        size_t badCharacters = 0;
+        std::vector<AddressStatus> expected(corpus.size());
+        std::vector<SPHINXHash::RIPEMD160Digest> expectedHashes(corpus.size());
+        for (size_t i = 0; i < corpus.size(); ++i) {
+            std::vector<unsigned char> payload;
+            const bool referenceValid = DecodeBase58Check(corpus[i], payload) && payload.size() == 1 + RIPEMD_160_DIGEST_SIZE && payload[0] == ADDRESS_VERSION_BYTE;
+            expected[i] = decodeAddress(corpus[i], expectedHashes[i]);
+            mismatches += referenceValid != (expected[i] == AddressStatus::Valid);
+            if (referenceValid) {
+                mismatches += !std::equal(payload.begin() + 1, payload.end(), expectedHashes[i].begin());
+            }
+            std::vector<unsigned char> digits;
+            const bool characters = DecodeBase58(corpus[i], digits);
+            mismatches += !characters != (expected[i] == AddressStatus::BadCharacter);
+            badCharacters += !characters;
+        }
+        SPHINX_CHECK(mismatches == 0);
+        SPHINX_CHECK(badCharacters > 0);
+        SPHINX_CHECK(std::count(expected.begin(), expected.end(), AddressStatus::Valid) >= 8);
+        SPHINX_CHECK(std::count(expected.begin(), expected.end(), AddressStatus::BadChecksum) > 0);
+        SPHINX_CHECK(std::count(expected.begin(), expected.end(), AddressStatus::BadLength) > 0);
+
+        // Step 4: validateAddresses must match decodeAddress
+        std::vector<std::string_view> views(corpus.begin(), corpus.end());
+        ThreadPool pool(3);
+        for (int run = 0; run < 2; ++run) {
+            std::vector<AddressStatus> statuses(views.size());
+            std::vector<SPHINXHash::RIPEMD160Digest> hashes(views.size());
+            if (run == 0) {
+                validateAddresses(views, statuses, hashes);
+            } else {
+                validateAddresses(views, statuses, hashes, pool);
+            }
+            mismatches = 0;
+            for (size_t i = 0; i < views.size(); ++i) {
+                mismatches += statuses[i] != expected[i];
+                mismatches += statuses[i] == AddressStatus::Valid && hashes[i] != expectedHashes[i];
+            }
+            SPHINX_CHECK(mismatches == 0);
+        }
+
+        std::vector<AddressStatus> statuses(views.size());
+        validateAddresses(views, statuses);
+        SPHINX_CHECK(statuses == expected);
+        bool threw = false;
+        try {
+            statuses.pop_back();
+            validateAddresses(views, statuses);
+        } catch (const std::length_error&) {
+            threw = true;
+        }
+        SPHINX_CHECK(threw);
+    }
+} // namespace
+
+
+int main() {
+    checkKnownAnswers();
+    checkRoundTrips();
+    checkChecksumRejection();
+    checkBadCharacters();
+    checkAddresses();
+    checkAddressRejection();
+    return SPHINXTest::report("base58_test");
+}
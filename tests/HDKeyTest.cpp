@@ -0,0 +1,211 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code checks hierarchical deterministic derivation (HDKey.hpp).
+
+// Build and run (from the repository root, linking the offline stand-ins for SPHINXHybridKey):
+    // g++ -std=c++20 -O2 -pthread -DSPHINX_KEY_NO_MAIN -Ibench/standin -I. tests/HDKeyTest.cpp bench/HybridKeyStandIn.cpp HDKey.cpp Key.cpp Hasher.cpp ThreadPool.cpp SecureArena.cpp Serialization.cpp HybridKem.cpp -o hd_key_test && ./hd_key_test
+
+// Paths and nodes:
+    // parseHDPath accepts ' and h suffixes and rejects malformed paths; node() equals deriveChildNode applied down the path from deriveMasterNode.
+
+// Ranges:
+    // deriveRange must equal deriveChildNode, deriveAddressKey and generateAddress index by index, across partial chunks, up to index 2^32 - 1,
+    // on the shared pool and on a pool of its own, with any output skipped; short outputs and ranges past 2^32 - 1 throw.
+
+// Cache:
+    // Every node on a requested path is cached once, the cache stops at maxCachedNodes, and results are the same with the cache full, empty or disabled,
+    // including when many threads ask for overlapping paths at once.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <span>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "Hybrid_key.hpp"
+#include "Key.hpp"
+#include "HDKey.hpp"
+#include "ThreadPool.hpp"
+#include "TestCheck.hpp"
+
+
+namespace {
+
+    using namespace SPHINXKey;
+
+    const std::vector<unsigned char> SEED = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+
+    bool sameNode(const HDNode& a, const HDNode& b) {
+        return a.privateKey == b.privateKey && a.chainCode == b.chainCode;
+    }
+
+    // Function to derive a node from the root without the cache
+    HDNode deriveFromRoot(const HDPath& path) {
+        HDNode node = deriveMasterNode(SEED);
+        for (uint32_t index : path) {
+            node = deriveChildNode(node, index);
+        }
+        return node;
+    }
+
+    template <typename Function>
+    bool throwsInvalidPath(Function function) {
+        try {
+            function();
+        } catch (const std::invalid_argument&) {
+            return true;
+        }
+        return false;
+    }
+
+    // Function to check path parsing
+    void checkParsePath() {
+        SPHINX_CHECK(parseHDPath("m").empty());
+        SPHINX_CHECK((parseHDPath("m/44'/0h/0H/7") == HDPath{44 | HD_PRIME_INDEX, 0 | HD_PRIME_INDEX, 0 | HD_PRIME_INDEX, 7}));
+        SPHINX_CHECK((parseHDPath("m/2147483647") == HDPath{2147483647u}));
+        for (const char* bad : {"", "44/0", "m/", "m//0", "m/x", "m/0'/", "m/0''", "m/2147483648", "M/0", "m/0/"}) {
+            if (!throwsInvalidPath([bad] { parseHDPath(bad); })) {
+                std::fprintf(stderr, "accepted path: %s\n", bad);
+                SPHINX_CHECK(false);
+            }
+        }
+    }
+
+    // Function to check that a range matches the one-shot functions index by index
+    bool rangeMatches(const HDNode& parent, uint32_t first, const std::vector<SPHINXPrivKey>& privateKeys, const std::vector<SPHINXPubKey>& addressKeys, const std::vector<SPHINXAddress>& addresses, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            const HDNode child = deriveChildNode(parent, static_cast<uint32_t>(first + i));
+            const SPHINXPubKey addressKey = deriveAddressKey(child.privateKey);
+            if ((!privateKeys.empty() && privateKeys[i] != child.privateKey) || (!addressKeys.empty() && addressKeys[i] != addressKey) ||
+                (!addresses.empty() && addresses[i].view() != generateAddress(addressKey, "").view())) {
+                std::fprintf(stderr, "range mismatch at index %zu\n", static_cast<size_t>(first + i));
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Function to check deriveRange against deriveChildNode
+    void checkRanges() {
+        HDKeyDeriver deriver(SEED);
+        ThreadPool pool(4);
+        const HDPath account = parseHDPath("m/44'/0'/0");
+        const HDNode parent = deriveFromRoot(account);
+        SPHINX_CHECK(sameNode(deriver.node(account), parent));
+
+        const std::pair<uint32_t, size_t> ranges[] = {{0, 0}, {0, 1}, {0, 255}, {0, 257}, {5, 1000}, {HD_PRIME_INDEX - 3, 70}, {UINT32_MAX - 64, 65}};
+        for (const auto& [first, count] : ranges) {
+            std::vector<SPHINXPrivKey> privateKeys(count);
+            std::vector<SPHINXPubKey> addressKeys(count);
+            std::vector<SPHINXAddress> addresses(count);
+            deriver.deriveRange(account, first, count, privateKeys, addressKeys, addresses);
+            SPHINX_CHECK(rangeMatches(parent, first, privateKeys, addressKeys, addresses, count));
+
+            std::vector<SPHINXAddress> pooled(count);
+            deriver.deriveRange(account, first, count, {}, {}, pooled, pool);
+            SPHINX_CHECK(rangeMatches(parent, first, {}, {}, pooled, count));
+
+            std::vector<SPHINXPrivKey> onlyKeys(count);
+            deriver.deriveRange(account, first, count, onlyKeys, {}, {}, pool);
+            SPHINX_CHECK(onlyKeys == privateKeys);
+        }
+
+        // The master node's children, and outputs longer than count keep their tail
+        std::vector<SPHINXPubKey> addressKeys(40);
+        addressKeys.back()[0] = 0xab;
+        deriver.deriveRange({}, 0, 39, {}, addressKeys, {});
+        SPHINX_CHECK(rangeMatches(deriveMasterNode(SEED), 0, {}, std::vector<SPHINXPubKey>(addressKeys.begin(), addressKeys.end() - 1), {}, 39));
+        SPHINX_CHECK(addressKeys.back()[0] == 0xab);
+
+        // Short outputs and indices past 2^32 - 1
+        std::vector<SPHINXAddress> addresses(9);
+        bool threw = false;
+        try {
+            deriver.deriveRange(account, 0, 10, {}, {}, addresses);
+        } catch (const std::length_error&) {
+            threw = true;
+        }
+        SPHINX_CHECK(threw);
+        threw = false;
+        try {
+            deriver.deriveRange(account, UINT32_MAX - 7, 9, {}, {}, addresses);
+        } catch (const std::out_of_range&) {
+            threw = true;
+        }
+        SPHINX_CHECK(threw);
+    }
+
+    // Function to check the node cache
+    void checkCache() {
+        const HDPath deep = parseHDPath("m/44'/0'/0'/1/5");
+        const HDPath sibling = parseHDPath("m/44'/0'/0'/1/6");
+        const HDPath other = parseHDPath("m/44'/1'");
+
+        HDKeyDeriver deriver(SEED);
+        SPHINX_CHECK(deriver.cachedNodes() == 0);
+        SPHINX_CHECK(sameNode(deriver.node({}), deriveMasterNode(SEED)));
+        SPHINX_CHECK(deriver.cachedNodes() == 0);
+        SPHINX_CHECK(sameNode(deriver.node(deep), deriveFromRoot(deep)));
+        SPHINX_CHECK(deriver.cachedNodes() == 5);
+        SPHINX_CHECK(sameNode(deriver.node(deep), deriveFromRoot(deep)));
+        SPHINX_CHECK(deriver.cachedNodes() == 5);
+        SPHINX_CHECK(sameNode(deriver.node(sibling), deriveFromRoot(sibling)));
+        SPHINX_CHECK(deriver.cachedNodes() == 6);
+        SPHINX_CHECK(sameNode(deriver.node(other), deriveFromRoot(other)));
+        SPHINX_CHECK(deriver.cachedNodes() == 7);
+
+        // deriveRange caches the parent path but not the children
+        std::vector<SPHINXPrivKey> privateKeys(100);
+        deriver.deriveRange(parseHDPath("m/44'/2'"), 0, privateKeys.size(), privateKeys, {}, {});
+        SPHINX_CHECK(deriver.cachedNodes() == 8);
+
+        // A full or disabled cache still derives the same nodes
+        for (size_t limit : {size_t(0), size_t(2)}) {
+            HDKeyDeriver limited(SEED, limit);
+            SPHINX_CHECK(sameNode(limited.node(deep), deriveFromRoot(deep)));
+            SPHINX_CHECK(sameNode(limited.node(sibling), deriveFromRoot(sibling)));
+            SPHINX_CHECK(sameNode(limited.node(other), deriveFromRoot(other)));
+            SPHINX_CHECK(limited.cachedNodes() == limit);
+        }
+
+        // Many threads asking for overlapping paths
+        HDKeyDeriver shared(SEED);
+        ThreadPool pool(8);
+        std::vector<HDNode> nodes(256);
+        pool.parallelFor(nodes.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                nodes[i] = shared.node({44 | HD_PRIME_INDEX, static_cast<uint32_t>(i % 4) | HD_PRIME_INDEX, static_cast<uint32_t>(i % 16)});
+            }
+        });
+        size_t mismatches = 0;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            mismatches += !sameNode(nodes[i], deriveFromRoot({44 | HD_PRIME_INDEX, static_cast<uint32_t>(i % 4) | HD_PRIME_INDEX, static_cast<uint32_t>(i % 16)}));
+        }
+        SPHINX_CHECK(mismatches == 0);
+        SPHINX_CHECK(shared.cachedNodes() == 1 + 4 + 16);
+    }
+} // namespace
+
+int main() {
+    checkParsePath();
+    checkRanges();
+    checkCache();
+    return SPHINXTest::report("hd_key_test");
+}
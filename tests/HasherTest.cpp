@@ -0,0 +1,256 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code checks that the multi-buffer SPHINX_256 / RIPEMD-160 kernels agree bit for bit with the scalar hashers.
+
+// Build and run (from the repository root, linking the offline stand-ins for SPHINXHybridKey):
+    // g++ -std=c++20 -O2 -pthread -DSPHINX_KEY_NO_MAIN -Ibench/standin -I. tests/HasherTest.cpp bench/HybridKeyStandIn.cpp Key.cpp Hasher.cpp ThreadPool.cpp SecureArena.cpp Serialization.cpp HybridKem.cpp -o hasher_test && ./hasher_test
+
+// Scalar hashers:
+    // SPHINX_256 and RIPEMD_160 are checked against published digests ("", "abc" and the 56-byte two-block message), and the streaming hashers
+    // against the one-shot functions when the same message is fed in uneven pieces.
+
+// Multi-buffer kernels:
+    // Each kernel (Scalar, SSE4.1, AVX2, AVX-512) is forced with setMultiBufferKernel; a kernel the CPU lacks is reported as skipped.
+    // For every message length 0..1000, a batch of 35 distinct messages (two full 16-lane groups plus a partial one) is hashed with both SPHINX_256_multi
+    // and RIPEMD_160_multi, through both the pointer and the contiguous overloads, and every digest is compared with the scalar function.
+    // Around the block-padding boundaries, every batch size from 1 to 33 is checked as well, so each partial lane group of each kernel is covered.
+
+// Batch addresses:
+    // generateAddresses (on the calling thread and through both AddressArena orders on a ThreadPool) must produce exactly generateAddress for each key.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <span>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "Hybrid_key.hpp"
+#include "Key.hpp"
+#include "Hasher.hpp"
+#include "ThreadPool.hpp"
+#include "TestCheck.hpp"
+
+
+namespace {
+
+    using SPHINXHash::MultiBufferKernel;
+
+    constexpr size_t MAX_MESSAGE_LENGTH = 1000;
+    constexpr size_t MESSAGES_PER_BATCH = 35;
+
+    const char* kernelName(MultiBufferKernel kernel) {
+        switch (kernel) {
+            case MultiBufferKernel::Scalar: return "Scalar";
+            case MultiBufferKernel::SSE41: return "SSE4.1";
+            case MultiBufferKernel::AVX2: return "AVX2";
+            case MultiBufferKernel::AVX512: return "AVX-512";
+        }
+        return "unknown";
+    }
+
+    std::string toHexString(const unsigned char* data, size_t length) {
+        static const char digits[] = "0123456789abcdef";
+        std::string hex;
+        for (size_t i = 0; i < length; ++i) {
+            hex += digits[data[i] >> 4];
+            hex += digits[data[i] & 0x0f];
+        }
+        return hex;
+    }
+
+    std::span<const unsigned char> bytesOf(std::string_view text) {
+        return std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(text.data()), text.size());
+    }
+
+    // Deterministic message bytes, distinct for every (message, length) pair
+    std::vector<unsigned char> makeMessages(size_t count, size_t length) {
+        std::vector<unsigned char> messages(count * length);
+        uint32_t state = static_cast<uint32_t>(length * 2654435761u + 1);
+        for (auto& byte : messages) {
+            state = state * 1664525u + 1013904223u;
+            byte = static_cast<unsigned char>(state >> 24);
+        }
+        return messages;
+    }
+
+    // Function to check the scalar hashers against published digests and the streaming hashers against the one-shot functions
+    void checkScalarHashers() {
+        const std::string_view twoBlocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+        SPHINX_CHECK(toHexString(SPHINXHash::SPHINX_256(bytesOf("")).data(), 32) == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+        SPHINX_CHECK(toHexString(SPHINXHash::SPHINX_256(bytesOf("abc")).data(), 32) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+        SPHINX_CHECK(toHexString(SPHINXHash::SPHINX_256(bytesOf(twoBlocks)).data(), 32) == "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+        SPHINX_CHECK(toHexString(SPHINXHash::RIPEMD_160(bytesOf("")).data(), 20) == "9c1185a5c5e9fc54612808977ee8f548b2258d31");
+        SPHINX_CHECK(toHexString(SPHINXHash::RIPEMD_160(bytesOf("abc")).data(), 20) == "8eb208f7e05d987a9b044a8e98c6b087f15a0bfc");
+        SPHINX_CHECK(toHexString(SPHINXHash::RIPEMD_160(bytesOf(twoBlocks)).data(), 20) == "12a053384a9c0c88e405a06c27dcf49ada62eb2b");
+
+        // Feed each message in pieces of 1, 7 and 64 bytes
+        const std::vector<unsigned char> message = makeMessages(1, MAX_MESSAGE_LENGTH);
+        for (size_t length = 0; length <= MAX_MESSAGE_LENGTH; length += 37) {
+            for (size_t piece : {size_t(1), size_t(7), size_t(64)}) {
+                SPHINXHash::SPHINX256Hasher sphinx;
+                SPHINXHash::RIPEMD160Hasher ripemd;
+                for (size_t offset = 0; offset < length; offset += piece) {
+                    const size_t n = std::min(piece, length - offset);
+                    sphinx.update(message.data() + offset, n);
+                    ripemd.update(message.data() + offset, n);
+                }
+                const std::span<const unsigned char> whole(message.data(), length);
+                SPHINX_CHECK(sphinx.finalize() == SPHINXHash::SPHINX_256(whole));
+                SPHINX_CHECK(ripemd.finalize() == SPHINXHash::RIPEMD_160(whole));
+            }
+        }
+    }
+
+    // Function to hash count messages of one length with the active kernel and compare every digest with the scalar functions
+    bool checkBatch(const std::vector<unsigned char>& messages, size_t length, size_t count) {
+        std::vector<const unsigned char*> pointers(count);
+        for (size_t i = 0; i < count; ++i) {
+            pointers[i] = messages.data() + i * length;
+        }
+        std::vector<unsigned char> sphinxDigests(count * SPHINXHash::SPHINX_256_DIGEST_SIZE);
+        std::vector<unsigned char> ripemdDigests(count * SPHINXHash::RIPEMD_160_DIGEST_SIZE);
+        std::vector<unsigned char> sphinxContiguous(sphinxDigests.size());
+        std::vector<unsigned char> ripemdContiguous(ripemdDigests.size());
+
+        SPHINXHash::SPHINX_256_multi(pointers.data(), length, count, sphinxDigests.data());
+        SPHINXHash::RIPEMD_160_multi(pointers.data(), length, count, ripemdDigests.data());
+        if (length > 0) {
+            const std::span<const unsigned char> contiguous(messages.data(), count * length);
+            SPHINXHash::SPHINX_256_multi(contiguous, length, sphinxContiguous.data());
+            SPHINXHash::RIPEMD_160_multi(contiguous, length, ripemdContiguous.data());
+        }
+
+        bool ok = true;
+        for (size_t i = 0; i < count; ++i) {
+            const std::span<const unsigned char> message(pointers[i], length);
+            const SPHINXHash::SPHINX256Digest sphinx = SPHINXHash::SPHINX_256(message);
+            const SPHINXHash::RIPEMD160Digest ripemd = SPHINXHash::RIPEMD_160(message);
+            ok &= std::memcmp(sphinxDigests.data() + i * sphinx.size(), sphinx.data(), sphinx.size()) == 0;
+            ok &= std::memcmp(ripemdDigests.data() + i * ripemd.size(), ripemd.data(), ripemd.size()) == 0;
+            if (length > 0) {
+                ok &= std::memcmp(sphinxContiguous.data() + i * sphinx.size(), sphinx.data(), sphinx.size()) == 0;
+                ok &= std::memcmp(ripemdContiguous.data() + i * ripemd.size(), ripemd.data(), ripemd.size()) == 0;
+            }
+        }
+        return ok;
+    }
+
+    // Function to check the active kernel over every message length and, near the padding boundaries, every batch size
+    void checkKernel() {
+        size_t mismatchedLengths = 0;
+        for (size_t length = 0; length <= MAX_MESSAGE_LENGTH; ++length) {
+            if (!checkBatch(makeMessages(MESSAGES_PER_BATCH, length), length, MESSAGES_PER_BATCH)) {
+                ++mismatchedLengths;
+                std::fprintf(stderr, "  %s: mismatch at length %zu\n", kernelName(SPHINXHash::multiBufferKernel()), length);
+            }
+        }
+        SPHINX_CHECK(mismatchedLengths == 0);
+
+        size_t mismatchedBatches = 0;
+        for (size_t length : {size_t(0), size_t(1), size_t(32), size_t(55), size_t(56), size_t(63), size_t(64), size_t(65), size_t(119), size_t(120), size_t(128), size_t(MAX_MESSAGE_LENGTH)}) {
+            const std::vector<unsigned char> messages = makeMessages(2 * 16 + 1, length);
+            for (size_t count = 1; count <= 2 * 16 + 1; ++count) {
+                if (!checkBatch(messages, length, count)) {
+                    ++mismatchedBatches;
+                    std::fprintf(stderr, "  %s: mismatch at length %zu, batch %zu\n", kernelName(SPHINXHash::multiBufferKernel()), length, count);
+                }
+            }
+        }
+        SPHINX_CHECK(mismatchedBatches == 0);
+    }
+
+    // Function to check the batch address paths against generateAddress with the active kernel
+    void checkBatchAddresses(SPHINXKey::ThreadPool& pool) {
+        using namespace SPHINXKey;
+
+        // More than one ADDRESS_BATCH_GRAIN chunk and a partial hash group
+        constexpr size_t KEYS = 1000;
+        std::vector<SPHINXPubKey> publicKeys(KEYS);
+        const std::vector<unsigned char> keyBytes = makeMessages(KEYS, SPHINX_256_DIGEST_SIZE);
+        for (size_t i = 0; i < KEYS; ++i) {
+            std::memcpy(publicKeys[i].data(), keyBytes.data() + i * SPHINX_256_DIGEST_SIZE, SPHINX_256_DIGEST_SIZE);
+        }
+        std::vector<std::string> expected(KEYS);
+        for (size_t i = 0; i < KEYS; ++i) {
+            expected[i] = std::string(generateAddress(publicKeys[i], "SPHINX").view());
+        }
+
+        // Every prefix size up to a few hash groups on the calling thread, then the whole batch
+        std::vector<SPHINXAddress> addresses(KEYS);
+        size_t mismatches = 0;
+        for (size_t count = 0; count <= 200; ++count) {
+            generateAddresses(std::span<const SPHINXPubKey>(publicKeys.data(), count), "SPHINX", std::span<SPHINXAddress>(addresses.data(), count));
+            for (size_t i = 0; i < count; ++i) {
+                mismatches += addresses[i].view() != expected[i];
+            }
+        }
+        generateAddresses(publicKeys, "SPHINX", addresses);
+        for (size_t i = 0; i < KEYS; ++i) {
+            mismatches += addresses[i].view() != expected[i];
+        }
+        SPHINX_CHECK(mismatches == 0);
+
+        // Both arena orders on the pool
+        std::vector<char> buffer(KEYS * ADDRESS_MAX_LENGTH);
+        std::vector<AddressSlot> slots(KEYS);
+        for (AddressOrder order : {AddressOrder::Completion, AddressOrder::Deterministic}) {
+            AddressArena arena{buffer, slots};
+            const size_t used = generateAddresses(publicKeys, "SPHINX", arena, order, pool);
+            size_t arenaMismatches = 0;
+            size_t expectedUsed = 0;
+            for (size_t i = 0; i < KEYS; ++i) {
+                arenaMismatches += std::string_view(buffer.data() + slots[i].offset, slots[i].length) != expected[i];
+                expectedUsed += expected[i].size();
+            }
+            SPHINX_CHECK(arenaMismatches == 0);
+            SPHINX_CHECK(used == expectedUsed);
+            if (order == AddressOrder::Deterministic) {
+                std::string serial;
+                for (const std::string& address : expected) {
+                    serial += address;
+                }
+                SPHINX_CHECK(std::string_view(buffer.data(), used) == serial);
+            }
+        }
+    }
+} // namespace
+
+
+int main() {
+    // Step 1: Scalar hashers
+    checkScalarHashers();
+
+    // Step 2: Every kernel the CPU supports, widest last so the default is restored
+    SPHINXKey::ThreadPool pool(4);
+    for (MultiBufferKernel kernel : {MultiBufferKernel::Scalar, MultiBufferKernel::SSE41, MultiBufferKernel::AVX2, MultiBufferKernel::AVX512}) {
+        SPHINXHash::setMultiBufferKernel(kernel);
+        if (SPHINXHash::multiBufferKernel() != kernel) {
+            std::printf("%s: skipped, not supported by this CPU\n", kernelName(kernel));
+            continue;
+        }
+        const size_t failuresBefore = SPHINXTest::failures();
+        checkKernel();
+        checkBatchAddresses(pool);
+        std::printf("%s (%zu lanes): %s\n", kernelName(kernel), SPHINXHash::multiBufferLanes(kernel), SPHINXTest::failures() == failuresBefore ? "ok" : "FAILED");
+    }
+
+    return SPHINXTest::report("hasher_test");
+}
@@ -0,0 +1,389 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code checks the asynchronous key service (KeyService.hpp).
+
+// Build and run (from the repository root, linking the offline stand-ins for SPHINXHybridKey):
+    // g++ -std=c++20 -O2 -pthread -DSPHINX_KEY_NO_MAIN -Ibench/standin -I. tests/KeyServiceTest.cpp bench/HybridKeyStandIn.cpp KeyService.cpp KeypairPool.cpp Key.cpp Hasher.cpp ThreadPool.cpp SecureArena.cpp Serialization.cpp HybridKem.cpp -o key_service_test && ./key_service_test
+
+// Holding the worker:
+    // Most checks run a one-worker service whose worker is held by the continuation of a first request, which waits on a latch
+    // (the blocking the header forbids, used here on purpose), so the requests behind it stay queued or parked until the latch is released.
+
+// Batching:
+    // Runs of queued requests of one operation are taken as one batch, and every address matches generateAddress.
+
+// Cancellation and backpressure:
+    // Stopping the token of a queued future or a parked coroutine completes it at once with operation_canceled while the worker is still held,
+    // a coroutine past parkedCapacity is rejected with resource_unavailable_try_again, and many coroutines cancelled at random all complete exactly once.
+
+// Executor and shutdown:
+    // With an executor no continuation runs on a worker. Destroying the service completes queued and parked requests with operation_canceled
+    // and releases future callers waiting for queue space.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <latch>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <stop_token>
+#include <system_error>
+
+#include "Hybrid_key.hpp"
+#include "Key.hpp"
+#include "KeyService.hpp"
+#include "TestCheck.hpp"
+
+
+namespace {
+
+    using namespace SPHINXKey;
+
+    // Coroutine that starts at once and frees itself when it returns
+    struct Detached {
+        struct promise_type {
+            Detached get_return_object() { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    // What an awaiting coroutine saw
+    struct Outcome {
+        std::optional<SPHINXAddress> address;
+        std::error_code error;
+        std::thread::id thread;
+        std::atomic<bool> done{false};
+    };
+
+    Detached awaitAddress(KeyTask<SPHINXAddress> task, Outcome& outcome) {
+        try {
+            outcome.address = co_await task;
+        } catch (const std::system_error& error) {
+            outcome.error = error.code();
+        }
+        outcome.thread = std::this_thread::get_id();
+        outcome.done.store(true, std::memory_order_release);
+    }
+
+    // Function to hold the only worker of a service in the continuation of one request until release is counted down
+    Detached holdWorker(KeyService& service, std::latch& entered, std::latch& release) {
+        try {
+            co_await service.generateAddress(SPHINXPubKey{});
+        } catch (const std::exception&) {
+        }
+        entered.count_down();
+        release.wait();
+    }
+
+    SPHINXPubKey makePublicKey(uint32_t seed) {
+        SPHINXPubKey publicKey{};
+        uint32_t state = seed * 2654435761u + 1;
+        for (unsigned char& byte : publicKey) {
+            state = state * 1664525u + 1013904223u;
+            byte = static_cast<unsigned char>(state >> 24);
+        }
+        return publicKey;
+    }
+
+    bool expectedAddress(const SPHINXAddress& address, uint32_t seed) {
+        return address.view() == generateAddress(makePublicKey(seed), "").view();
+    }
+
+    template <typename T>
+    std::error_code futureError(std::future<T>& future) {
+        try {
+            future.get();
+        } catch (const std::system_error& error) {
+            return error.code();
+        }
+        return {};
+    }
+
+    template <typename T>
+    bool isReady(const std::future<T>& future) {
+        return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    // Function to wait up to ten seconds for a condition set by another thread
+    bool eventually(const std::function<bool()>& condition) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    KeyServiceOptions makeOptions(size_t workers, size_t queueCapacity, size_t maxBatch) {
+        KeyServiceOptions options;
+        options.workers = workers;
+        options.queueCapacity = queueCapacity;
+        options.maxBatch = maxBatch;
+        return options;
+    }
+
+    const std::error_code CANCELLED = std::make_error_code(std::errc::operation_canceled);
+    const std::error_code BUSY = std::make_error_code(std::errc::resource_unavailable_try_again);
+
+    // Function to check that runs of one operation are batched and produce the right results
+    void checkBatching() {
+        KeyService service(makeOptions(1, 1024, 8));
+        std::latch entered(1);
+        std::latch release(1);
+        holdWorker(service, entered, release);
+        entered.wait();
+
+        // Step 1: Queue 20 addresses, 3 key pairs, 2 key exchanges and 5 addresses behind the held worker
+        std::vector<std::future<SPHINXAddress>> addresses;
+        for (uint32_t seed = 0; seed < 20; ++seed) {
+            addresses.push_back(service.generateAddressAsync(makePublicKey(seed)));
+        }
+        std::vector<std::future<SPHINXHybridKey::HybridKeypair>> keypairs;
+        for (int i = 0; i < 3; ++i) {
+            keypairs.push_back(service.generateKeypairAsync());
+        }
+        for (int i = 0; i < 2; ++i) {
+            keypairs.push_back(service.keyExchangeAsync());
+        }
+        for (uint32_t seed = 20; seed < 25; ++seed) {
+            addresses.push_back(service.generateAddressAsync(makePublicKey(seed)));
+        }
+        SPHINX_CHECK(service.metrics().queued == 30);
+        SPHINX_CHECK(!isReady(addresses.front()));
+
+        // Step 2: Release the worker; the batches are 8 + 8 + 4 addresses, 3 key pairs, 2 key exchanges and 5 addresses
+        release.count_down();
+        size_t mismatches = 0;
+        for (uint32_t seed = 0; seed < addresses.size(); ++seed) {
+            mismatches += !expectedAddress(addresses[seed].get(), seed);
+        }
+        for (auto& keypair : keypairs) {
+            const SPHINXHybridKey::HybridKeypair result = keypair.get();
+            mismatches += result.merged_key.sphinxPubKey == SPHINXPubKey{};
+        }
+        SPHINX_CHECK(mismatches == 0);
+        const KeyServiceMetrics metrics = service.metrics();
+        SPHINX_CHECK(metrics.completed == 31 && metrics.batches == 7 && metrics.cancelled == 0 && metrics.queued == 0);
+    }
+
+    // Function to check that stopped requests complete at once and parked coroutines are bounded
+    void checkCancellation() {
+        KeyServiceOptions options = makeOptions(1, 4, 64);
+        options.parkedCapacity = 3;
+        KeyService service(std::move(options));
+        std::latch entered(1);
+        std::latch release(1);
+        holdWorker(service, entered, release);
+        entered.wait();
+
+        // Step 1: An already stopped token is rejected at submission
+        std::stop_source stopped;
+        stopped.request_stop();
+        std::future<SPHINXAddress> rejected = service.generateAddressAsync(makePublicKey(0), stopped.get_token());
+        SPHINX_CHECK(isReady(rejected) && futureError(rejected) == CANCELLED);
+
+        // Step 2: Fill the queue with futures, park three coroutines and see the fourth rejected
+        std::stop_source queuedStop;
+        std::vector<std::future<SPHINXAddress>> queued;
+        for (uint32_t seed = 1; seed <= 4; ++seed) {
+            queued.push_back(service.generateAddressAsync(makePublicKey(seed), seed == 2 ? queuedStop.get_token() : std::stop_token{}));
+        }
+        std::stop_source parkedStop;
+        std::vector<Outcome> parked(4);
+        for (uint32_t i = 0; i < parked.size(); ++i) {
+            awaitAddress(service.generateAddress(makePublicKey(10 + i), i == 1 ? parkedStop.get_token() : std::stop_token{}), parked[i]);
+        }
+        SPHINX_CHECK(parked[3].done && parked[3].error == BUSY && parked[3].thread == std::this_thread::get_id());
+        KeyServiceMetrics metrics = service.metrics();
+        SPHINX_CHECK(metrics.queued == 4 && metrics.waiting == 3 && metrics.rejected == 1 && metrics.cancelled == 1);
+
+        // Step 3: Stopping a queued future completes it now, and the first parked coroutine takes its place
+        queuedStop.request_stop();
+        SPHINX_CHECK(isReady(queued[1]) && futureError(queued[1]) == CANCELLED);
+        metrics = service.metrics();
+        SPHINX_CHECK(metrics.queued == 4 && metrics.waiting == 2 && metrics.cancelled == 2);
+
+        // Step 4: Stopping a parked coroutine resumes it on this thread
+        parkedStop.request_stop();
+        SPHINX_CHECK(parked[1].done && parked[1].error == CANCELLED && parked[1].thread == std::this_thread::get_id());
+        metrics = service.metrics();
+        SPHINX_CHECK(metrics.queued == 4 && metrics.waiting == 1 && metrics.cancelled == 3);
+        SPHINX_CHECK(!parked[0].done && !parked[2].done);
+
+        // Step 5: Release the worker; everything else completes with its address, on the worker
+        release.count_down();
+        size_t mismatches = 0;
+        for (uint32_t seed = 1; seed <= 4; ++seed) {
+            if (seed != 2) {
+                mismatches += !expectedAddress(queued[seed - 1].get(), seed);
+            }
+        }
+        SPHINX_CHECK(eventually([&] { return parked[0].done && parked[2].done; }));
+        for (uint32_t i : {0u, 2u}) {
+            mismatches += !parked[i].address || !expectedAddress(*parked[i].address, 10 + i) || parked[i].thread == std::this_thread::get_id();
+        }
+        SPHINX_CHECK(mismatches == 0);
+        metrics = service.metrics();
+        SPHINX_CHECK(metrics.completed == 1 + 5 && metrics.cancelled == 3 && metrics.rejected == 1);
+    }
+
+    // Function to cancel many coroutines at random while four workers serve them
+    void checkCancellationStress() {
+        constexpr size_t COUNT = 4000;
+        std::vector<Outcome> outcomes(COUNT);
+        std::vector<std::stop_source> sources(COUNT);
+        {
+            KeyService service(makeOptions(4, 16, 8));
+            std::thread stopper([&] {
+                for (size_t i = 0; i < COUNT; i += 2) {
+                    sources[(i * 7919) % COUNT].request_stop();
+                    if (i % 64 == 0) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+            for (size_t i = 0; i < COUNT; ++i) {
+                awaitAddress(service.generateAddress(makePublicKey(static_cast<uint32_t>(i)), sources[i].get_token()), outcomes[i]);
+            }
+            stopper.join();
+            SPHINX_CHECK(eventually([&] {
+                for (const Outcome& outcome : outcomes) {
+                    if (!outcome.done.load(std::memory_order_acquire)) {
+                        return false;
+                    }
+                }
+                return true;
+            }));
+            const KeyServiceMetrics metrics = service.metrics();
+            SPHINX_CHECK(metrics.completed + metrics.cancelled == COUNT && metrics.rejected == 0);
+        }
+
+        size_t mismatches = 0;
+        size_t cancelled = 0;
+        for (size_t i = 0; i < COUNT; ++i) {
+            if (outcomes[i].error == CANCELLED) {
+                ++cancelled;
+                mismatches += !sources[i].stop_requested();
+            } else {
+                mismatches += outcomes[i].error || !outcomes[i].address || !expectedAddress(*outcomes[i].address, static_cast<uint32_t>(i));
+            }
+        }
+        SPHINX_CHECK(mismatches == 0);
+        SPHINX_CHECK(cancelled <= COUNT / 2);
+    }
+
+    // Function to check that an executor receives every continuation
+    void checkExecutor() {
+        std::mutex mutex;
+        std::vector<std::coroutine_handle<>> posted;
+        KeyServiceOptions options = makeOptions(2, 8, 4);
+        options.executor = [&](std::coroutine_handle<> handle) {
+            std::lock_guard<std::mutex> lock(mutex);
+            posted.push_back(handle);
+        };
+        KeyService service(std::move(options));
+
+        constexpr size_t COUNT = 100;
+        std::vector<Outcome> outcomes(COUNT);
+        std::stop_source stop;
+        for (size_t i = 0; i < COUNT; ++i) {
+            awaitAddress(service.generateAddress(makePublicKey(static_cast<uint32_t>(i)), i == COUNT - 1 ? stop.get_token() : std::stop_token{}), outcomes[i]);
+        }
+        stop.request_stop();
+
+        // Run the posted continuations on this thread until every coroutine is done
+        size_t resumed = 0;
+        SPHINX_CHECK(eventually([&] {
+            std::vector<std::coroutine_handle<>> ready;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready.swap(posted);
+            }
+            for (std::coroutine_handle<> handle : ready) {
+                handle.resume();
+            }
+            resumed += ready.size();
+            return resumed == COUNT;
+        }));
+        size_t mismatches = 0;
+        for (size_t i = 0; i < COUNT; ++i) {
+            mismatches += !outcomes[i].done || outcomes[i].thread != std::this_thread::get_id();
+            if (!outcomes[i].error) {
+                mismatches += !outcomes[i].address || !expectedAddress(*outcomes[i].address, static_cast<uint32_t>(i));
+            } else {
+                mismatches += i != COUNT - 1 || outcomes[i].error != CANCELLED;
+            }
+        }
+        SPHINX_CHECK(mismatches == 0);
+    }
+
+    // Function to check that destroying the service completes what is waiting
+    void checkShutdown() {
+        auto service = std::make_unique<KeyService>(makeOptions(1, 2, 64));
+        std::latch entered(1);
+        std::latch release(1);
+        holdWorker(*service, entered, release);
+        entered.wait();
+
+        // Step 1: Two queued futures, two parked coroutines and a future caller blocked on the full queue
+        std::vector<std::future<SPHINXAddress>> queued;
+        queued.push_back(service->generateAddressAsync(makePublicKey(1)));
+        queued.push_back(service->generateAddressAsync(makePublicKey(2)));
+        std::vector<Outcome> parked(2);
+        awaitAddress(service->generateAddress(makePublicKey(3)), parked[0]);
+        awaitAddress(service->generateAddress(makePublicKey(4)), parked[1]);
+        std::promise<std::future<SPHINXAddress>> blockedResult;
+        std::thread blocked([&] { blockedResult.set_value(service->generateAddressAsync(makePublicKey(5))); });
+        SPHINX_CHECK(eventually([&] { return service->metrics().waiting == 2; }));
+
+        // Step 2: Destroy the service; the blocked caller returns once the destructor has taken the waiting requests, then the worker is released
+        std::future<std::future<SPHINXAddress>> blockedFuture = blockedResult.get_future();
+        std::thread destroyer([&] { service.reset(); });
+        blockedFuture.wait();
+        release.count_down();
+        destroyer.join();
+        blocked.join();
+
+        std::future<SPHINXAddress> blockedAddress = blockedFuture.get();
+        SPHINX_CHECK(futureError(blockedAddress) == CANCELLED);
+        SPHINX_CHECK(futureError(queued[0]) == CANCELLED && futureError(queued[1]) == CANCELLED);
+        SPHINX_CHECK(parked[0].done && parked[0].error == CANCELLED && parked[1].done && parked[1].error == CANCELLED);
+    }
+} // namespace
+
+
+int main() {
+    checkBatching();
+    checkCancellation();
+    checkCancellationStress();
+    checkExecutor();
+    checkShutdown();
+    return SPHINXTest::report("key_service_test");
+}
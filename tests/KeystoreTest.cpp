@@ -0,0 +1,370 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code checks the keystore file format.
+
+// Build and run (from the repository root, linking the offline stand-ins for SPHINXHybridKey):
+    // g++ -std=c++20 -O2 -pthread -DSPHINX_KEY_NO_MAIN -Ibench/standin -I. tests/KeystoreTest.cpp bench/HybridKeyStandIn.cpp Keystore.cpp Key.cpp Hasher.cpp ThreadPool.cpp SecureArena.cpp Serialization.cpp HybridKem.cpp -o keystore_test && ./keystore_test
+
+// Records and lookups:
+    // Key pairs are appended in batches that grow the capacity, read back in place and through keypair(), and found by address, before and after reopening.
+    // A repeated key pair keeps the record number of its first copy, whether the copies arrive in one batch, in the tail or after the index was written.
+    // Loading many records in batches, and in one batch larger than KEYSTORE_MAX_UNINDEXED, and past the capacity, must keep every address findable and the file free of dead index runs.
+
+// Headers:
+    // Corrupting the newest header slot falls back to the previous generation, corrupting both rejects the file, and so does a truncated file.
+    // Headers with a recomputed checksum but a capacity, count or index run that does not fit the file are rejected without reading outside the mapping.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <span>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <functional>
+#include <filesystem>
+
+#include <unistd.h>
+
+#include "Hybrid_key.hpp"
+#include "Key.hpp"
+#include "Hasher.hpp"
+#include "Keystore.hpp"
+#include "TestCheck.hpp"
+
+
+namespace {
+
+    using SPHINXHybridKey::HybridKeypair;
+    using SPHINXKey::Keystore;
+
+    // Mirror of the header slot written by Keystore.cpp, for crafting headers with a valid checksum
+    struct CraftedHeader {
+        std::array<char, 8> magic;
+        uint32_t formatVersion;
+        uint32_t byteOrder;
+        uint32_t recordSize;
+        uint32_t recordStride;
+        uint32_t sphinxKeySize;
+        uint32_t pkePublicKeySize;
+        uint32_t pkePrivateKeySize;
+        uint32_t addressMaxLength;
+        uint64_t generation;
+        uint64_t capacity;
+        uint64_t recordCount;
+        uint64_t indexedRecords;
+        uint64_t runCount;
+        std::array<uint64_t, 2 * 64> runs;
+        std::array<unsigned char, 8> checksum;
+    };
+
+    constexpr size_t HEADER_SLOT_SIZE = 2048;
+    constexpr size_t PAGE_SIZE = 4096;
+
+    // Deterministic key pair, distinct for every seed; the keystore never looks inside the keys
+    HybridKeypair makeKeypair(uint32_t seed) {
+        HybridKeypair keypair;
+        uint32_t state = seed * 2654435761u + 1;
+        const auto fill = [&state](std::span<unsigned char> bytes) {
+            for (unsigned char& byte : bytes) {
+                state = state * 1664525u + 1013904223u;
+                byte = static_cast<unsigned char>(state >> 24);
+            }
+        };
+        fill(keypair.merged_key.sphinxPrivKey);
+        fill(keypair.merged_key.sphinxPubKey);
+        fill(keypair.public_key_pke);
+        fill(keypair.secret_key_pke);
+        std::memcpy(keypair.merged_key.sphinxPubKey.data(), &seed, sizeof(seed));
+        return keypair;
+    }
+
+    std::vector<HybridKeypair> makeKeypairs(uint32_t first, size_t count) {
+        std::vector<HybridKeypair> keypairs;
+        keypairs.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            keypairs.push_back(makeKeypair(first + static_cast<uint32_t>(i)));
+        }
+        return keypairs;
+    }
+
+    bool sameKeypair(const HybridKeypair& a, const HybridKeypair& b) {
+        return a.merged_key.sphinxPrivKey == b.merged_key.sphinxPrivKey && a.merged_key.sphinxPubKey == b.merged_key.sphinxPubKey &&
+               a.public_key_pke == b.public_key_pke && a.secret_key_pke == b.secret_key_pke;
+    }
+
+    std::string address(const HybridKeypair& keypair) {
+        return std::string(SPHINXKey::generateAddress(keypair.merged_key.sphinxPubKey, "").view());
+    }
+
+    // Function to check that every record matches the key pair it was appended from and is found at its first occurrence
+    void checkContents(const Keystore& keystore, const std::vector<HybridKeypair>& expected, const std::vector<size_t>& firstRecord) {
+        if (!SPHINX_CHECK(keystore.size() == expected.size())) {
+            return;
+        }
+        size_t mismatches = 0;
+        for (size_t i = 0; i < expected.size(); ++i) {
+            const std::string expectedAddress = address(expected[i]);
+            const std::optional<size_t> found = keystore.findByAddress(expectedAddress);
+            mismatches += !keystore.verify(i) || !sameKeypair(keystore.keypair(i), expected[i]) || keystore.address(i) != expectedAddress ||
+                          keystore.publicKey(i) != expected[i].merged_key.sphinxPubKey || !found || *found != firstRecord[i];
+        }
+        SPHINX_CHECK(mismatches == 0);
+    }
+
+    std::string temporaryPath(const char* name) {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / (std::string("sphinx_keystore_test_") + std::to_string(::getpid()) + "_" + name);
+        std::filesystem::remove(path);
+        return path.string();
+    }
+
+    // Function to return why a keystore does not open, or an empty string if it does
+    std::string openError(const std::string& path) {
+        try {
+            Keystore::open(path);
+            return "";
+        } catch (const std::runtime_error& error) {
+            return error.what();
+        }
+    }
+
+    bool opens(const std::string& path) {
+        return openError(path).empty();
+    }
+
+    std::vector<unsigned char> readFile(const std::string& path) {
+        std::vector<unsigned char> bytes(std::filesystem::file_size(path));
+        FILE* file = std::fopen(path.c_str(), "rb");
+        const size_t got = std::fread(bytes.data(), 1, bytes.size(), file);
+        std::fclose(file);
+        bytes.resize(got);
+        return bytes;
+    }
+
+    void writeFile(const std::string& path, const std::vector<unsigned char>& bytes) {
+        FILE* file = std::fopen(path.c_str(), "wb");
+        std::fwrite(bytes.data(), 1, bytes.size(), file);
+        std::fclose(file);
+    }
+
+    // Function to read the header slot holding the newest generation
+    CraftedHeader newestHeader(const std::vector<unsigned char>& file, size_t& slot) {
+        CraftedHeader slots[2];
+        std::memcpy(&slots[0], file.data(), sizeof(CraftedHeader));
+        std::memcpy(&slots[1], file.data() + HEADER_SLOT_SIZE, sizeof(CraftedHeader));
+        slot = slots[1].generation > slots[0].generation ? 1 : 0;
+        return slots[slot];
+    }
+
+    // Function to write a header with a recomputed checksum into both slots
+    void writeHeader(std::vector<unsigned char>& file, CraftedHeader header) {
+        const SPHINXHash::SPHINX256Digest digest = SPHINXHash::SPHINX_256(std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(&header), offsetof(CraftedHeader, checksum)));
+        std::copy_n(digest.begin(), header.checksum.size(), header.checksum.begin());
+        for (size_t slot = 0; slot < 2; ++slot) {
+            std::memcpy(file.data() + slot * HEADER_SLOT_SIZE, &header, sizeof(header));
+        }
+    }
+
+    uint64_t recordEnd(uint64_t capacity) {
+        return (2 * HEADER_SLOT_SIZE + capacity * SPHINXKey::KEYSTORE_RECORD_STRIDE + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+    }
+
+    // Function to append, grow, reopen and look up records
+    void checkAppendAndReopen() {
+        const std::string path = temporaryPath("append.keys");
+        std::vector<HybridKeypair> expected;
+        std::vector<size_t> firstRecord;
+        const auto remember = [&](const std::vector<HybridKeypair>& batch, Keystore& keystore) {
+            keystore.append(batch);
+            for (const HybridKeypair& keypair : batch) {
+                size_t first = expected.size();
+                for (size_t i = 0; i < expected.size(); ++i) {
+                    if (sameKeypair(expected[i], keypair)) {
+                        first = i;
+                        break;
+                    }
+                }
+                expected.push_back(keypair);
+                firstRecord.push_back(first);
+            }
+        };
+
+        {
+            Keystore keystore = Keystore::create(path, 4);
+            SPHINX_CHECK(keystore.size() == 0);
+            SPHINX_CHECK(!keystore.findByAddress(address(makeKeypair(1))));
+
+            // A repeated key pair within a batch, in the tail, after a flush and after growing
+            remember({makeKeypair(1), makeKeypair(1), makeKeypair(2)}, keystore);
+            SPHINX_CHECK(*keystore.findByAddress(address(makeKeypair(1))) == 0);
+            keystore.flushIndex();
+            remember({makeKeypair(3), makeKeypair(1)}, keystore);
+            remember(makeKeypairs(100, 37), keystore);
+            remember({makeKeypair(3), makeKeypair(120)}, keystore);
+            checkContents(keystore, expected, firstRecord);
+            keystore.flushIndex();
+            checkContents(keystore, expected, firstRecord);
+            remember({makeKeypair(2)}, keystore);
+            checkContents(keystore, expected, firstRecord);
+
+            SPHINX_CHECK(!keystore.findByAddress("not an address"));
+            SPHINX_CHECK(!keystore.findByAddress(address(makeKeypair(99))));
+        }
+
+        Keystore reader = Keystore::open(path);
+        checkContents(reader, expected, firstRecord);
+        bool threw = false;
+        try {
+            reader.append(makeKeypairs(500, 1));
+        } catch (const std::logic_error&) {
+            threw = true;
+        }
+        SPHINX_CHECK(threw);
+
+        Keystore writer = Keystore::open(path, true);
+        remember(makeKeypairs(600, 5), writer);
+        checkContents(writer, expected, firstRecord);
+        checkContents(Keystore::open(path), expected, firstRecord);
+        std::filesystem::remove(path);
+    }
+
+    // Function to load many records and check that the index runs stay findable and compact
+    void checkManyRecords() {
+        const std::string path = temporaryPath("many.keys");
+        std::vector<HybridKeypair> expected;
+        {
+            // Enough capacity that the index runs are written and merged by append, not by growing
+            Keystore keystore = Keystore::create(path, 20000);
+            for (uint32_t batch = 0; batch < 40; ++batch) {
+                const std::vector<HybridKeypair> keypairs = makeKeypairs(10000 + batch * 250, 250);
+                keystore.append(keypairs);
+                expected.insert(expected.end(), keypairs.begin(), keypairs.end());
+            }
+
+            // One batch larger than the unindexed limit is indexed before its header is committed
+            const std::vector<HybridKeypair> large = makeKeypairs(50000, 9000);
+            keystore.append(large);
+            expected.insert(expected.end(), large.begin(), large.end());
+
+            // Growing moves every run past the new record slots
+            const std::vector<HybridKeypair> grown = makeKeypairs(70000, 2000);
+            keystore.append(grown);
+            expected.insert(expected.end(), grown.begin(), grown.end());
+            keystore.flushIndex();
+        }
+
+        std::vector<size_t> firstRecord(expected.size());
+        for (size_t i = 0; i < firstRecord.size(); ++i) {
+            firstRecord[i] = i;
+        }
+        const Keystore keystore = Keystore::open(path);
+        checkContents(keystore, expected, firstRecord);
+
+        // The file holds the record slots, the live runs and at most a page of padding per run, nothing written past a merge
+        const std::vector<unsigned char> file = readFile(path);
+        size_t slot;
+        const CraftedHeader header = newestHeader(file, slot);
+        SPHINX_CHECK(header.indexedRecords == expected.size() && header.runCount >= 1 && header.runCount <= 16);
+        SPHINX_CHECK(file.size() <= recordEnd(header.capacity) + expected.size() * 32 + header.runCount * PAGE_SIZE);
+        std::filesystem::remove(path);
+    }
+
+    // Function to check torn and crafted headers
+    void checkHeaders() {
+        const std::string path = temporaryPath("header.keys");
+        {
+            Keystore keystore = Keystore::create(path, 8);
+            keystore.append(makeKeypairs(1, 3));
+            keystore.append(makeKeypairs(10, 2));
+        }
+        const std::vector<unsigned char> original = readFile(path);
+        size_t newest;
+        const CraftedHeader base = newestHeader(original, newest);
+
+        // A torn newest header falls back to the previous generation, two torn headers reject the file
+        std::vector<unsigned char> torn = original;
+        torn[newest * HEADER_SLOT_SIZE + 60] ^= 1;
+        writeFile(path, torn);
+        SPHINX_CHECK(opens(path) && Keystore::open(path).size() == 3);
+        torn[(1 - newest) * HEADER_SLOT_SIZE + 60] ^= 1;
+        writeFile(path, torn);
+        SPHINX_CHECK(!opens(path));
+
+        // A file cut inside the committed records, or shorter than the header slots
+        std::vector<unsigned char> truncated(original.begin(), original.begin() + 2 * HEADER_SLOT_SIZE + 4 * SPHINXKey::KEYSTORE_RECORD_STRIDE);
+        writeFile(path, truncated);
+        SPHINX_CHECK(!opens(path));
+        truncated.resize(100);
+        writeFile(path, truncated);
+        SPHINX_CHECK(!opens(path));
+
+        // Headers with a recomputed checksum: the unchanged header opens, every out-of-bounds field is rejected
+        const uint64_t runStart = recordEnd(base.capacity);
+        const std::pair<const char*, std::function<void(CraftedHeader&)>> cases[] = {
+            {"unchanged", [](CraftedHeader&) {}},
+            {"capacity past the file", [](CraftedHeader& h) { h.capacity = 1000; }},
+            {"capacity wrapping the record offset", [](CraftedHeader& h) { h.capacity = UINT64_MAX / 64; }},
+            {"count above capacity", [](CraftedHeader& h) { h.recordCount = h.capacity + 1; }},
+            {"indexed above count", [](CraftedHeader& h) { h.indexedRecords = h.recordCount + 1; }},
+            {"too many runs", [](CraftedHeader& h) { h.runCount = 65; }},
+            {"run inside the records", [&](CraftedHeader& h) { h.runCount = 1; h.runs[0] = runStart - PAGE_SIZE; h.runs[1] = 1; }},
+            {"run inside the header slots", [](CraftedHeader& h) { h.runCount = 1; h.runs[0] = 0; h.runs[1] = 1; }},
+            {"unaligned run", [&](CraftedHeader& h) { h.runCount = 1; h.runs[0] = runStart + 8; h.runs[1] = 1; }},
+            {"run past the file", [&](CraftedHeader& h) { h.runCount = 1; h.runs[0] = runStart + 1024 * PAGE_SIZE; h.runs[1] = 1; }},
+            {"run wrapping the file", [&](CraftedHeader& h) { h.runCount = 1; h.runs[0] = runStart; h.runs[1] = UINT64_MAX / 32 + 2; }},
+            {"more entries than indexed records", [&](CraftedHeader& h) { h.runCount = 1; h.runs[0] = runStart; h.runs[1] = h.indexedRecords + 1; }},
+        };
+        for (const auto& [name, craft] : cases) {
+            CraftedHeader header = base;
+            craft(header);
+            std::vector<unsigned char> crafted = original;
+            crafted.resize(std::max<size_t>(crafted.size(), runStart + PAGE_SIZE));
+            writeHeader(crafted, header);
+            writeFile(path, crafted);
+            const bool expectOpen = std::string(name) == "unchanged";
+            if (opens(path) != expectOpen) {
+                std::fprintf(stderr, "crafted header: %s\n", name);
+                SPHINX_CHECK(opens(path) == expectOpen);
+            }
+        }
+
+        // open() scans at most 4096 unindexed records: one more rejects the header before any record is read
+        std::vector<unsigned char> file = original;
+        file.resize(recordEnd(5000));
+        CraftedHeader header = base;
+        SPHINX_CHECK(header.indexedRecords == 0);
+        header.capacity = 5000;
+        header.recordCount = 4096;
+        writeHeader(file, header);
+        writeFile(path, file);
+        SPHINX_CHECK(openError(path).find("checksum mismatch") != std::string::npos);
+        header.recordCount = 4097;
+        writeHeader(file, header);
+        writeFile(path, file);
+        SPHINX_CHECK(openError(path).find("not a keystore") != std::string::npos);
+        std::filesystem::remove(path);
+    }
+} // namespace
+
+int main() {
+    checkAppendAndReopen();
+    checkManyRecords();
+    checkHeaders();
+    return SPHINXTest::report("keystore_test");
+}
@@ -0,0 +1,260 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code checks hex and binary serialization (Serialization.hpp).
+
+// Build and run (from the repository root, linking the offline stand-ins for SPHINXHybridKey):
+    // g++ -std=c++20 -O2 -pthread -DSPHINX_KEY_NO_MAIN -Ibench/standin -I. tests/SerializationTest.cpp bench/HybridKeyStandIn.cpp Key.cpp Hasher.cpp ThreadPool.cpp SecureArena.cpp Serialization.cpp HybridKem.cpp -o serialization_test && ./serialization_test
+
+// Hex:
+    // hexEncode must match snprintf("%02x") for every byte value and for lengths 0..100 (vector blocks and scalar tails), and hexDecode must invert it
+    // in either case. Every non-hex character, at every position of a block and of a tail, is rejected, as are odd lengths and mismatched outputs.
+    // toHex and hexEncodeKeys write the same text; short output buffers throw std::length_error.
+
+// Wire format:
+    // Key pairs with empty, short and long shared secrets round-trip through serializeKeypair, parseKeypair and deserializeKeypair, back to back in one buffer.
+    // Every truncation, a wrong magic, version or field count, and every fixed field length off by one (or wrapping the input size) throw std::invalid_argument.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <span>
+#include <array>
+#include <string>
+#include <vector>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+#include "Hybrid_key.hpp"
+#include "Key.hpp"
+#include "Serialization.hpp"
+#include "TestCheck.hpp"
+
+
+namespace {
+
+    using namespace SPHINXKey;
+    using SPHINXHybridKey::HybridKeypair;
+
+    std::vector<unsigned char> makeBytes(size_t length, uint32_t seed) {
+        std::vector<unsigned char> bytes(length);
+        uint32_t state = seed * 2654435761u + 1;
+        for (unsigned char& byte : bytes) {
+            state = state * 1664525u + 1013904223u;
+            byte = static_cast<unsigned char>(state >> 24);
+        }
+        return bytes;
+    }
+
+    // Hex text written one byte at a time with %02x
+    std::string printfHex(const std::vector<unsigned char>& bytes) {
+        std::string hex;
+        char pair[3];
+        for (unsigned char byte : bytes) {
+            std::snprintf(pair, sizeof(pair), "%02x", byte);
+            hex.append(pair, 2);
+        }
+        return hex;
+    }
+
+    std::string encode(const std::vector<unsigned char>& bytes) {
+        std::string hex(2 * bytes.size(), '\0');
+        hex.resize(hexEncode(bytes, hex));
+        return hex;
+    }
+
+    template <typename Function>
+    bool throwsLengthError(Function function) {
+        try {
+            function();
+        } catch (const std::length_error&) {
+            return true;
+        }
+        return false;
+    }
+
+    // Function to check hex encoding and decoding
+    void checkHex() {
+        // Step 1: Every byte value, and lengths across vector blocks and tails
+        std::vector<unsigned char> everyByte(256);
+        for (size_t i = 0; i < everyByte.size(); ++i) {
+            everyByte[i] = static_cast<unsigned char>(i);
+        }
+        size_t mismatches = encode(everyByte) != printfHex(everyByte);
+        for (size_t length = 0; length <= 100; ++length) {
+            const std::vector<unsigned char> bytes = makeBytes(length, static_cast<uint32_t>(length));
+            const std::string hex = encode(bytes);
+            mismatches += hex != printfHex(bytes);
+
+            std::string upper = hex;
+            for (char& c : upper) {
+                c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            }
+            std::vector<unsigned char> decoded(length, 0x5a);
+            mismatches += !hexDecode(hex, decoded) || decoded != bytes;
+            std::fill(decoded.begin(), decoded.end(), 0x5a);
+            mismatches += !hexDecode(upper, decoded) || decoded != bytes;
+        }
+        SPHINX_CHECK(mismatches == 0);
+
+        // Step 2: Every non-hex character at every position of 20 bytes (two vector blocks and a tail)
+        const std::string hex = encode(makeBytes(20, 1));
+        std::vector<unsigned char> decoded(20);
+        size_t accepted = 0;
+        for (int c = 0; c < 256; ++c) {
+            if (std::isxdigit(c)) {
+                continue;
+            }
+            for (size_t i = 0; i < hex.size(); ++i) {
+                std::string corrupted = hex;
+                corrupted[i] = static_cast<char>(c);
+                accepted += hexDecode(corrupted, decoded);
+            }
+        }
+        SPHINX_CHECK(accepted == 0);
+        SPHINX_CHECK(!hexDecode(std::string_view(hex).substr(1), std::span<unsigned char>(decoded.data(), 19)));
+        SPHINX_CHECK(!hexDecode(hex, std::span<unsigned char>(decoded.data(), 19)));
+        SPHINX_CHECK(hexDecode("", std::span<unsigned char>()));
+
+        // Step 3: toHex, hexEncodeKeys and short outputs
+        std::vector<SPHINXPubKey> keys(3);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            const std::vector<unsigned char> bytes = makeBytes(keys[i].size(), static_cast<uint32_t>(100 + i));
+            std::copy(bytes.begin(), bytes.end(), keys[i].begin());
+        }
+        keys[1][0] = 0;
+        std::string lines(keys.size() * (2 * SPHINX_256_DIGEST_SIZE + 1), '\0');
+        SPHINX_CHECK(hexEncodeKeys(keys, lines, ';') == lines.size());
+        std::string expected;
+        for (const SPHINXPubKey& key : keys) {
+            const std::string text = printfHex(std::vector<unsigned char>(key.begin(), key.end()));
+            SPHINX_CHECK(toHex(key).view() == text);
+            expected += text + ";";
+        }
+        SPHINX_CHECK(lines == expected);
+
+        std::string small(2 * 10 - 1, '\0');
+        SPHINX_CHECK(throwsLengthError([&] { hexEncode(makeBytes(10, 2), small); }));
+        SPHINX_CHECK(throwsLengthError([&] { hexEncodeKeys(keys, std::span<char>(lines.data(), lines.size() - 1)); }));
+    }
+
+    HybridKeypair makeKeypair(uint32_t seed, size_t secretLength) {
+        HybridKeypair keypair;
+        const auto fill = [&](std::span<unsigned char> field) {
+            const std::vector<unsigned char> bytes = makeBytes(field.size(), seed++);
+            std::copy(bytes.begin(), bytes.end(), field.begin());
+        };
+        fill(keypair.merged_key.sphinxPrivKey);
+        fill(keypair.merged_key.sphinxPubKey);
+        fill(keypair.public_key_pke);
+        fill(keypair.secret_key_pke);
+        const std::vector<unsigned char> secret = makeBytes(secretLength, seed);
+        keypair.shared_secret.assign(secret.begin(), secret.end());
+        return keypair;
+    }
+
+    bool sameKeypair(const HybridKeypair& a, const HybridKeypair& b) {
+        return a.merged_key.sphinxPrivKey == b.merged_key.sphinxPrivKey && a.merged_key.sphinxPubKey == b.merged_key.sphinxPubKey &&
+               a.public_key_pke == b.public_key_pke && a.secret_key_pke == b.secret_key_pke && a.shared_secret == b.shared_secret;
+    }
+
+    // Function to return why parsing fails, or an empty string if it succeeds
+    std::string parseError(std::span<const unsigned char> in) {
+        try {
+            parseKeypair(in);
+            return "";
+        } catch (const std::invalid_argument& error) {
+            return error.what();
+        }
+    }
+
+    bool mentions(const std::string& error, const char* text) {
+        return error.find(text) != std::string::npos;
+    }
+
+    // Function to check the key pair wire format
+    void checkWireFormat() {
+        // Step 1: Round trips of key pairs written back to back
+        const std::vector<HybridKeypair> keypairs = {makeKeypair(1, 0), makeKeypair(10, 32), makeKeypair(20, 5000)};
+        std::vector<unsigned char> buffer;
+        for (const HybridKeypair& keypair : keypairs) {
+            const size_t offset = buffer.size();
+            buffer.resize(offset + serializedSize(keypair));
+            SPHINX_CHECK(serializeKeypair(keypair, std::span<unsigned char>(buffer).subspan(offset)) == serializedSize(keypair));
+        }
+        size_t offset = 0;
+        HybridKeypair reused = makeKeypair(99, 64);
+        for (const HybridKeypair& keypair : keypairs) {
+            const std::span<const unsigned char> rest = std::span<const unsigned char>(buffer).subspan(offset);
+            const HybridKeypairView view = parseKeypair(rest);
+            SPHINX_CHECK(view.size == serializedSize(keypair) && view.sphinxPubKey.data() > buffer.data() && sameKeypair(view.toKeypair(), keypair));
+            SPHINX_CHECK(deserializeKeypair(rest, reused) == view.size && sameKeypair(reused, keypair));
+            offset += view.size;
+        }
+        SPHINX_CHECK(offset == buffer.size());
+        SPHINX_CHECK(throwsLengthError([&] { serializeKeypair(keypairs[1], std::span<unsigned char>(buffer.data(), serializedSize(keypairs[1]) - 1)); }));
+
+        // Step 2: Every truncation of one key pair
+        std::vector<unsigned char> wire(serializedSize(keypairs[1]));
+        serializeKeypair(keypairs[1], wire);
+        size_t accepted = 0;
+        for (size_t length = 0; length < wire.size(); ++length) {
+            const std::string error = parseError(std::span<const unsigned char>(wire.data(), length));
+            accepted += !mentions(error, "truncated") && !mentions(error, "not a serialized key pair");
+        }
+        SPHINX_CHECK(accepted == 0);
+
+        // Step 3: Header fields
+        for (size_t i = 0; i < KEYPAIR_WIRE_HEADER_SIZE; ++i) {
+            std::vector<unsigned char> corrupted = wire;
+            corrupted[i] ^= 0x01;
+            SPHINX_CHECK(!parseError(corrupted).empty());
+        }
+
+        // Step 4: Field lengths; the fixed fields must have this build's size, the shared secret must fit the input
+        const size_t fixedSizes[] = {SPHINX_256_DIGEST_SIZE, SPHINX_256_DIGEST_SIZE, KYBER1024_PKE_PUBLIC_KEY_LENGTH, KYBER1024_PKE_PRIVATE_KEY_LENGTH};
+        size_t lengthOffset = KEYPAIR_WIRE_HEADER_SIZE;
+        for (size_t size : fixedSizes) {
+            for (uint32_t length : {uint32_t(0), uint32_t(size - 1), uint32_t(size + 1), UINT32_MAX}) {
+                std::vector<unsigned char> corrupted = wire;
+                for (size_t k = 0; k < 4; ++k) {
+                    corrupted[lengthOffset + k] = static_cast<unsigned char>(length >> (8 * k));
+                }
+                SPHINX_CHECK(mentions(parseError(corrupted), "field length"));
+            }
+            lengthOffset += 4 + size;
+        }
+        for (uint32_t length : {uint32_t(33), UINT32_MAX - 3, UINT32_MAX}) {
+            std::vector<unsigned char> corrupted = wire;
+            for (size_t k = 0; k < 4; ++k) {
+                corrupted[lengthOffset + k] = static_cast<unsigned char>(length >> (8 * k));
+            }
+            SPHINX_CHECK(mentions(parseError(corrupted), "truncated"));
+        }
+        std::vector<unsigned char> shorter = wire;
+        shorter[lengthOffset] = 31;
+        SPHINX_CHECK(parseError(shorter).empty() && parseKeypair(shorter).size == wire.size() - 1);
+    }
+} // namespace
+
+
+int main() {
+    checkHex();
+    checkWireFormat();
+    return SPHINXTest::report("serialization_test");
+}
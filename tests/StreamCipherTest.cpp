@@ -0,0 +1,243 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The provided code checks the ChaCha20-Poly1305 implementation and the streaming encryption built on it.
+
+// Build and run (from the repository root, linking the offline stand-ins for SPHINXHybridKey):
+    // g++ -std=c++20 -O2 -pthread -DSPHINX_KEY_NO_MAIN -Ibench/standin -I. tests/StreamCipherTest.cpp bench/HybridKeyStandIn.cpp StreamCipher.cpp Key.cpp Hasher.cpp ThreadPool.cpp SecureArena.cpp Serialization.cpp HybridKem.cpp -o stream_cipher_test && ./stream_cipher_test
+
+// Known answers (RFC 8439):
+    // Section 2.4.2: ChaCha20 encryption of the "sunscreen" plaintext with block counter 1.
+    // Section 2.5.2: Poly1305 tag of "Cryptographic Forum Research Group".
+    // Section 2.8.2: ChaCha20-Poly1305 AEAD encryption of the "sunscreen" plaintext with additional data, checked for the ciphertext and the tag,
+    // then decrypted back; aeadDecrypt must reject the ciphertext when any single bit of the tag, the ciphertext or the additional data is flipped.
+
+// Streams:
+    // Plaintexts of several lengths around the chunk size (empty, shorter than one chunk, an exact multiple, and many chunks plus a tail) are encrypted
+    // with encryptStream to a stand-in key pair and decrypted with decryptStream. decryptStream must throw std::runtime_error for a flipped tag bit,
+    // a flipped ciphertext bit, two swapped chunks, and a stream cut off at a chunk boundary.
+    // Decrypting with the wrong key pair is not checked: the stand-in KEM derives the shared secret from the encapsulated key alone.
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <span>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+
+#include "Hybrid_key.hpp"
+#include "Key.hpp"
+#include "StreamCipher.hpp"
+#include "TestCheck.hpp"
+
+
+namespace {
+
+    using namespace SPHINXKey;
+
+    std::vector<unsigned char> fromHex(std::string_view hex) {
+        std::vector<unsigned char> bytes;
+        for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+            if (hex[i] == ' ' || hex[i] == ':') {
+                --i;
+                continue;
+            }
+            bytes.push_back(static_cast<unsigned char>(std::stoi(std::string(hex.substr(i, 2)), nullptr, 16)));
+        }
+        return bytes;
+    }
+
+    template <typename Array>
+    Array arrayFromHex(std::string_view hex) {
+        const std::vector<unsigned char> bytes = fromHex(hex);
+        Array array{};
+        SPHINX_CHECK(bytes.size() == array.size());
+        std::copy_n(bytes.begin(), std::min(bytes.size(), array.size()), array.begin());
+        return array;
+    }
+
+    std::span<const unsigned char> bytesOf(std::string_view text) {
+        return std::span<const unsigned char>(reinterpret_cast<const unsigned char*>(text.data()), text.size());
+    }
+
+    constexpr std::string_view SUNSCREEN = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, sunscreen would be it.";
+
+    // Function to check ChaCha20 against RFC 8439 section 2.4.2
+    void checkChaCha20() {
+        const AeadKey key = arrayFromHex<AeadKey>("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f");
+        const AeadNonce nonce = arrayFromHex<AeadNonce>("000000000000004a00000000");
+        const std::vector<unsigned char> expected = fromHex(
+            "6e2e359a2568f98041ba0728dd0d6981e97e7aec1d4360c20a27afccfd9fae0b"
+            "f91b65c5524733ab8f593dabcd62b3571639d624e65152ab8f530c359f0861d8"
+            "07ca0dbf500d6a6156a38e088a22b65e52bc514d16ccf806818ce91ab7793736"
+            "5af90bbf74a35be6b40b8eedf2785e42874d");
+
+        std::vector<unsigned char> ciphertext(SUNSCREEN.size());
+        chacha20Encrypt(key, 1, nonce, bytesOf(SUNSCREEN), ciphertext.data());
+        SPHINX_CHECK(ciphertext == expected);
+
+        // Decrypting in place restores the plaintext
+        chacha20Encrypt(key, 1, nonce, ciphertext, ciphertext.data());
+        SPHINX_CHECK(std::equal(ciphertext.begin(), ciphertext.end(), bytesOf(SUNSCREEN).begin()));
+    }
+
+    // Function to check Poly1305 against RFC 8439 section 2.5.2
+    void checkPoly1305() {
+        const std::vector<unsigned char> key = fromHex("85d6be7857556d337f4452fe42d506a80103808afb0db2fd4abff6af4149f51b");
+        const AeadTag expected = arrayFromHex<AeadTag>("a8061dc1305136c6c22b8baf0c0127a9");
+        SPHINX_CHECK(poly1305(std::span<const unsigned char, 32>(key.data(), 32), bytesOf("Cryptographic Forum Research Group")) == expected);
+    }
+
+    // Function to check the AEAD against RFC 8439 section 2.8.2 and its tag checks against single-bit changes
+    void checkAead() {
+        const AeadKey key = arrayFromHex<AeadKey>("808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f");
+        const AeadNonce nonce = arrayFromHex<AeadNonce>("070000004041424344454647");
+        std::vector<unsigned char> aad = fromHex("50515253c0c1c2c3c4c5c6c7");
+        const std::vector<unsigned char> expectedCiphertext = fromHex(
+            "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d6"
+            "3dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b36"
+            "92ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+            "3ff4def08e4b7a9de576d26586cec64b6116");
+        const AeadTag expectedTag = arrayFromHex<AeadTag>("1ae10b594f09e26a7e902ecbd0600691");
+
+        std::vector<unsigned char> ciphertext(SUNSCREEN.size());
+        AeadTag tag = aeadEncrypt(key, nonce, aad, bytesOf(SUNSCREEN), ciphertext.data());
+        SPHINX_CHECK(ciphertext == expectedCiphertext);
+        SPHINX_CHECK(tag == expectedTag);
+
+        std::vector<unsigned char> plaintext(ciphertext.size());
+        SPHINX_CHECK(aeadDecrypt(key, nonce, aad, ciphertext, tag, plaintext.data()));
+        SPHINX_CHECK(std::equal(plaintext.begin(), plaintext.end(), bytesOf(SUNSCREEN).begin()));
+
+        // Any flipped bit must be rejected, and nothing may be written
+        size_t accepted = 0;
+        std::fill(plaintext.begin(), plaintext.end(), 0);
+        for (size_t bit = 0; bit < 8 * tag.size(); ++bit) {
+            tag[bit / 8] ^= static_cast<unsigned char>(1u << (bit % 8));
+            accepted += aeadDecrypt(key, nonce, aad, ciphertext, tag, plaintext.data());
+            tag[bit / 8] ^= static_cast<unsigned char>(1u << (bit % 8));
+        }
+        for (size_t bit = 0; bit < 8 * ciphertext.size(); bit += 7) {
+            ciphertext[bit / 8] ^= static_cast<unsigned char>(1u << (bit % 8));
+            accepted += aeadDecrypt(key, nonce, aad, ciphertext, tag, plaintext.data());
+            ciphertext[bit / 8] ^= static_cast<unsigned char>(1u << (bit % 8));
+        }
+        for (size_t bit = 0; bit < 8 * aad.size(); ++bit) {
+            aad[bit / 8] ^= static_cast<unsigned char>(1u << (bit % 8));
+            accepted += aeadDecrypt(key, nonce, aad, ciphertext, tag, plaintext.data());
+            aad[bit / 8] ^= static_cast<unsigned char>(1u << (bit % 8));
+        }
+        SPHINX_CHECK(accepted == 0);
+        SPHINX_CHECK(std::all_of(plaintext.begin(), plaintext.end(), [](unsigned char byte) { return byte == 0; }));
+    }
+
+    // In-memory stream endpoints
+    StreamReader memoryReader(const std::vector<unsigned char>& source, size_t& position) {
+        return [&source, &position](std::span<unsigned char> buffer) {
+            const size_t n = std::min(buffer.size(), source.size() - position);
+            if (n > 0) {
+                std::memcpy(buffer.data(), source.data() + position, n);
+            }
+            position += n;
+            return n;
+        };
+    }
+
+    StreamWriter memoryWriter(std::vector<unsigned char>& sink) {
+        return [&sink](std::span<const unsigned char> buffer) {
+            sink.insert(sink.end(), buffer.begin(), buffer.end());
+        };
+    }
+
+    std::vector<unsigned char> encrypt(const SPHINXHybridKey::HybridKeypair& recipient, const std::vector<unsigned char>& plaintext, size_t chunkSize) {
+        size_t position = 0;
+        std::vector<unsigned char> stream;
+        SPHINX_CHECK(encryptStream(recipient, memoryReader(plaintext, position), memoryWriter(stream), chunkSize) == plaintext.size());
+        return stream;
+    }
+
+    // Function to decrypt a stream, returns false if decryptStream threw std::runtime_error
+    bool decrypt(const SPHINXHybridKey::HybridKeypair& keypair, const std::vector<unsigned char>& stream, std::vector<unsigned char>& plaintext) {
+        size_t position = 0;
+        plaintext.clear();
+        try {
+            const uint64_t length = decryptStream(keypair, memoryReader(stream, position), memoryWriter(plaintext));
+            return length == plaintext.size();
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+    }
+
+    // Function to round-trip streams of several lengths and check that tampering is detected
+    void checkStreams() {
+        constexpr size_t CHUNK = 1000;
+        const SPHINXHybridKey::HybridKeypair keypair = generate_hybrid_keypair();
+
+        for (size_t length : {size_t(0), size_t(1), CHUNK - 1, CHUNK, CHUNK + 1, 5 * CHUNK, 12 * CHUNK + 345}) {
+            std::vector<unsigned char> plaintext(length);
+            for (size_t i = 0; i < length; ++i) {
+                plaintext[i] = static_cast<unsigned char>(i * 131 + length);
+            }
+
+            // Step 1: Round trip; every chunk, the empty last one included, carries a tag
+            const std::vector<unsigned char> stream = encrypt(keypair, plaintext, CHUNK);
+            const size_t chunks = length / CHUNK + 1;
+            SPHINX_CHECK(stream.size() > length + chunks * AEAD_TAG_SIZE);
+            const size_t headerSize = stream.size() - length - chunks * AEAD_TAG_SIZE;
+            std::vector<unsigned char> decrypted;
+            SPHINX_CHECK(decrypt(keypair, stream, decrypted) && decrypted == plaintext);
+
+            // Step 2: A flipped bit in the tag of the first chunk, and in the last byte of the stream (the tag of the last chunk)
+            std::vector<unsigned char> corrupted = stream;
+            corrupted[headerSize + std::min(length, CHUNK)] ^= 0x01;
+            SPHINX_CHECK(!decrypt(keypair, corrupted, decrypted));
+            corrupted = stream;
+            corrupted.back() ^= 0x80;
+            SPHINX_CHECK(!decrypt(keypair, corrupted, decrypted));
+
+            // Step 3: A flipped ciphertext bit
+            if (length > 0) {
+                corrupted = stream;
+                corrupted[headerSize + length / 2 + (length / 2) / CHUNK * AEAD_TAG_SIZE] ^= 0x10;
+                SPHINX_CHECK(!decrypt(keypair, corrupted, decrypted));
+            }
+
+            // Step 4: Two full chunks swapped, and a stream cut off after its first full chunk
+            if (length >= 2 * CHUNK) {
+                corrupted = stream;
+                const size_t sealed = CHUNK + AEAD_TAG_SIZE;
+                std::swap_ranges(corrupted.begin() + headerSize, corrupted.begin() + headerSize + sealed, corrupted.begin() + headerSize + sealed);
+                SPHINX_CHECK(!decrypt(keypair, corrupted, decrypted));
+
+                corrupted.assign(stream.begin(), stream.begin() + headerSize + sealed);
+                SPHINX_CHECK(!decrypt(keypair, corrupted, decrypted));
+            }
+        }
+    }
+} // namespace
+
+
+int main() {
+    checkChaCha20();
+    checkPoly1305();
+    checkAead();
+    checkStreams();
+    return SPHINXTest::report("stream_cipher_test");
+}
@@ -0,0 +1,53 @@
+/*
+ *  Copyright (c) (2023) SPHINX_ORG
+ *  Authors:
+ *    - (C kusuma) <thekoesoemo@gmail.com>
+ *      GitHub: (https://github.com/chykusuma)
+ *  Contributors:
+ *    - (Contributor 1) <email1@example.com>
+ *      Github: (https://github.com/yourgit)
+ *    - (Contributor 2) <email2@example.com>
+ *      Github: (https://github.com/yourgit)
+ */
+
+
+#ifndef SPHINX_TEST_CHECK_HPP
+#define SPHINX_TEST_CHECK_HPP
+
+#pragma once
+
+#include <cstdio>
+#include <cstddef>
+
+namespace SPHINXTest {
+
+    // Number of failed checks of the running test executable
+    inline size_t& failures() {
+        static size_t count = 0;
+        return count;
+    }
+
+    // Function to record a check, printing the failed expression and its location
+    inline bool check(bool condition, const char* expression, const char* file, int line) {
+        if (!condition) {
+            ++failures();
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        }
+        return condition;
+    }
+
+    // Function to print the outcome of a test executable and return its exit code
+    inline int report(const char* name) {
+        if (failures() == 0) {
+            std::printf("%s: all checks passed\n", name);
+            return 0;
+        }
+        std::printf("%s: %zu check(s) failed\n", name, failures());
+        return 1;
+    }
+} // namespace SPHINXTest
+
+// Check a condition; a failure is reported and counted, and the test carries on
+#define SPHINX_CHECK(condition) SPHINXTest::check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
+
+#endif // SPHINX_TEST_CHECK_HPP